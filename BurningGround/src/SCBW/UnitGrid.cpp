@@ -0,0 +1,54 @@
+﻿#include "UnitGrid.h"
+
+void UnitGrid::build() {
+  static u16 cellOfUnit[UNIT_ARRAY_LENGTH];
+
+  cellsX = std::max(1, std::min((int) mapSize->width * 32 >> CELL_SHIFT, (int) MAX_CELLS));
+  cellsY = std::max(1, std::min((int) mapSize->height * 32 >> CELL_SHIFT, (int) MAX_CELLS));
+  const int cellCount = cellsX * cellsY;
+
+  unitCount = 0;
+  maxExtent = 0;
+  std::fill(cellStart, cellStart + cellCount + 1, 0);
+
+  for (CUnit* unit = *firstVisibleUnit; unit && unitCount < UNIT_ARRAY_LENGTH; unit = unit->next) {
+    const Rect16& bounds = Unit::UnitBounds[unit->id];
+    maxExtent = std::max(maxExtent, (int) std::max(std::max(bounds.left, bounds.right), std::max(bounds.top, bounds.bottom)));
+
+    const u16 cell = getCellY(unit->getY()) * cellsX + getCellX(unit->getX());
+    cellOfUnit[unitCount] = cell;
+    unitsByOrder[unitCount] = unit;
+    cellStart[cell + 1]++;
+    unitCount++;
+  }
+
+  //계수 정렬 (같은 칸 안에서는 유닛 목록 순서 유지)
+  for (int i = 0; i < cellCount; ++i)
+    cellStart[i + 1] += cellStart[i];
+
+  static u16 nextSlot[MAX_CELLS * MAX_CELLS];
+  std::copy(cellStart, cellStart + cellCount, nextSlot);
+  for (int order = 0; order < unitCount; ++order)
+    cellOrders[nextSlot[cellOfUnit[order]]++] = order;
+}
+
+int UnitGrid::getUnitsNear(int left, int top, int right, int bottom, CUnit** result) const {
+  static u16 orders[UNIT_ARRAY_LENGTH];
+  int count = 0;
+
+  const int cellLeft = getCellX(left - maxExtent), cellRight = getCellX(right + maxExtent);
+  const int cellTop = getCellY(top - maxExtent), cellBottom = getCellY(bottom + maxExtent);
+
+  for (int cy = cellTop; cy <= cellBottom; ++cy) {
+    for (int cx = cellLeft; cx <= cellRight; ++cx) {
+      const int cell = cy * cellsX + cx;
+      for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i)
+        orders[count++] = cellOrders[i];
+    }
+  }
+
+  std::sort(orders, orders + count);
+  for (int i = 0; i < count; ++i)
+    result[i] = unitsByOrder[orders[i]];
+  return count;
+}
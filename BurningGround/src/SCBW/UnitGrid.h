@@ -0,0 +1,33 @@
+﻿#pragma once
+#include "scbwdata.h"
+#include <algorithm>
+
+//유닛 탐색용 격자
+//매 프레임 시작 시 모든 유닛을 128x128 픽셀 칸에 나눠 담아 두고, 주변 유닛만 탐색함.
+//nextFrame()이 실행되는 동안에는 유닛 위치가 바뀌지 않으므로 한 프레임 동안 재사용 가능.
+//탐색 결과는 유닛 목록(*firstVisibleUnit) 순서대로 반환되므로,
+//전체 유닛 목록을 탐색하던 기존 코드와 같은 유닛이 선택됨.
+class UnitGrid {
+  public:
+    static const int CELL_SHIFT = 7;
+    static const int MAX_CELLS = (256 * 32) >> CELL_SHIFT;
+
+    //유닛 목록에서 격자를 새로 만듦
+    void build();
+
+    //(left, top, right, bottom) 범위에 충돌 박스가 겹치거나 중심이 들어갈 수 있는
+    //모든 유닛을 result에 유닛 목록 순서대로 저장하고, 저장한 유닛 수를 반환함.
+    //정확한 거리 / 충돌 검사는 호출하는 쪽에서 해야 함.
+    int getUnitsNear(int left, int top, int right, int bottom, CUnit** result) const;
+
+  private:
+    int getCellX(int x) const { return std::min(std::max(x >> CELL_SHIFT, 0), cellsX - 1); }
+    int getCellY(int y) const { return std::min(std::max(y >> CELL_SHIFT, 0), cellsY - 1); }
+
+    int cellsX, cellsY;
+    int unitCount;
+    int maxExtent;                          //가장 큰 충돌 박스 크기 (중심에서 가장자리까지)
+    u16 cellStart[MAX_CELLS * MAX_CELLS + 1];
+    u16 cellOrders[UNIT_ARRAY_LENGTH];      //칸별로 정렬된 유닛 목록 순서
+    CUnit* unitsByOrder[UNIT_ARRAY_LENGTH]; //유닛 목록 순서 -> 유닛
+};
@@ -6,52 +6,24 @@
 #include "../SCBW/enumerations.h"
 #include "../SCBW/ExtendSightLimit.h"
 #include "../SCBW/utilities.h"
+#include "nearby_units.h"
 #include <cstdio>
 
 bool firstRun = true;
 
-//유닛이 걸어다닐 수 있으며 충돌 크기가 있는지 확인
-bool unitIsGroundWalkable(const CUnit* const unit) {
-  using UnitStatus::GroundedBuilding;
-  using UnitStatus::InAir;
-  using UnitStatus::IgnoreTileCollision;
-  using UnitStatus::NoCollide;
-  using UnitStatus::IsGathering;
-  using UnitStatus::Disabled;
-  using UnitStatus::CanNotReceiveOrders;
-
-  return unit->status & UnitStatus::Completed
-         && !(unit->status & (GroundedBuilding | InAir | NoCollide | IsGathering | Disabled | CanNotReceiveOrders | IgnoreTileCollision))
-         && !(Unit::BaseProperty[unit->id] & UnitProperty::Subunit);
-}
-
 //비켜서기 기능 (search된 유닛을 위해 unit이 비켜줌)
 void stepAsideForOthers(CUnit* const unit) {
-  const int RADIUS = 50;  //탐색 거리
-  CUnit* closestSearch = NULL;
-  int closestDistance = RADIUS;
-
   if (!unitIsGroundWalkable(unit)) return;
   if (unit->mainOrderId != OrderId::PlayerGuard
       && unit->mainOrderId != OrderId::Medic)
       return;
 
   //가장 가까운 유닛 찾기
-  const int unitX = unit->getX(), unitY = unit->getY();
-  for (CUnit* search = *firstVisibleUnit; search; search = search->next) {
-    if (unit->playerId == search->playerId && unit != search
-        && unitIsGroundWalkable(search)
-        && search->sprite->mainGraphic->animation == IscriptAnimation::Walking) {
-      int distance = scbw::getDistanceFast(unitX, unitY, search->getX(), search->getY());
-      if (distance <= closestDistance) {
-        closestDistance = distance;
-        closestSearch = search;
-      }
-    }
-  }
+  const CUnit* const closestSearch = findUnitToStepAsideFor(unit);
   if (closestSearch == NULL) return;
 
   //비켜주기
+  const int unitX = unit->getX(), unitY = unit->getY();
   u16 moveX = unitX, moveY = unitY;
   if (unitX > closestSearch->getX()) moveX += 10;
   else moveX -= 10;
@@ -76,22 +48,6 @@ bool unitCanRepair(const CUnit *unit) {
          || unit->id == UnitId::drone;
 }
 
-//수리를 받을 수 있는 유닛인지 확인
-bool unitCanBeRepaired(const CUnit *unit) {
-  using Unit::BaseProperty;
-  using Unit::GroupFlags;
-  using Unit::MaxHitPoints;
-
-  if (unit->status & UnitStatus::Completed
-      && unit->hitPoints < (MaxHitPoints[unit->id] * 256)) {
-    if (BaseProperty[unit->id] & UnitProperty::Mechanical && GroupFlags[unit->id].isTerran)
-      return true;
-    else if (unit->status & (UnitStatus::GroundedBuilding | UnitStatus::InAir))
-      return true;
-  }
-  return false;
-}
-
 /// This hook is called every frame; most of your plugin's logic goes here.
 bool nextFrame() {
   if (!scbw::isGamePaused()) { //If the game is not paused
@@ -108,6 +64,9 @@ bool nextFrame() {
     //  //Write your code here
     //}
 
+    //주변 유닛 탐색용 격자 만들기
+    unitGrid.build();
+
     // Alternative looping method
     // Guarantees that [unit] points to an actual unit.
     for (CUnit *unit = *firstVisibleUnit; unit; unit = unit->next) {
@@ -152,23 +111,11 @@ bool nextFrame() {
         }
         //실제로 치료할 대상을 탐색
         CUnit *bestRepairTarget = NULL;
-        int bestDistance = 150; //최대 거리
-        const u16 unitX = unit->getX(), unitY = unit->getY();
         if (unit->unused_0x106) {
           if (unit->mainOrderId == OrderId::HoldPosition2
             || unit->mainOrderId == OrderId::AttackMove
-            || unit->mainOrderId == OrderId::Follow) {
-            for (CUnit* repairTarget = *firstVisibleUnit; repairTarget; repairTarget = repairTarget->next) {
-              if (unit != repairTarget && unit->playerId == repairTarget->playerId
-                  && unitCanBeRepaired(repairTarget)) {
-                const int distance = scbw::getDistanceFast(unitX, unitY, repairTarget->getX(), repairTarget->getY());
-                if (distance < bestDistance) {
-                  bestRepairTarget = repairTarget;
-                  bestDistance = distance;
-                }
-              }
-            }
-          }
+            || unit->mainOrderId == OrderId::Follow)
+            bestRepairTarget = findRepairTarget(unit);
         }
         if (bestRepairTarget)
           unit->orderTo(OrderId::Repair1, bestRepairTarget);
@@ -181,19 +128,7 @@ bool nextFrame() {
         //올리기
         if (unit->status & UnitStatus::NoCollide) {
           //위에 다른 지상 유닛이 겹쳐 있는지 확인
-          bool isCollide = false;
-          for (CUnit *collideUnit = *firstVisibleUnit; collideUnit; collideUnit = collideUnit->next) {
-            if (!(collideUnit->status & (UnitStatus::Burrowed | UnitStatus::InAir))
-                && !(Unit::BaseProperty[collideUnit->id] & UnitProperty::Subunit)
-                && unit->getLeft() <= collideUnit->getRight()
-                && unit->getRight() >= collideUnit->getLeft()
-                && unit->getTop() <= collideUnit->getBottom()
-                && unit->getBottom() >= collideUnit->getTop()
-                && unit != collideUnit) {
-              isCollide = true;
-              break;
-            }
-          }
+          const bool isCollide = isOverlappedByGroundUnit(unit);
           if (!isCollide) {
             scbw::playIscriptAnim(unit->sprite->mainGraphic, IscriptAnimation::Landing);
             unit->status &= ~(UnitStatus::NoCollide);
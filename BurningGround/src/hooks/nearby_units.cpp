@@ -0,0 +1,97 @@
+﻿#include "nearby_units.h"
+#include "../SCBW/api.h"
+#include "../SCBW/enumerations.h"
+
+UnitGrid unitGrid;
+static CUnit* nearbyUnits[UNIT_ARRAY_LENGTH];   //UnitGrid::getUnitsNear()의 결과
+
+bool unitIsGroundWalkable(const CUnit* const unit) {
+  using UnitStatus::GroundedBuilding;
+  using UnitStatus::InAir;
+  using UnitStatus::IgnoreTileCollision;
+  using UnitStatus::NoCollide;
+  using UnitStatus::IsGathering;
+  using UnitStatus::Disabled;
+  using UnitStatus::CanNotReceiveOrders;
+
+  return unit->status & UnitStatus::Completed
+         && !(unit->status & (GroundedBuilding | InAir | NoCollide | IsGathering | Disabled | CanNotReceiveOrders | IgnoreTileCollision))
+         && !(Unit::BaseProperty[unit->id] & UnitProperty::Subunit);
+}
+
+bool unitCanBeRepaired(const CUnit *unit) {
+  using Unit::BaseProperty;
+  using Unit::GroupFlags;
+  using Unit::MaxHitPoints;
+
+  if (unit->status & UnitStatus::Completed
+      && unit->hitPoints < (MaxHitPoints[unit->id] * 256)) {
+    if (BaseProperty[unit->id] & UnitProperty::Mechanical && GroupFlags[unit->id].isTerran)
+      return true;
+    else if (unit->status & (UnitStatus::GroundedBuilding | UnitStatus::InAir))
+      return true;
+  }
+  return false;
+}
+
+CUnit* findUnitToStepAsideFor(const CUnit* const unit) {
+  const int RADIUS = 50;  //탐색 거리
+  CUnit* closestSearch = NULL;
+  int closestDistance = RADIUS;
+
+  const int unitX = unit->getX(), unitY = unit->getY();
+  const int nearbyCount = unitGrid.getUnitsNear(unitX - RADIUS - 1, unitY - RADIUS - 1,
+                                                unitX + RADIUS + 1, unitY + RADIUS + 1, nearbyUnits);
+  for (int i = 0; i < nearbyCount; ++i) {
+    CUnit* const search = nearbyUnits[i];
+    if (unit->playerId == search->playerId && unit != search
+        && unitIsGroundWalkable(search)
+        && search->sprite->mainGraphic->animation == IscriptAnimation::Walking) {
+      int distance = scbw::getDistanceFast(unitX, unitY, search->getX(), search->getY());
+      if (distance <= closestDistance) {
+        closestDistance = distance;
+        closestSearch = search;
+      }
+    }
+  }
+  return closestSearch;
+}
+
+CUnit* findRepairTarget(const CUnit* const unit) {
+  const int REPAIR_RADIUS = 150; //최대 거리
+  CUnit *bestRepairTarget = NULL;
+  int bestDistance = REPAIR_RADIUS;
+
+  const u16 unitX = unit->getX(), unitY = unit->getY();
+  const int nearbyCount = unitGrid.getUnitsNear(unitX - REPAIR_RADIUS - 1, unitY - REPAIR_RADIUS - 1,
+                                                unitX + REPAIR_RADIUS + 1, unitY + REPAIR_RADIUS + 1, nearbyUnits);
+  for (int i = 0; i < nearbyCount; ++i) {
+    CUnit* const repairTarget = nearbyUnits[i];
+    if (unit != repairTarget && unit->playerId == repairTarget->playerId
+        && unitCanBeRepaired(repairTarget)) {
+      const int distance = scbw::getDistanceFast(unitX, unitY, repairTarget->getX(), repairTarget->getY());
+      if (distance < bestDistance) {
+        bestRepairTarget = repairTarget;
+        bestDistance = distance;
+      }
+    }
+  }
+  return bestRepairTarget;
+}
+
+bool isOverlappedByGroundUnit(const CUnit* const depot) {
+  const int nearbyCount = unitGrid.getUnitsNear(depot->getLeft(), depot->getTop(),
+                                                depot->getRight(), depot->getBottom(), nearbyUnits);
+  for (int i = 0; i < nearbyCount; ++i) {
+    CUnit* const collideUnit = nearbyUnits[i];
+    if (!(collideUnit->status & (UnitStatus::Burrowed | UnitStatus::InAir))
+        && !(Unit::BaseProperty[collideUnit->id] & UnitProperty::Subunit)
+        && depot->getLeft() <= collideUnit->getRight()
+        && depot->getRight() >= collideUnit->getLeft()
+        && depot->getTop() <= collideUnit->getBottom()
+        && depot->getBottom() >= collideUnit->getTop()
+        && depot != collideUnit)
+      return true;
+  }
+  return false;
+}
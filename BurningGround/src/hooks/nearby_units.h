@@ -0,0 +1,23 @@
+﻿#pragma once
+#include "../SCBW/structures.h"
+#include "../SCBW/UnitGrid.h"
+
+//주변 유닛 탐색용 격자 (nextFrame()이 매 프레임 시작 시 만듦)
+extern UnitGrid unitGrid;
+
+//유닛이 걸어다닐 수 있으며 충돌 크기가 있는지 확인
+bool unitIsGroundWalkable(const CUnit* const unit);
+
+//수리를 받을 수 있는 유닛인지 확인
+bool unitCanBeRepaired(const CUnit *unit);
+
+//unit이 비켜줘야 할 가장 가까운 유닛 (50픽셀 이내에서 걷고 있는 같은 플레이어의 지상 유닛)
+//없으면 NULL
+CUnit* findUnitToStepAsideFor(const CUnit* const unit);
+
+//unit이 수리할 가장 가까운 유닛 (150픽셀 이내에 있는 같은 플레이어의 유닛)
+//없으면 NULL
+CUnit* findRepairTarget(const CUnit* const unit);
+
+//depot 위에 다른 지상 유닛이 겹쳐 있는지 확인
+bool isOverlappedByGroundUnit(const CUnit* const depot);
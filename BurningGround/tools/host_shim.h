@@ -0,0 +1,25 @@
+//Forced include for building BurningGround sources as Linux host programs
+//(tests and benchmarks in BurningGround/tools). It uses GPTP's host shim
+//(GPTP/tools/host_shim/host_shim.h), which maps StarCraft's memory, and adds
+//what BurningGround's headers take from MSVC and <windows.h>:
+//
+//  -include host_shim.h -I../../GPTP/tools/host_shim -I../src
+//
+//types.h only defines the integer types for MSVC, so they are defined here.
+
+#pragma once
+#include "../../GPTP/tools/host_shim/host_shim.h"
+#include <windows.h>
+#include <cstdint>
+
+typedef std::uint32_t u32;
+typedef std::int32_t s32;
+typedef std::uint16_t u16;
+typedef std::int16_t s16;
+typedef std::uint8_t u8;
+typedef std::int8_t s8;
+typedef u8 UNK;
+
+struct POINT { LONG x, y; };
+
+#define C_ASSERT(e)
@@ -0,0 +1,101 @@
+//Fake unit table for host programs in BurningGround/tools (see host_shim.h).
+//Include this in exactly one translation unit: it defines the CUnit and
+//scbw functions that are normally compiled from CUnit.cpp and api.cpp (which
+//contain inline assembly), using the same formulas.
+//
+//  host::setUnit(index, unitId, x, y) places a unit; host::linkVisibleUnits()
+//  then links all units with a sprite into the visible unit list.
+
+#pragma once
+#include <SCBW/scbwdata.h>
+#include <SCBW/api.h>
+#include <SCBW/enumerations.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace host {
+
+  CUnit units[UNIT_ARRAY_LENGTH];
+  CSprite sprites[UNIT_ARRAY_LENGTH];
+  CImage images[UNIT_ARRAY_LENGTH];
+
+  //Gives every units.dat array its own 4 KB page above StarCraft's data,
+  //before the Unit:: array pointers are initialized
+  __attribute__((constructor(102))) void setupDatTables() {
+    DatLoad* const unitsDat = (DatLoad*) Unit::unitsDat;
+    for (int i = 0; i < 53; ++i)
+      unitsDat[i].address = 0x00700000 + i * 0x1000;
+  }
+
+  //Clears all units and the visible unit list
+  void clearUnits() {
+    std::memset(units, 0, sizeof(units));
+    std::memset(sprites, 0, sizeof(sprites));
+    std::memset(images, 0, sizeof(images));
+    *firstVisibleUnit = NULL;
+  }
+
+  //Creates a completed unit in slot @p index (1 to UNIT_ARRAY_LENGTH), owned
+  //by player 0
+  CUnit* setUnit(u16 index, u16 unitId, int x, int y) {
+    CUnit* unit = &units[index - 1];
+    std::memset(unit, 0, sizeof(CUnit));
+    unit->id = unitId;
+    unit->sprite = &sprites[index - 1];
+    unit->sprite->mainGraphic = &images[index - 1];
+    unit->sprite->position.x = (u16) x;
+    unit->sprite->position.y = (u16) y;
+    unit->status = UnitStatus::Completed;
+    unit->hitPoints = 256;
+    return unit;
+  }
+
+  //Random number in [0, n)
+  inline int random(int n) {
+    return std::rand() % n;
+  }
+
+  //Links all units with a sprite into the visible unit list, in random order
+  void linkVisibleUnits() {
+    std::vector<CUnit*> visibleUnits;
+    for (int i = 0; i < UNIT_ARRAY_LENGTH; ++i) {
+      if (units[i].sprite)
+        visibleUnits.push_back(&units[i]);
+    }
+    for (int i = (int) visibleUnits.size() - 1; i > 0; --i)
+      std::swap(visibleUnits[i], visibleUnits[random(i + 1)]);
+
+    *firstVisibleUnit = NULL;
+    for (int i = (int) visibleUnits.size() - 1; i >= 0; --i) {
+      visibleUnits[i]->next = *firstVisibleUnit;
+      *firstVisibleUnit = visibleUnits[i];
+    }
+  }
+
+} //host
+
+//-------- CUnit / scbw functions used by the tested code --------//
+
+u16 CUnit::getX() const { return this->sprite->position.x; }
+u16 CUnit::getY() const { return this->sprite->position.y; }
+s16 CUnit::getLeft() const { return this->getX() - Unit::UnitBounds[this->id].left; }
+s16 CUnit::getRight() const { return this->getX() + Unit::UnitBounds[this->id].right; }
+s16 CUnit::getTop() const { return this->getY() - Unit::UnitBounds[this->id].top; }
+s16 CUnit::getBottom() const { return this->getY() + Unit::UnitBounds[this->id].bottom; }
+
+namespace scbw {
+
+  u32 getDistanceFast(s32 x1, s32 y1, s32 x2, s32 y2) {
+    int dMax = std::abs(x1 - x2), dMin = std::abs(y1 - y2);
+    if (dMax < dMin)
+      std::swap(dMax, dMin);
+
+    if (dMin <= (dMax >> 2))
+      return dMax;
+
+    return (dMin * 3 >> 3) + (dMin * 3 >> 8) + dMax - (dMax >> 4) - (dMax >> 6);
+  }
+
+} //scbw
@@ -0,0 +1,245 @@
+﻿//Compares the nearby-unit lookups of BurningGround's nextFrame(), which use
+//UnitGrid (hooks/nearby_units.cpp), with the full scans of the visible unit
+//list they replaced, and times both:
+//
+//  - findUnitToStepAsideFor() against the scan of stepAsideForOthers()
+//  - findRepairTarget() against the scan of the auto-repair code
+//  - isOverlappedByGroundUnit() against the scan of the supply depot code
+//
+//for every unit of random games with 200, 800 and 1600 units. Units stand on
+//an 8 pixel lattice so that many distances tie, and the visible unit list is
+//linked in random order: the lookups must pick the same unit as the scans,
+//which keep the first or the last unit of a tie in list order.
+//
+//Build (Linux, from BurningGround/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim.h -I../../GPTP/tools/host_shim -I../src -o unit_grid_test
+//    unit_grid_test.cpp ../src/SCBW/UnitGrid.cpp ../src/hooks/nearby_units.cpp
+//
+//The benchmark runs one frame's lookups like nextFrame() in a crowded game:
+//every unit looks for a unit to step aside for, one in 8 looks for a repair
+//target and one in 64 checks for overlapping units. The grid version
+//includes UnitGrid::build().
+
+#include "host_units.h"
+#include <hooks/nearby_units.h>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  const int MAP_TILES = 128;
+  const int UNIT_COUNTS[] = { 200, 800, 1600 };
+
+  //-------- The full scans before UnitGrid --------//
+
+  CUnit* findUnitToStepAsideForOld(const CUnit* const unit) {
+    const int RADIUS = 50;  //탐색 거리
+    CUnit* closestSearch = NULL;
+    int closestDistance = RADIUS;
+
+    const int unitX = unit->getX(), unitY = unit->getY();
+    for (CUnit* search = *firstVisibleUnit; search; search = search->next) {
+      if (unit->playerId == search->playerId && unit != search
+          && unitIsGroundWalkable(search)
+          && search->sprite->mainGraphic->animation == IscriptAnimation::Walking) {
+        int distance = scbw::getDistanceFast(unitX, unitY, search->getX(), search->getY());
+        if (distance <= closestDistance) {
+          closestDistance = distance;
+          closestSearch = search;
+        }
+      }
+    }
+    return closestSearch;
+  }
+
+  CUnit* findRepairTargetOld(const CUnit* const unit) {
+    CUnit *bestRepairTarget = NULL;
+    int bestDistance = 150; //최대 거리
+    const u16 unitX = unit->getX(), unitY = unit->getY();
+    for (CUnit* repairTarget = *firstVisibleUnit; repairTarget; repairTarget = repairTarget->next) {
+      if (unit != repairTarget && unit->playerId == repairTarget->playerId
+          && unitCanBeRepaired(repairTarget)) {
+        const int distance = scbw::getDistanceFast(unitX, unitY, repairTarget->getX(), repairTarget->getY());
+        if (distance < bestDistance) {
+          bestRepairTarget = repairTarget;
+          bestDistance = distance;
+        }
+      }
+    }
+    return bestRepairTarget;
+  }
+
+  bool isOverlappedByGroundUnitOld(const CUnit* const unit) {
+    bool isCollide = false;
+    for (CUnit *collideUnit = *firstVisibleUnit; collideUnit; collideUnit = collideUnit->next) {
+      if (!(collideUnit->status & (UnitStatus::Burrowed | UnitStatus::InAir))
+          && !(Unit::BaseProperty[collideUnit->id] & UnitProperty::Subunit)
+          && unit->getLeft() <= collideUnit->getRight()
+          && unit->getRight() >= collideUnit->getLeft()
+          && unit->getTop() <= collideUnit->getBottom()
+          && unit->getBottom() >= collideUnit->getTop()
+          && unit != collideUnit) {
+        isCollide = true;
+        break;
+      }
+    }
+    return isCollide;
+  }
+
+  //-------- Random games --------//
+
+  //Gives every unit type a random size and random properties. With large
+  //units (up to 64 pixels from the center, like the largest buildings), the
+  //grid searches a wider area around each search box; small units check that
+  //it does not search too narrow an area.
+  void randomizeUnitTypes(bool hasLargeUnits) {
+    Rect16* const bounds = (Rect16*) Unit::UnitBounds;
+    u32* const baseProperty = (u32*) Unit::BaseProperty;
+    s32* const maxHitPoints = (s32*) Unit::MaxHitPoints;
+    GroupFlag* const groupFlags = (GroupFlag*) Unit::GroupFlags;
+
+    for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+      const int size = !hasLargeUnits ? 4 : host::random(8) == 0 ? 64 : 24;
+      bounds[unitId].left = (s16) host::random(size);
+      bounds[unitId].top = (s16) host::random(size);
+      bounds[unitId].right = (s16) host::random(size);
+      bounds[unitId].bottom = (s16) host::random(size);
+      baseProperty[unitId] = (host::random(8) == 0 ? UnitProperty::Subunit : 0)
+                             | (host::random(2) ? UnitProperty::Mechanical : 0);
+      maxHitPoints[unitId] = 1 + host::random(100);
+      std::memset(&groupFlags[unitId], 0, sizeof(GroupFlag));
+      groupFlags[unitId].isTerran = host::random(2);
+    }
+  }
+
+  //A status with each flag the lookups test set now and then
+  u32 randomStatus() {
+    const u32 flags[] = {
+      UnitStatus::GroundedBuilding, UnitStatus::InAir, UnitStatus::NoCollide,
+      UnitStatus::IsGathering, UnitStatus::Disabled, UnitStatus::CanNotReceiveOrders,
+      UnitStatus::IgnoreTileCollision, UnitStatus::Burrowed,
+    };
+    u32 status = host::random(10) ? UnitStatus::Completed : 0;
+    for (int i = 0; i < 8; ++i) {
+      if (host::random(12) == 0)
+        status |= flags[i];
+    }
+    return status;
+  }
+
+  //Places @p unitCount units around a few bases, some of them on the map
+  //edges, and links them in random order
+  void createGame(int unitCount) {
+    const int mapPixels = MAP_TILES * 32;
+    mapSize->width = MAP_TILES;
+    mapSize->height = MAP_TILES;
+    host::clearUnits();
+
+    int baseX[8], baseY[8];
+    for (int i = 0; i < 8; ++i) {
+      baseX[i] = host::random(mapPixels);
+      baseY[i] = host::random(mapPixels);
+    }
+
+    for (int i = 0; i < unitCount; ++i) {
+      int x, y;
+      if (host::random(20) == 0) {
+        x = host::random(2) ? 0 : mapPixels - 1;
+        y = host::random(mapPixels);
+      }
+      else {
+        const int base = host::random(8);
+        x = std::min(std::max(baseX[base] + host::random(640) - 320, 0), mapPixels - 1);
+        y = std::min(std::max(baseY[base] + host::random(640) - 320, 0), mapPixels - 1);
+      }
+
+      //Indexes are spread over the whole unit table
+      const u16 index = (u16) (1 + (i * 7) % UNIT_ARRAY_LENGTH);
+      CUnit* const unit = host::setUnit(index, (u16) host::random(UNIT_TYPE_COUNT), x & ~7, y & ~7);
+      unit->playerId = (u8) host::random(3);
+      unit->status = randomStatus();
+      unit->hitPoints = host::random(Unit::MaxHitPoints[unit->id] * 256 + 1);
+      unit->sprite->mainGraphic->animation = host::random(2) ? IscriptAnimation::Walking : 0;
+    }
+
+    host::linkVisibleUnits();
+  }
+
+  long checkCount = 0, mismatches = 0;
+
+  void check(bool isEqual, const char *lookup, const CUnit *unit) {
+    ++checkCount;
+    if (!isEqual) {
+      if (mismatches < 5)
+        std::printf("%s differs for the unit at (%d, %d)\n", lookup, unit->getX(), unit->getY());
+      ++mismatches;
+    }
+  }
+
+  void compareGame() {
+    unitGrid.build();
+
+    for (const CUnit* unit = *firstVisibleUnit; unit; unit = unit->next) {
+      check(findUnitToStepAsideFor(unit) == findUnitToStepAsideForOld(unit), "findUnitToStepAsideFor", unit);
+      check(findRepairTarget(unit) == findRepairTargetOld(unit), "findRepairTarget", unit);
+      check(isOverlappedByGroundUnit(unit) == isOverlappedByGroundUnitOld(unit), "isOverlappedByGroundUnit", unit);
+    }
+  }
+
+  //-------- Benchmark --------//
+
+  volatile long sink;
+
+  //Returns the average time of one frame's lookups in milliseconds
+  double benchmark(bool isUsingGrid, int frameCount) {
+    long found = 0;
+    const Clock::time_point start = Clock::now();
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+      if (isUsingGrid)
+        unitGrid.build();
+
+      int order = 0;
+      for (const CUnit* unit = *firstVisibleUnit; unit; unit = unit->next, ++order) {
+        found += (isUsingGrid ? findUnitToStepAsideFor(unit) : findUnitToStepAsideForOld(unit)) != NULL;
+        if (order % 8 == 0)
+          found += (isUsingGrid ? findRepairTarget(unit) : findRepairTargetOld(unit)) != NULL;
+        if (order % 64 == 0)
+          found += isUsingGrid ? isOverlappedByGroundUnit(unit) : isOverlappedByGroundUnitOld(unit);
+      }
+    }
+
+    sink = found;
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frameCount;
+  }
+
+} //unnamed namespace
+
+int main() {
+  std::srand(6);
+
+  for (int trial = 0; trial < 20; ++trial) {
+    randomizeUnitTypes(trial % 2 == 0);
+    for (int i = 0; i < 3; ++i) {
+      createGame(UNIT_COUNTS[i]);
+      compareGame();
+    }
+  }
+
+  randomizeUnitTypes(true);
+  for (int i = 0; i < 3; ++i) {
+    createGame(UNIT_COUNTS[i]);
+    const int frameCount = 40000 / UNIT_COUNTS[i];
+    benchmark(false, 1);
+    const double scanMs = benchmark(false, frameCount);
+    const double gridMs = benchmark(true, frameCount);
+    std::printf("%4d units: full scans %.3f ms, grid %.3f ms per frame\n", UNIT_COUNTS[i], scanMs, gridMs);
+  }
+
+  std::printf("%ld checks\n", checkCount);
+  std::printf("%ld mismatches\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #include "ai_common.h"
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
+#include <SCBW/TypeInfoCache.h>
 #include <SCBW/UnitFinder.h>
 #include <cassert>
 
@@ -94,7 +95,7 @@ namespace AI {
 			if (target->status & UnitStatus::Invincible)
 				return;
 
-			if (!scbw::canWeaponTargetUnit(weaponId, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(weaponId, target, caster))
 				return;
 
 			if (!caster->isTargetEnemy(target))
@@ -128,7 +129,7 @@ namespace AI {
 			if (target->status & UnitStatus::Invincible)
 				return;
 
-			if (!scbw::canWeaponTargetUnit(weaponId, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(weaponId, target, caster))
 				return;
 
 			if (caster->isTargetEnemy(target))
@@ -195,11 +196,13 @@ namespace AI {
 			if (!caster->isTargetEnemy(target))
 				return;
 
-			if ((units_dat::BaseProperty[target->id] & UnitProperty::Worker)
+			const scbw::UnitTypeInfo &targetInfo = scbw::typeInfoCache.getUnit(target->id);
+
+			if (targetInfo.hasProperty(UnitProperty::Worker)
 				|| !(target->status & UnitStatus::IsBuilding))
 				totalNukeTargetValue += target->getCurrentLifeInGame();
 
-			if (units_dat::BaseProperty[target->id] & UnitProperty::Building) {
+			if (targetInfo.hasProperty(UnitProperty::Building)) {
 				if (target->canDetect()
 					|| target->id == UnitId::sunken_colony
 					|| target->id == UnitId::lurker)
@@ -3,6 +3,7 @@
 #include "../SCBW/UnitFinder.h"
 #include "../SCBW/structures/CUnit.h"
 #include "../SCBW/api.h"
+#include "../SCBW/TargetingTables.h"
 
 namespace AI {
 
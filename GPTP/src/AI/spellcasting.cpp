@@ -1,6 +1,7 @@
 #include "spellcasting.h"
 #include "spells/spells.h"
 #include <algorithm>
+#include <profiler.h>
 
 //-------- Helper function declarations. Do NOT modify! --------//
 namespace {
@@ -17,6 +18,7 @@ namespace AI {
 
 	//Attempts make the @p unit cast a spell.
 	bool AI_spellcasterHook(CUnit *unit, bool isUnitBeingAttacked) {
+		GPTP_PROFILE_HOOK(AI_Spellcaster);
 		if (!isUnitBeingAttacked
 			&& AIScriptController[unit->playerId].spellcasterTimer != 0)
 			return false;
@@ -17,7 +17,7 @@ namespace AI {
 			if (!units_dat::ShieldsEnabled[target->id])
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::EMP_Shockwave, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::EMP_Shockwave, target, caster))
 				return false;
 
 			const int totalEnemyShields = getTotalEnemyShieldsInArea(target->getX(), target->getY(), 160, caster);
@@ -42,7 +42,7 @@ namespace AI {
 			if (!target->isValidCaster())
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::EMP_Shockwave, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::EMP_Shockwave, target, caster))
 				return false;
 
 			const int totalEnemyEnergy = getTotalEnemyEnergyInArea(target->getX(), target->getY(), 160, caster);
@@ -16,7 +16,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Ensnare, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Ensnare, target, caster))
 				return false;
 
 			if (target->ensnareTimer)
@@ -17,7 +17,7 @@ namespace AI {
 			if (target->irradiateTimer)
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Irradiate, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Irradiate, target, caster))
 				return false;
 
 			if (!(units_dat::BaseProperty[target->id] & UnitProperty::Organic))
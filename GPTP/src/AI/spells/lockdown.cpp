@@ -16,7 +16,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Lockdown, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Lockdown, target, caster))
 				return false;
 
 			if (target->isFrozen())
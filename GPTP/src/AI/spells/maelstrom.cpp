@@ -16,7 +16,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Maelstrom, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Maelstrom, target, caster))
 				return false;
 
 			if (!(units_dat::BaseProperty[target->id] & UnitProperty::Organic))
@@ -20,7 +20,7 @@ namespace AI {
 			if (target->parasiteFlags & (1 << caster->playerId))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Parasite, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Parasite, target, caster))
 				return false;
 
 			if (target->canDetect())
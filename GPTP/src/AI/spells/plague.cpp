@@ -14,7 +14,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Plague, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Plague, target, caster))
 				return false;
 
 			if (target->plagueTimer)
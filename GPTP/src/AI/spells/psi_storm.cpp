@@ -16,7 +16,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::PsiStorm, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::PsiStorm, target, caster))
 				return false;
 
 			const int totalEnemyLife = getTotalEnemyLifeInArea(target->getX(), target->getY(), 96, caster, WeaponId::PsiStorm);
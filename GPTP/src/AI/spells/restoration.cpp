@@ -10,7 +10,7 @@ namespace AI {
 			if (target->playerId != caster->playerId)
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Restoration, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Restoration, target, caster))
 				return false;
 
 			if (target->getCurrentLifeInGame() <= 60)
@@ -44,7 +44,7 @@ namespace AI {
 			if (!(target->parasiteFlags || target->maelstromTimer))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::Restoration, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::Restoration, target, caster))
 				return false;
 
 			return true;
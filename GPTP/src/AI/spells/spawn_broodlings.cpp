@@ -14,7 +14,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::SpawnBroodlings, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::SpawnBroodlings, target, caster))
 				return false;
 
 			if (units_dat::BaseProperty[target->id] & UnitProperty::Hero)
@@ -16,7 +16,7 @@ namespace AI {
 			if (!isTargetWorthHitting(target, caster))
 				return false;
 
-			if (!scbw::canWeaponTargetUnit(WeaponId::StasisField, target, caster))
+			if (!scbw::targetingTables.canWeaponTargetUnit(WeaponId::StasisField, target, caster))
 				return false;
 
 			if (units_dat::BaseProperty[target->id] & UnitProperty::Building)
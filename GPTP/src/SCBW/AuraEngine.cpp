@@ -0,0 +1,92 @@
+#include "AuraEngine.h"
+#include "api.h"
+#include "UnitFinder.h"
+#include <cassert>
+#include <cstring>
+
+namespace scbw {
+
+	AuraEngine auraEngine;
+
+	//Shared by all calls to emit(), instead of one UnitFinder on the stack per emitter
+	UnitFinder auraTargetFinder;
+
+	AuraEngine::AuraEngine() : auraCount(0) {
+		this->reset();
+	}
+
+	int AuraEngine::addAura(FilterFunc filter, EffectFunc effect) {
+		assert(filter && effect);
+		if (this->auraCount >= MAX_AURAS)
+			return -1;
+
+		Aura &aura = this->auras[this->auraCount];
+		aura.filter = filter;
+		aura.effect = effect;
+		std::memset(aura.receivers, 0, sizeof(aura.receivers));
+
+		return this->auraCount++;
+	}
+
+	void AuraEngine::reset() {
+		for (int i = 0; i < this->auraCount; ++i)
+			std::memset(this->auras[i].receivers, 0, sizeof(this->auras[i].receivers));
+
+		this->isFrameStarted = false;
+	}
+
+	void AuraEngine::beginFrame() {
+		for (int i = 0; i < this->auraCount; ++i)
+			std::memset(this->auras[i].receivers, 0, sizeof(this->auras[i].receivers));
+
+		this->isFrameStarted = true;
+	}
+
+	int AuraEngine::emit(int auraId, const CUnit *emitter, u32 radius) {
+		assert(0 <= auraId && auraId < this->auraCount);
+		assert(emitter);
+		//Without it, the receivers of the last game or frame would be skipped
+		assert(this->isFrameStarted && "beginFrame() must be called before emit()");
+
+		Aura &aura = this->auras[auraId];
+		int affectedCount = 0;
+		bool needsRefresh = false;
+
+		auraTargetFinder.search(
+			emitter->getX() - radius, emitter->getY() - radius,
+			emitter->getX() + radius, emitter->getY() + radius);
+
+		for (int i = 0; i < auraTargetFinder.getUnitCount(); ++i) {
+			CUnit *unit = auraTargetFinder.getUnit(i);
+			const u16 index = unit->getIndex();
+			const u32 bit = 1u << (index % 32);
+
+			//Overlapping emitters apply the aura only once
+			if (aura.receivers[index / 32] & bit)
+				continue;
+
+			if (!aura.filter(emitter, unit) || emitter->getDistanceToTarget(unit) > radius)
+				continue;
+
+			aura.receivers[index / 32] |= bit;
+			if (aura.effect(unit))
+				needsRefresh = true;
+			++affectedCount;
+		}
+
+		if (needsRefresh)
+			refreshConsole();
+
+		return affectedCount;
+	}
+
+	bool AuraEngine::isAffected(int auraId, const CUnit *unit) const {
+		assert(0 <= auraId && auraId < this->auraCount);
+		if (!this->isFrameStarted)
+			return false;
+
+		const u16 index = unit->getIndex();
+		return (this->auras[auraId].receivers[index / 32] & (1u << (index % 32))) != 0;
+	}
+
+} //scbw
@@ -0,0 +1,84 @@
+#pragma once
+#include "scbwdata.h"
+
+namespace scbw {
+
+	/// The AuraEngine applies area effects ("auras") from emitter units to the
+	/// units around them, such as the Arbiter's cloaking field. Each aura is
+	/// registered once with a filter and an effect:
+	///
+	///   bool canHeal(const CUnit *emitter, const CUnit *unit) {
+	///     return unit->playerId == emitter->playerId
+	///       && units_dat::BaseProperty[unit->id] & UnitProperty::Organic;
+	///   }
+	///   bool heal(CUnit *unit) { unit->setHp(unit->hitPoints + 64); return false; }
+	///
+	///   const int healAura = scbw::auraEngine.addAura(canHeal, heal);
+	///   //For each emitter, once per frame:
+	///   scbw::auraEngine.emit(healAura, medic, 96);
+	///
+	/// Candidates are found with a UnitFinder search, in the same order as the
+	/// original hooks, and measured with CUnit::getDistanceToTarget(). Each unit
+	/// receives each aura at most once per frame, no matter how many emitters
+	/// overlap it; units that already received the aura are skipped before any
+	/// distance check. A frame starts with each call to beginFrame() from
+	/// hooks::nextFrame(), so units created during a frame can receive auras
+	/// from the emitters updated after them.
+	///
+	/// Effects report whether they changed something shown in the console
+	/// (button set, portrait, stats). scbw::refreshConsole() is then called
+	/// once at the end of emit(), instead of once per affected unit.
+
+	class AuraEngine {
+	public:
+		/// Returns true if @p unit can receive the aura of @p emitter.
+		typedef bool (*FilterFunc)(const CUnit *emitter, const CUnit *unit);
+		/// Applies the aura to @p unit. Returns true if the console must be
+		/// refreshed.
+		typedef bool (*EffectFunc)(CUnit *unit);
+
+		/// Maximum number of auras.
+		static const int MAX_AURAS = 16;
+
+		AuraEngine();
+
+		/// Registers an aura, and returns its ID (or -1 if there are too many
+		/// auras).
+		int addAura(FilterFunc filter, EffectFunc effect);
+
+		/// Applies the aura @p auraId of @p emitter to every unit within
+		/// @p radius pixels that passes the filter and has not received the
+		/// aura yet during this frame, and refreshes the console if an effect
+		/// asked for it. Returns the number of units affected.
+		int emit(int auraId, const CUnit *emitter, u32 radius);
+
+		/// Returns true if @p unit has received the aura @p auraId during this
+		/// frame.
+		bool isAffected(int auraId, const CUnit *unit) const;
+
+		/// Starts a new frame: every unit can receive each aura once more.
+		/// Called once per frame from hooks::nextFrame(), before the units are
+		/// updated.
+		void beginFrame();
+
+		/// Forgets which units received auras. Called when a game starts.
+		void reset();
+
+	private:
+		static const int WORD_COUNT = (UNIT_ARRAY_LENGTH + 1 + 31) / 32;
+
+		struct Aura {
+			FilterFunc filter;
+			EffectFunc effect;
+			u32 receivers[WORD_COUNT];	//Units that received the aura this frame
+		};
+
+		Aura auras[MAX_AURAS];
+		int auraCount;
+		bool isFrameStarted;
+	};
+
+	/// The shared aura engine.
+	extern AuraEngine auraEngine;
+
+} //scbw
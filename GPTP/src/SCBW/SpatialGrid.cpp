@@ -0,0 +1,84 @@
+#include "SpatialGrid.h"
+#include <cassert>
+
+namespace scbw {
+
+	SpatialGrid spatialGrid;
+
+	SpatialGrid::SpatialGrid()
+		: cellsX(0), cellsY(0), unitCount(0), maxExtentX(0), maxExtentY(0),
+		builtFrame(0), isBuilt(false) {}
+
+	void SpatialGrid::clear() {
+		this->unitCount = 0;
+		this->isBuilt = false;
+	}
+
+	bool SpatialGrid::isUpToDate() const {
+		return this->isBuilt && this->builtFrame == *elapsedTimeFrames;
+	}
+
+	int SpatialGrid::getUnitCount() const {
+		return this->unitCount;
+	}
+
+	// Buckets every unit in StarCraft's unit ordering arrays by the cell its
+	// center is in, using a counting sort. Units keep the order they have in
+	// unitOrderingX, so queries are deterministic across all game clients.
+	void SpatialGrid::build() {
+		//Each unit has two entries in the ordering array (left and right edge)
+		static u8 isUnitAdded[UNIT_ARRAY_LENGTH + 1];
+		static u16 unitCells[UNIT_ARRAY_LENGTH];
+		static u16 foundUnits[UNIT_ARRAY_LENGTH];
+
+		this->cellsX = std::min((mapTileSize->width * 32 + CELL_SIZE - 1) >> CELL_SHIFT, MAX_CELLS_X);
+		this->cellsY = std::min((mapTileSize->height * 32 + CELL_SIZE - 1) >> CELL_SHIFT, MAX_CELLS_Y);
+		this->maxExtentX = 0;
+		this->maxExtentY = 0;
+
+		const int cellCount = this->cellsX * this->cellsY;
+		std::fill_n(this->cellStart, cellCount + 1, 0);
+		std::fill_n(isUnitAdded, countof(isUnitAdded), 0);
+
+		int foundCount = 0;
+		const UnitFinderData *const end = unitOrderingX + *unitOrderingCount;
+
+		for (const UnitFinderData *entry = unitOrderingX; entry < end; ++entry) {
+			const u16 unitIndex = (u16)entry->unitIndex;
+			if (isUnitAdded[unitIndex])
+				continue;
+			isUnitAdded[unitIndex] = 1;
+
+			const CUnit *unit = CUnit::getFromIndex(unitIndex);
+			if (!unit || !unit->sprite)
+				continue;
+
+			const Box16 &bounds = units_dat::UnitBounds[unit->id];
+			this->maxExtentX = std::max(this->maxExtentX, (int)std::max(bounds.left, bounds.right));
+			this->maxExtentY = std::max(this->maxExtentY, (int)std::max(bounds.top, bounds.bottom));
+
+			const u16 cell = getCellY(unit->getY()) * this->cellsX + getCellX(unit->getX());
+			foundUnits[foundCount] = unitIndex;
+			unitCells[foundCount] = cell;
+			++foundCount;
+			++this->cellStart[cell + 1];
+		}
+
+		//Convert the cell sizes into starting offsets
+		for (int cell = 0; cell < cellCount; ++cell)
+			this->cellStart[cell + 1] += this->cellStart[cell];
+
+		//Fill the cells, using the end of the previous cell as a write cursor
+		static u16 writePos[MAX_CELLS_X * MAX_CELLS_Y];
+		std::copy(this->cellStart, this->cellStart + cellCount, writePos);
+
+		for (int i = 0; i < foundCount; ++i)
+			this->unitIndices[writePos[unitCells[i]]++] = foundUnits[i];
+
+		assert(this->cellStart[cellCount] == foundCount);
+		this->unitCount = foundCount;
+		this->builtFrame = *elapsedTimeFrames;
+		this->isBuilt = true;
+	}
+
+} //scbw
@@ -0,0 +1,313 @@
+#pragma once
+#include "scbwdata.h"
+#include "api.h"
+#include <algorithm>
+
+namespace scbw {
+
+	/// The SpatialGrid class is a per-frame index of all units on the map,
+	/// bucketed into square cells of CELL_SIZE pixels. It is built once per frame
+	/// (see hooks::nextFrame()) from the same unit ordering arrays used by
+	/// UnitFinder, and can then be queried any number of times. Each query only
+	/// visits the cells overlapping the search area, instead of binary-searching
+	/// and walking StarCraft's sorted unit arrays again.
+	///
+	/// Note: The grid is a snapshot. Units are filed under the cell they were in
+	/// when build() was called, so every query widens its cell range by
+	/// SNAPSHOT_MARGIN and then re-checks the unit's current position. Units
+	/// created after build() (or moved farther than SNAPSHOT_MARGIN, e.g. by
+	/// Recall) are not found until the grid is rebuilt.
+
+	class SpatialGrid {
+	public:
+		static const int CELL_SHIFT = 7;
+		static const int CELL_SIZE = 1 << CELL_SHIFT;		//128 pixels
+		static const int MAX_CELLS_X = 256 * 32 / CELL_SIZE;
+		static const int MAX_CELLS_Y = 256 * 32 / CELL_SIZE;
+		static const int SNAPSHOT_MARGIN = 32;
+		static const int MAX_NEAREST_RESULTS = 64;
+
+		/// Default constructor. The grid is empty until build() is called.
+		SpatialGrid();
+
+		/// Rebuilds the grid from StarCraft's unit ordering arrays.
+		void build();
+
+		/// Empties the grid (e.g. when a new game starts).
+		void clear();
+
+		/// Returns true if the grid was built during the current frame, i.e. if
+		/// *elapsedTimeFrames has not changed since build(). Code running in the
+		/// unit updates gets false if StarCraft advances the counter between
+		/// hooks::nextFrame() and them, and must then fall back to UnitFinder.
+		bool isUpToDate() const;
+
+		/// Returns the number of units stored in the grid.
+		int getUnitCount() const;
+
+		/// Calls func() once for each unit whose collision box overlaps the given
+		/// bounds. This finds the same set of units as UnitFinder::search(), but
+		/// in a different order: cell by cell (row by row, left to right), and
+		/// in unitOrderingX order within each cell. UnitFinder returns units in
+		/// unitOrderingX order. Code that depends on the order (stopping at the
+		/// first match, keeping only the first N units, breaking ties) may get
+		/// different results with the grid.
+		template <class Callback>
+		void forEach(int left, int top, int right, int bottom, const Callback &func) const;
+
+		/// Returns the first unit (in forEach() order) within the given bounds
+		/// for which match() returns true. If there are no matches, returns
+		/// nullptr. This is not necessarily the unit UnitFinder::getFirst()
+		/// would return.
+		template <class Callback>
+		CUnit* getFirst(int left, int top, int right, int bottom, const Callback &match) const;
+
+		/// Returns the unit within the given bounds for which score() returns the
+		/// highest nonnegative integer. If there are no units, returns nullptr.
+		/// Note: If score() returns a negative value, the unit is ignored.
+		/// Ties go to the first unit in forEach() order.
+		template <class Callback>
+		CUnit* getBest(int left, int top, int right, int bottom, const Callback &score) const;
+
+		/// Calls func() once for each unit whose center is at most @p radius
+		/// pixels away from (@p x, @p y), measured with scbw::getDistanceFast().
+		template <class Callback>
+		void forEachInRadius(int x, int y, int radius, const Callback &func) const;
+
+		/// Finds up to @p maxResults units nearest to (@p x, @p y) for which
+		/// match(unit) evaluates to true, and whose centers are at most
+		/// @p maxDistance pixels away. @p sourceUnit is never included.
+		/// Results are saved to @p results, nearest first.
+		/// This does not use unit collision boxes for calculating distances.
+		///
+		/// @return   The number of units saved to @p results.
+		template <class Callback>
+		int getNearest(int x, int y, int maxDistance, const CUnit *sourceUnit,
+			const Callback &match, CUnit **results, int maxResults) const;
+
+		/// Searches the area given by (@p left, @p top, @p right, @p bottom),
+		/// returning the nearest unit to @p sourceUnit for which match(unit)
+		/// evaluates to true. If there are no matches, returns nullptr.
+		/// This is the grid counterpart of UnitFinder::getNearestTarget().
+		template <class Callback>
+		CUnit* getNearestTarget(int left, int top, int right, int bottom,
+			const CUnit *sourceUnit, const Callback &match) const;
+
+	private:
+		//Finds up to @p maxResults units whose centers are inside the given
+		//bounds, nearest to (x, y) first. Used by getNearest() and
+		//getNearestTarget().
+		template <class Callback>
+		int searchNearest(int x, int y, int left, int top, int right, int bottom,
+			u32 maxDistance, const CUnit *sourceUnit, const Callback &match,
+			CUnit **results, int maxResults) const;
+
+		int getCellX(int x) const;
+		int getCellY(int y) const;
+
+		int cellsX, cellsY;
+		int unitCount;
+		int maxExtentX, maxExtentY;	//Largest collision box half-size in the grid
+		u32 builtFrame;
+		bool isBuilt;
+
+		u16 cellStart[MAX_CELLS_X * MAX_CELLS_Y + 1];
+		u16 unitIndices[UNIT_ARRAY_LENGTH];
+	};
+
+	/// The shared unit grid, rebuilt at the start of every frame.
+	extern SpatialGrid spatialGrid;
+
+
+	//-------- Template member function definitions --------//
+
+	inline int SpatialGrid::getCellX(int x) const {
+		return CLAMP(x >> CELL_SHIFT, 0, this->cellsX - 1);
+	}
+
+	inline int SpatialGrid::getCellY(int y) const {
+		return CLAMP(y >> CELL_SHIFT, 0, this->cellsY - 1);
+	}
+
+	template <class Callback>
+	void SpatialGrid::forEach(int left, int top, int right, int bottom, const Callback &func) const {
+		if (this->unitCount == 0)
+			return;
+
+		const int cellLeft = getCellX(left - this->maxExtentX - SNAPSHOT_MARGIN);
+		const int cellRight = getCellX(right + this->maxExtentX + SNAPSHOT_MARGIN);
+		const int cellTop = getCellY(top - this->maxExtentY - SNAPSHOT_MARGIN);
+		const int cellBottom = getCellY(bottom + this->maxExtentY + SNAPSHOT_MARGIN);
+
+		for (int cy = cellTop; cy <= cellBottom; ++cy) {
+			for (int cx = cellLeft; cx <= cellRight; ++cx) {
+				const int cell = cy * this->cellsX + cx;
+
+				for (int i = this->cellStart[cell]; i < this->cellStart[cell + 1]; ++i) {
+					CUnit *unit = CUnit::getFromIndex(this->unitIndices[i]);
+					if (!unit->sprite)
+						continue;
+
+					if (unit->getLeft() < right && left <= unit->getRight()
+						&& unit->getTop() < bottom && top <= unit->getBottom())
+						func(unit);
+				}
+			}
+		}
+	}
+
+	template <class Callback>
+	CUnit* SpatialGrid::getFirst(int left, int top, int right, int bottom, const Callback &match) const {
+		CUnit *firstUnit = nullptr;
+
+		//forEach() cannot be interrupted, so skip the remaining units instead
+		this->forEach(left, top, right, bottom, [&firstUnit, &match](CUnit *unit) {
+			if (!firstUnit && match(unit))
+				firstUnit = unit;
+		});
+
+		return firstUnit;
+	}
+
+	template <class Callback>
+	CUnit* SpatialGrid::getBest(int left, int top, int right, int bottom, const Callback &score) const {
+		int bestScore = -1;
+		CUnit *bestUnit = nullptr;
+
+		this->forEach(left, top, right, bottom, [&bestScore, &bestUnit, &score](CUnit *unit) {
+			const int unitScore = score(unit);
+			if (unitScore > bestScore) {
+				bestUnit = unit;
+				bestScore = unitScore;
+			}
+		});
+
+		return bestUnit;
+	}
+
+	template <class Callback>
+	void SpatialGrid::forEachInRadius(int x, int y, int radius, const Callback &func) const {
+		if (this->unitCount == 0)
+			return;
+
+		const int cellLeft = getCellX(x - radius - SNAPSHOT_MARGIN);
+		const int cellRight = getCellX(x + radius + SNAPSHOT_MARGIN);
+		const int cellTop = getCellY(y - radius - SNAPSHOT_MARGIN);
+		const int cellBottom = getCellY(y + radius + SNAPSHOT_MARGIN);
+
+		for (int cy = cellTop; cy <= cellBottom; ++cy) {
+			for (int cx = cellLeft; cx <= cellRight; ++cx) {
+				const int cell = cy * this->cellsX + cx;
+
+				for (int i = this->cellStart[cell]; i < this->cellStart[cell + 1]; ++i) {
+					CUnit *unit = CUnit::getFromIndex(this->unitIndices[i]);
+					if (!unit->sprite)
+						continue;
+
+					if (getDistanceFast(x, y, unit->getX(), unit->getY()) <= (u32)radius)
+						func(unit);
+				}
+			}
+		}
+	}
+
+	template <class Callback>
+	int SpatialGrid::getNearest(int x, int y, int maxDistance, const CUnit *sourceUnit,
+		const Callback &match, CUnit **results, int maxResults) const
+	{
+		return this->searchNearest(x, y,
+			x - maxDistance, y - maxDistance, x + maxDistance + 1, y + maxDistance + 1,
+			maxDistance, sourceUnit, match, results, maxResults);
+	}
+
+	template <class Callback>
+	CUnit* SpatialGrid::getNearestTarget(int left, int top, int right, int bottom,
+		const CUnit *sourceUnit, const Callback &match) const
+	{
+		CUnit *result = nullptr;
+		this->searchNearest(sourceUnit->getX(), sourceUnit->getY(),
+			left, top, right, bottom, 0xFFFFFFFF, sourceUnit, match, &result, 1);
+		return result;
+	}
+
+	//Expands the search ring by ring, starting from the cell containing (x, y).
+	//The search stops once the nearest possible unit in the next ring is farther
+	//away than the worst result found so far.
+	template <class Callback>
+	int SpatialGrid::searchNearest(int x, int y, int left, int top, int right, int bottom,
+		u32 maxDistance, const CUnit *sourceUnit, const Callback &match,
+		CUnit **results, int maxResults) const
+	{
+		if (this->unitCount == 0 || maxResults <= 0)
+			return 0;
+
+		maxResults = std::min(maxResults, (int)MAX_NEAREST_RESULTS);
+		u32 distances[MAX_NEAREST_RESULTS];
+		int resultCount = 0;
+
+		const int centerX = getCellX(x), centerY = getCellY(y);
+		const int cellLeft = getCellX(left - SNAPSHOT_MARGIN);
+		const int cellRight = getCellX(right + SNAPSHOT_MARGIN);
+		const int cellTop = getCellY(top - SNAPSHOT_MARGIN);
+		const int cellBottom = getCellY(bottom + SNAPSHOT_MARGIN);
+
+		const int maxRing = std::max(
+			std::max(centerX - cellLeft, cellRight - centerX),
+			std::max(centerY - cellTop, cellBottom - centerY));
+
+		for (int ring = 0; ring <= maxRing; ++ring) {
+			//getDistanceFast() never underestimates max(dx, dy) by more than 1.
+			const int ringDistance = (ring - 1) * CELL_SIZE - SNAPSHOT_MARGIN - 1;
+			if (ringDistance > 0) {
+				if ((u32)ringDistance > maxDistance)
+					break;
+				if (resultCount == maxResults && (u32)ringDistance > distances[resultCount - 1])
+					break;
+			}
+
+			for (int cy = std::max(centerY - ring, cellTop); cy <= std::min(centerY + ring, cellBottom); ++cy) {
+				//Only visit the cells on the edge of the current ring
+				const bool isEdgeRow = (cy == centerY - ring || cy == centerY + ring);
+				const int step = isEdgeRow ? 1 : ring * 2;
+
+				for (int cx = centerX - ring; cx <= centerX + ring; cx += std::max(step, 1)) {
+					if (cx < cellLeft || cx > cellRight)
+						continue;
+
+					const int cell = cy * this->cellsX + cx;
+
+					for (int i = this->cellStart[cell]; i < this->cellStart[cell + 1]; ++i) {
+						CUnit *unit = CUnit::getFromIndex(this->unitIndices[i]);
+						if (unit == sourceUnit || !unit->sprite)
+							continue;
+
+						const int unitX = unit->getX(), unitY = unit->getY();
+						if (!(left <= unitX && unitX < right && top <= unitY && unitY < bottom))
+							continue;
+
+						const u32 distance = getDistanceFast(x, y, unitX, unitY);
+						if (distance > maxDistance)
+							continue;
+						if (resultCount == maxResults && distance >= distances[resultCount - 1])
+							continue;
+						if (!match(unit))
+							continue;
+
+						//Insert the unit, keeping the results sorted by distance
+						int pos = (resultCount < maxResults) ? resultCount++ : resultCount - 1;
+						while (pos > 0 && distances[pos - 1] > distance) {
+							distances[pos] = distances[pos - 1];
+							results[pos] = results[pos - 1];
+							--pos;
+						}
+						distances[pos] = distance;
+						results[pos] = unit;
+					}
+				}
+			}
+		}
+
+		return resultCount;
+	}
+
+} //scbw
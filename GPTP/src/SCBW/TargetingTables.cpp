@@ -0,0 +1,100 @@
+#include "TargetingTables.h"
+#include "enumerations.h"
+#include <cstring>
+
+namespace scbw {
+
+	TargetingTables targetingTables;
+
+	namespace {
+
+		//Same type-level checks as scbw::canWeaponTargetUnit()
+		bool canTargetProperties(const TargetFlag &tf, u32 targetProps) {
+			if (tf.mechanical && !(targetProps & UnitProperty::Mechanical))
+				return false;
+
+			if (tf.organic && !(targetProps & UnitProperty::Organic))
+				return false;
+
+			if (tf.nonBuilding && (targetProps & UnitProperty::Building))
+				return false;
+
+			if (tf.nonRobotic && (targetProps & UnitProperty::RoboticUnit))
+				return false;
+
+			if (tf.orgOrMech && !(targetProps & (UnitProperty::Organic | UnitProperty::Mechanical)))
+				return false;
+
+			return true;
+		}
+
+		//Same type-level checks as hooks::getAttackPriorityHook()
+		u8 getTypePriorityClass(u16 unitId, u32 unitProps) {
+			if (unitId == UnitId::larva
+				|| unitId == UnitId::egg
+				|| unitId == UnitId::cocoon
+				|| unitId == UnitId::lurker_egg)
+				return AttackPriorityClass::Unimportant;
+
+			if (unitProps & UnitProperty::Worker)
+				return AttackPriorityClass::Worker;
+
+			return AttackPriorityClass::Normal;
+		}
+
+	} //unnamed namespace
+
+	void TargetingTables::build() {
+		this->builtVersion = typeInfoCache.getVersion();
+
+		std::memset(this->groundTargets, 0, sizeof(this->groundTargets));
+		std::memset(this->airTargets, 0, sizeof(this->airTargets));
+
+		for (int weaponId = 0; weaponId < WEAPON_TYPE_COUNT; ++weaponId) {
+			const TargetFlag &tf = typeInfoCache.getWeapon(weaponId).targetFlags;
+			this->ownUnitsOnly[weaponId] = tf.playerOwned != 0;
+
+			if (!tf.ground && !tf.air)
+				continue;
+
+			for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+				if (!canTargetProperties(tf, typeInfoCache.getUnit(unitId).baseProperty))
+					continue;
+
+				const u32 bit = 1u << (unitId % 32);
+				if (tf.ground)
+					this->groundTargets[weaponId][unitId / 32] |= bit;
+				if (tf.air)
+					this->airTargets[weaponId][unitId / 32] |= bit;
+			}
+		}
+
+		for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId)
+			this->priorityClass[unitId] = getTypePriorityClass(unitId, typeInfoCache.getUnit(unitId).baseProperty);
+	}
+
+	void TargetingTables::invalidate() {
+		typeInfoCache.invalidate();
+	}
+
+	bool TargetingTables::canWeaponTargetUnit(u8 weaponId, const CUnit *target, const CUnit *attacker) {
+		if (weaponId >= WEAPON_TYPE_COUNT)
+			return false;
+
+		if (!target)
+			return typeInfoCache.getWeapon(weaponId).targetFlags.terrain != 0;
+
+		if (target->status & UnitStatus::Invincible)
+			return false;
+
+		//Air / ground, mechanical, organic, building and robotic checks
+		if (!this->canTargetType(weaponId, target->id, (target->status & UnitStatus::InAir) != 0))
+			return false;
+
+		if (this->ownUnitsOnly[weaponId] && target->playerId != attacker->playerId)
+			return false;
+
+		return true;
+	}
+
+} //scbw
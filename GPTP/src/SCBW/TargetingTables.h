@@ -0,0 +1,110 @@
+#pragma once
+#include "scbwdata.h"
+#include "TypeInfoCache.h"
+
+namespace scbw {
+
+	namespace AttackPriorityClass {
+		enum Enum {
+			Normal,			//Priority depends on what the unit can do
+			Worker,			//UnitProperty::Worker
+			Unimportant,	//Larvae, eggs, cocoons and lurker eggs
+		};
+	}
+
+	/// The TargetingTables class holds type-level targeting facts derived from
+	/// the DAT arrays, so that per-pair checks (canWeaponTargetUnit() below,
+	/// hooks::getAttackPriorityHook()) become table lookups plus the few checks
+	/// that depend on the unit's current state:
+	///
+	///   - For each weapon and unit type: can the weapon target the unit type
+	///     on the ground / in the air, according to weapons_dat::TargetFlags
+	///     and units_dat::BaseProperty?
+	///   - For each unit type: its attack priority class.
+	///
+	/// The tables are built from scbw::typeInfoCache, and follow it: every
+	/// lookup compares the version of the cache the tables were built from
+	/// with the current one, and rebuilds the tables if the cache has changed.
+	/// The cache is rebuilt every frame, and after invalidate() (see
+	/// TypeInfoCache.h), so code that changes the DAT arrays during a frame
+	/// only needs to call invalidate() for the next lookup to see the change.
+
+	class TargetingTables {
+	public:
+		TargetingTables() : builtVersion(0) {}
+
+		/// Builds the tables from scbw::typeInfoCache.
+		void build();
+
+		/// Makes the next lookup rebuild scbw::typeInfoCache, and the tables
+		/// if the cache has changed. Same as typeInfoCache.invalidate().
+		void invalidate();
+
+		/// Returns true if @p weaponId can target units of type @p unitId that
+		/// are in the air (@p isInAir) or on the ground. Does not check
+		/// TargetFlag::playerOwned (see isOwnUnitsOnly()).
+		bool canTargetType(u8 weaponId, u16 unitId, bool isInAir);
+
+		/// Returns true if @p weaponId can only target units owned by the
+		/// attacker's player.
+		bool isOwnUnitsOnly(u8 weaponId);
+
+		/// Returns the AttackPriorityClass::Enum of @p unitId.
+		u8 getPriorityClass(u16 unitId);
+
+		/// Same as scbw::canWeaponTargetUnit(), with the type-level checks
+		/// answered by the tables. Hook code calls this one; the function in
+		/// api.cpp stays identical to StarCraft's.
+		bool canWeaponTargetUnit(u8 weaponId, const CUnit *target = nullptr,
+			const CUnit *attacker = nullptr);
+
+	private:
+		static const int UNIT_WORDS = (UNIT_TYPE_COUNT + 31) / 32;
+
+		//Rebuilds the tables if scbw::typeInfoCache has changed
+		void ensureCurrent();
+
+		u32 groundTargets[WEAPON_TYPE_COUNT][UNIT_WORDS];
+		u32 airTargets[WEAPON_TYPE_COUNT][UNIT_WORDS];
+		bool ownUnitsOnly[WEAPON_TYPE_COUNT];
+		u8 priorityClass[UNIT_TYPE_COUNT];
+
+		u32 builtVersion;		//TypeInfoCache::getVersion() at the last build
+	};
+
+	/// The shared targeting tables.
+	extern TargetingTables targetingTables;
+
+	//-------- Inline member function definitions --------//
+
+	inline void TargetingTables::ensureCurrent() {
+		if (this->builtVersion != typeInfoCache.getVersion())
+			this->build();
+	}
+
+	inline bool TargetingTables::canTargetType(u8 weaponId, u16 unitId, bool isInAir) {
+		if (weaponId >= WEAPON_TYPE_COUNT || unitId >= UNIT_TYPE_COUNT)
+			return false;
+
+		this->ensureCurrent();
+		const u32 *words = isInAir ? this->airTargets[weaponId] : this->groundTargets[weaponId];
+		return (words[unitId / 32] & (1u << (unitId % 32))) != 0;
+	}
+
+	inline bool TargetingTables::isOwnUnitsOnly(u8 weaponId) {
+		if (weaponId >= WEAPON_TYPE_COUNT)
+			return false;
+
+		this->ensureCurrent();
+		return this->ownUnitsOnly[weaponId];
+	}
+
+	inline u8 TargetingTables::getPriorityClass(u16 unitId) {
+		if (unitId >= UNIT_TYPE_COUNT)
+			return AttackPriorityClass::Normal;
+
+		this->ensureCurrent();
+		return this->priorityClass[unitId];
+	}
+
+} //scbw
@@ -0,0 +1,69 @@
+#include "TypeInfoCache.h"
+#include <cstring>
+
+namespace scbw {
+
+	TypeInfoCache typeInfoCache;
+
+	bool TypeInfoCache::build() {
+		bool hasChanged = false;
+
+		for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+			UnitTypeInfo info;
+			std::memset(&info, 0, sizeof(info));
+			info.baseProperty = units_dat::BaseProperty[unitId];
+			info.maxHitPoints = units_dat::MaxHitPoints[unitId];
+			info.maxShieldPoints = units_dat::MaxShieldPoints[unitId];
+			info.groundWeapon = units_dat::GroundWeapon[unitId];
+			info.airWeapon = units_dat::AirWeapon[unitId];
+			info.seekRange = units_dat::SeekRange[unitId];
+			info.sightRange = units_dat::SightRange[unitId];
+			info.sizeType = units_dat::SizeType[unitId];
+			info.movementFlags = units_dat::MovementFlags[unitId];
+			info.groupFlags = units_dat::GroupFlags[unitId];
+			info.shieldsEnabled = units_dat::ShieldsEnabled[unitId];
+			info.maxGroundHits = units_dat::MaxGroundHits[unitId];
+			info.maxAirHits = units_dat::MaxAirHits[unitId];
+			info.bounds = units_dat::UnitBounds[unitId];
+			info.armorAmount = units_dat::ArmorAmount[unitId];
+			info.armorUpgrade = units_dat::ArmorUpgrade[unitId];
+
+			if (std::memcmp(&info, &this->unitTypes[unitId], sizeof(info)) != 0) {
+				this->unitTypes[unitId] = info;
+				hasChanged = true;
+			}
+		}
+
+		for (int weaponId = 0; weaponId < WEAPON_TYPE_COUNT; ++weaponId) {
+			WeaponTypeInfo info;
+			std::memset(&info, 0, sizeof(info));
+			info.minRange = weapons_dat::MinRange[weaponId];
+			info.maxRange = weapons_dat::MaxRange[weaponId];
+			info.targetFlags = weapons_dat::TargetFlags[weaponId];
+			info.damageAmount = weapons_dat::DamageAmount[weaponId];
+			info.damageBonus = weapons_dat::DamageBonus[weaponId];
+			info.innerSplashRadius = weapons_dat::InnerSplashRadius[weaponId];
+			info.mediumSplashRadius = weapons_dat::MediumSplashRadius[weaponId];
+			info.outerSplashRadius = weapons_dat::OuterSplashRadius[weaponId];
+			info.damageType = weapons_dat::DamageType[weaponId];
+			info.damageFactor = weapons_dat::DamageFactor[weaponId];
+			info.damageUpgrade = weapons_dat::DamageUpgrade[weaponId];
+			info.cooldown = weapons_dat::Cooldown[weaponId];
+			info.attackAngle = weapons_dat::AttackAngle[weaponId];
+			info.explosionType = weapons_dat::ExplosionType[weaponId];
+			info.behavior = weapons_dat::Behavior[weaponId];
+
+			if (std::memcmp(&info, &this->weaponTypes[weaponId], sizeof(info)) != 0) {
+				this->weaponTypes[weaponId] = info;
+				hasChanged = true;
+			}
+		}
+
+		//WeaponId::None stays all zero
+		if (hasChanged)
+			++this->version;
+		this->isDirty = false;
+		return hasChanged;
+	}
+
+} //scbw
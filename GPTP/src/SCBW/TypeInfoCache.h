@@ -0,0 +1,122 @@
+#pragma once
+#include "scbwdata.h"
+#include <cassert>
+
+namespace scbw {
+
+	/// The units.dat fields most used by hooks, packed together for one unit
+	/// type (32 bytes, so two unit types share a cache line).
+	struct UnitTypeInfo {
+		u32 baseProperty;		//units_dat::BaseProperty (UnitProperty::Enum)
+		s32 maxHitPoints;
+		u16 maxShieldPoints;
+		u8 groundWeapon;		//WeaponId::None if the unit has no ground weapon
+		u8 airWeapon;			//WeaponId::None if the unit has no air weapon
+		u8 seekRange;
+		u8 sightRange;
+		u8 sizeType;
+		u8 movementFlags;
+		GroupFlag groupFlags;
+		u8 shieldsEnabled;
+		u8 maxGroundHits;
+		u8 maxAirHits;
+		Box16 bounds;			//units_dat::UnitBounds
+		u8 armorAmount;
+		u8 armorUpgrade;
+		u8 padding[2];
+
+		/// Returns true if the unit type has all the UnitProperty::Enum bits in
+		/// @p properties.
+		bool hasProperty(u32 properties) const { return (this->baseProperty & properties) == properties; }
+	};
+
+	static_assert(sizeof(UnitTypeInfo) == 32, "The size of the UnitTypeInfo structure is invalid");
+
+	/// The weapons.dat fields most used by hooks, packed together for one
+	/// weapon type.
+	struct WeaponTypeInfo {
+		u32 minRange;
+		u32 maxRange;
+		TargetFlag targetFlags;
+		u16 damageAmount;
+		u16 damageBonus;
+		u16 innerSplashRadius;
+		u16 mediumSplashRadius;
+		u16 outerSplashRadius;
+		u8 damageType;			//DamageType::Enum
+		u8 damageFactor;
+		u8 damageUpgrade;
+		u8 cooldown;
+		u8 attackAngle;
+		u8 explosionType;		//WeaponEffect::Enum
+		u8 behavior;			//WeaponBehavior::Enum
+		u8 padding[5];
+	};
+
+	static_assert(sizeof(WeaponTypeInfo) == 32, "The size of the WeaponTypeInfo structure is invalid");
+
+	/// The TypeInfoCache class copies the DAT fields read by hot hook code into
+	/// UnitTypeInfo and WeaponTypeInfo arrays. Reading units_dat::SizeType[id]
+	/// first loads the array address from the DAT loading table, and each
+	/// field lives in a different array; with the cache, all fields of a unit
+	/// type are read from the same cache line:
+	///
+	///   const scbw::UnitTypeInfo &info = scbw::typeInfoCache.getUnit(target->id);
+	///   if (info.shieldsEnabled && info.sizeType == UnitSize::Large) { ... }
+	///
+	/// The cache is built by hooks::gameOn(), and rebuilt at the start of every
+	/// frame by hooks::nextFrame() (a few thousand byte copies), so changes a
+	/// plugin makes to the DAT arrays between frames are picked up. Code that
+	/// changes the DAT arrays during a frame must call invalidate(): the next
+	/// lookup then rebuilds the cache, and scbw::targetingTables, which is
+	/// built from the cache, rebuilds itself at its next lookup too.
+
+	class TypeInfoCache {
+	public:
+		TypeInfoCache() : version(0), isDirty(false) {}
+
+		/// Copies the fields from the current DAT arrays. Returns true if any
+		/// cached field has changed since the last build.
+		bool build();
+
+		/// Makes the next lookup rebuild the cache. Call this after changing
+		/// the DAT arrays.
+		void invalidate() { this->isDirty = true; }
+
+		/// Returns a number that changes whenever a build changes the cache.
+		u32 getVersion() {
+			this->ensureBuilt();
+			return this->version;
+		}
+
+		/// Returns the cached units.dat fields of @p unitId.
+		const UnitTypeInfo& getUnit(u16 unitId) {
+			assert(unitId < UNIT_TYPE_COUNT);
+			this->ensureBuilt();
+			return this->unitTypes[unitId];
+		}
+
+		/// Returns the cached weapons.dat fields of @p weaponId. Fields of
+		/// WeaponId::None are all zero.
+		const WeaponTypeInfo& getWeapon(u8 weaponId) {
+			assert(weaponId <= WEAPON_TYPE_COUNT);
+			this->ensureBuilt();
+			return this->weaponTypes[weaponId];
+		}
+
+	private:
+		inline void ensureBuilt() {
+			if (this->isDirty)
+				this->build();
+		}
+
+		UnitTypeInfo unitTypes[UNIT_TYPE_COUNT];
+		WeaponTypeInfo weaponTypes[WEAPON_TYPE_COUNT + 1];	//Includes WeaponId::None
+		u32 version;
+		bool isDirty;
+	};
+
+	/// The shared type info cache.
+	extern TypeInfoCache typeInfoCache;
+
+} //scbw
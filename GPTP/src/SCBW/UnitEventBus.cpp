@@ -0,0 +1,150 @@
+#include "UnitEventBus.h"
+#include "UnitRegistry.h"
+#include "enumerations.h"
+#include <cassert>
+
+namespace scbw {
+
+	UnitEventBus unitEventBus;
+
+	UnitEventBus::UnitEventBus() : subscriberCount(0), watchedStatusFlags(0) {
+		this->clear();
+	}
+
+	int UnitEventBus::subscribe(Handler handler, u32 eventMask, u32 statusFlags) {
+		assert(handler);
+		if (this->subscriberCount >= MAX_SUBSCRIBERS)
+			return -1;
+
+		Subscriber &subscriber = this->subscribers[this->subscriberCount];
+		subscriber.handler = handler;
+		subscriber.eventMask = eventMask;
+		subscriber.statusFlags = statusFlags;
+
+		if (eventMask & unitEventBit(UnitEventType::StatusFlagsChanged))
+			this->watchedStatusFlags |= statusFlags;
+
+		return this->subscriberCount++;
+	}
+
+	void UnitEventBus::clearSubscribers() {
+		this->subscriberCount = 0;
+		this->watchedStatusFlags = 0;
+	}
+
+	void UnitEventBus::clear() {
+		for (int i = 0; i <= UNIT_ARRAY_LENGTH; ++i) {
+			UnitShadow &shadow = this->shadows[i];
+			shadow.unitId = UnitId::None;
+			shadow.playerId = 0;
+			shadow.mainOrderId = 0;
+			shadow.status = 0;
+		}
+
+		this->eventCount[0] = this->eventCount[1] = 0;
+		this->activeBuffer = 0;
+		this->droppedCount = 0;
+	}
+
+	void UnitEventBus::post(UnitEventType::Enum type, u16 unitIndex, u32 oldValue, u32 newValue) {
+		int &count = this->eventCount[this->activeBuffer];
+		if (count >= MAX_EVENTS) {
+			this->droppedCount++;
+			return;
+		}
+
+		UnitEvent &event = this->buffers[this->activeBuffer][count++];
+		event.type = (u8)type;
+		event.padding = 0;
+		event.unitIndex = unitIndex;
+		event.oldValue = oldValue;
+		event.newValue = newValue;
+	}
+
+	void UnitEventBus::update(const CUnit *unit) {
+		assert(unit);
+		if (!unit->sprite || unit->id >= UNIT_TYPE_COUNT)
+			return;
+
+		const u16 index = unit->getIndex();
+		UnitShadow &shadow = this->shadows[index];
+
+		if (shadow.unitId == UnitId::None) {
+			this->post(UnitEventType::Created, index, 0, unit->id);
+		}
+		else {
+			if (shadow.unitId != unit->id)
+				this->post(UnitEventType::Morphed, index, shadow.unitId, unit->id);
+			if (shadow.playerId != unit->playerId)
+				this->post(UnitEventType::OwnerChanged, index, shadow.playerId, unit->playerId);
+			if (shadow.mainOrderId != unit->mainOrderId)
+				this->post(UnitEventType::MainOrderChanged, index, shadow.mainOrderId, unit->mainOrderId);
+			if ((shadow.status ^ unit->status) & this->watchedStatusFlags)
+				this->post(UnitEventType::StatusFlagsChanged, index, shadow.status, unit->status);
+		}
+
+		shadow.unitId = unit->id;
+		shadow.playerId = unit->playerId;
+		shadow.mainOrderId = unit->mainOrderId;
+		shadow.status = unit->status;
+	}
+
+	void UnitEventBus::remove(const CUnit *unit) {
+		assert(unit);
+		const u16 index = unit->getIndex();
+		UnitShadow &shadow = this->shadows[index];
+
+		//Units that were never reported as created are not reported as destroyed
+		if (shadow.unitId == UnitId::None)
+			return;
+
+		this->post(UnitEventType::Destroyed, index, shadow.unitId, 0);
+		shadow.unitId = UnitId::None;
+	}
+
+	void UnitEventBus::changeOwner(const CUnit *unit, u8 playerId) {
+		assert(unit);
+		const u16 index = unit->getIndex();
+		UnitShadow &shadow = this->shadows[index];
+
+		if (shadow.unitId == UnitId::None || shadow.playerId == playerId)
+			return;
+
+		this->post(UnitEventType::OwnerChanged, index, shadow.playerId, playerId);
+		shadow.playerId = playerId;
+	}
+
+	void UnitEventBus::dispatch() {
+		//Compare by unit index rather than in unit list order, which changes
+		//whenever units move around in the list
+		unitRegistry.all().forEach([this](CUnit *unit) {
+			this->update(unit);
+		});
+
+		//Swap the buffers, so that events raised by subscribers go to the next batch
+		const int deliveredBuffer = this->activeBuffer;
+		const int count = this->eventCount[deliveredBuffer];
+		this->activeBuffer = 1 - deliveredBuffer;
+		this->eventCount[this->activeBuffer] = 0;
+
+		const UnitEvent *events = this->buffers[deliveredBuffer];
+		for (int i = 0; i < count; ++i) {
+			const UnitEvent &event = events[i];
+			const u32 eventBit = 1u << event.type;
+
+			for (int s = 0; s < this->subscriberCount; ++s) {
+				const Subscriber &subscriber = this->subscribers[s];
+				if (!(subscriber.eventMask & eventBit))
+					continue;
+				if (event.type == UnitEventType::StatusFlagsChanged
+					&& !((event.oldValue ^ event.newValue) & subscriber.statusFlags))
+					continue;
+
+				subscriber.handler(event);
+			}
+		}
+
+		this->eventCount[deliveredBuffer] = 0;
+	}
+
+} //scbw
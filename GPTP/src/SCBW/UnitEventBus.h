@@ -0,0 +1,134 @@
+#pragma once
+#include "scbwdata.h"
+
+namespace scbw {
+
+	namespace UnitEventType {
+		enum Enum {
+			Created,			//newValue = unit type
+			Destroyed,			//oldValue = unit type
+			Morphed,			//oldValue / newValue = unit type
+			OwnerChanged,		//oldValue / newValue = player ID
+			MainOrderChanged,	//oldValue / newValue = order ID
+			StatusFlagsChanged,	//oldValue / newValue = CUnit::status
+			COUNT
+		};
+	}
+
+	/// Returns the bit of @p type in an event mask (see UnitEventBus::subscribe()).
+	inline u32 unitEventBit(UnitEventType::Enum type) { return 1u << type; }
+
+	struct UnitEvent {
+		u8 type;			//UnitEventType::Enum
+		u8 padding;
+		u16 unitIndex;		//CUnit::getIndex()
+		u32 oldValue;
+		u32 newValue;
+
+		/// Returns the unit. For Destroyed events, the unit slot may already
+		/// have been reused by a new unit.
+		CUnit* getUnit() const { return CUnit::getFromIndex(this->unitIndex); }
+	};
+
+	/// The UnitEventBus tells plugin code when units are created, destroyed,
+	/// morphed, change owners, or change their main order or status flags, so
+	/// that feature code does not have to poll every unit every frame:
+	///
+	///   void onOrderChanged(const scbw::UnitEvent &event) {
+	///     if (event.newValue == OrderId::Stop) { /* ... */ }
+	///   }
+	///   scbw::unitEventBus.subscribe(onOrderChanged,
+	///     scbw::unitEventBit(scbw::UnitEventType::MainOrderChanged));
+	///
+	/// Events are reported right away by the hooks that already know about
+	/// them (unitDestructorSpecialHook(), transferUnitTechToPlayerHook(),
+	/// scbw::createUnitAtPos(), CUnit::giveTo(), ...). Everything else is found
+	/// by comparing the visible unit list with a compact copy of each unit's
+	/// type, owner, main order and status from the previous frame. Only units
+	/// in scbw::unitRegistry are compared.
+	///
+	/// Events are collected during the frame and delivered together by
+	/// dispatch(), once per frame: first the events reported by hooks (in the
+	/// order they happened), then the ones found by the comparison (in
+	/// ascending unit index order). Each event is passed to the subscribers in
+	/// the order they subscribed. Events raised by subscribers are delivered
+	/// in the next batch. No memory is allocated while dispatching.
+
+	class UnitEventBus {
+	public:
+		typedef void (*Handler)(const UnitEvent &event);
+
+		/// Maximum number of subscribers.
+		static const int MAX_SUBSCRIBERS = 32;
+		/// Maximum number of events delivered per frame. Further events are
+		/// dropped and counted by getDroppedCount().
+		static const int MAX_EVENTS = 8192;
+
+		UnitEventBus();
+
+		/// Registers @p handler for the event types in @p eventMask (see
+		/// unitEventBit()), and returns its ID (or -1 if there are too many
+		/// subscribers). StatusFlagsChanged events are only reported for
+		/// changes in @p statusFlags (UnitStatus::Enum bits).
+		int subscribe(Handler handler, u32 eventMask, u32 statusFlags = 0);
+
+		/// Removes all subscribers.
+		void clearSubscribers();
+
+		/// Forgets all units and pending events. Called when a game starts.
+		void clear();
+
+		/// Compares @p unit with its copy from the previous check, and reports
+		/// any changes. Called by GPTP code that creates, morphs or gives away
+		/// units.
+		void update(const CUnit *unit);
+
+		/// Reports that @p unit is being destroyed.
+		void remove(const CUnit *unit);
+
+		/// Reports that @p unit is about to be given to @p playerId.
+		void changeOwner(const CUnit *unit, u8 playerId);
+
+		/// Checks the visible unit list for changes, and delivers the events of
+		/// the last frame. Called once per frame from hooks::nextFrame(), after
+		/// scbw::unitRegistry.sync().
+		void dispatch();
+
+		/// Returns the number of events dropped since clear(), because more
+		/// than MAX_EVENTS happened in a single frame.
+		u32 getDroppedCount() const { return this->droppedCount; }
+
+	private:
+		//What the bus last knew about a unit
+		struct UnitShadow {
+			u16 unitId;			//UnitId::None if the unit does not exist
+			u8 playerId;
+			u8 mainOrderId;
+			u32 status;
+		};
+
+		struct Subscriber {
+			Handler handler;
+			u32 eventMask;
+			u32 statusFlags;
+		};
+
+		void post(UnitEventType::Enum type, u16 unitIndex, u32 oldValue, u32 newValue);
+
+		UnitShadow shadows[UNIT_ARRAY_LENGTH + 1];
+
+		Subscriber subscribers[MAX_SUBSCRIBERS];
+		int subscriberCount;
+		u32 watchedStatusFlags;		//Union of all subscribers' statusFlags
+
+		//Events are collected in one buffer while the other one is delivered
+		UnitEvent buffers[2][MAX_EVENTS];
+		int eventCount[2];
+		int activeBuffer;
+		u32 droppedCount;
+	};
+
+	/// The shared unit event bus.
+	extern UnitEventBus unitEventBus;
+
+} //scbw
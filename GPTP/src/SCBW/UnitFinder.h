@@ -1,5 +1,7 @@
 #pragma once
 #include "scbwdata.h"
+#include "api.h"
+#include "UnitSnapshot.h"
 #include <algorithm>
 
 namespace scbw {
@@ -99,10 +101,10 @@ namespace scbw {
 		CUnit *bestUnit = nullptr;
 
 		for (int i = 0; i < this->getUnitCount(); ++i) {
-			const int score = score(this->getUnit(i));
-			if (score > bestScore) {
+			const int unitScore = score(this->getUnit(i));
+			if (unitScore > bestScore) {
 				bestUnit = this->getUnit(i);
-				bestScore = score;
+				bestScore = unitScore;
 			}
 		}
 
@@ -128,102 +130,108 @@ namespace scbw {
 		CUnit *bestUnit = nullptr;
 		bool canContinueSearch, hasFoundBestUnit;
 
+		UnitFinderData *const startX = getStartX(), *const endX = getEndX();
+		UnitFinderData *const startY = getStartY(), *const endY = getEndY();
+
+		//Matching units found in one step (one per direction), measured
+		//together with UnitSnapshot::getDistancesFast()
+		CUnit *candidates[4];
+		s16 candidateX[4], candidateY[4];
+		u32 candidateDistances[4];
+
 		do {
 			canContinueSearch = false;
 			hasFoundBestUnit = false;
+			int candidateCount = 0;
 
 			//Search to the left
-			if (getStartX() <= left) {
+			if (startX <= left) {
 				CUnit *unit = CUnit::getFromIndex(left->unitIndex);
 
 				if (boundsLeft <= unit->getX()) {
 					if (boundsTop <= unit->getY() && unit->getY() < boundsBottom) {
-						if (unit != sourceUnit && match(unit)) {
-							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
-							if (distance < bestDistance) {
-								bestDistance = distance;
-								bestUnit = unit;
-								hasFoundBestUnit = true;
-							}
-						}
+						if (unit != sourceUnit && match(unit))
+							candidates[candidateCount++] = unit;
 					}
 				}
 				else
-					left = getStartX() - 1;
+					left = startX - 1;
 
 				canContinueSearch = true;
 				--left;
 			}
 
 			//Search to the right
-			if (right < getEndX()) {
+			if (right < endX) {
 				CUnit *unit = CUnit::getFromIndex(right->unitIndex);
 
 				if (unit->getX() < boundsRight) {
 					if (boundsTop <= unit->getY() && unit->getY() < boundsBottom) {
-						if (unit != sourceUnit && match(unit)) {
-							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
-							if (distance < bestDistance) {
-								bestDistance = distance;
-								bestUnit = unit;
-								hasFoundBestUnit = true;
-							}
-						}
+						if (unit != sourceUnit && match(unit))
+							candidates[candidateCount++] = unit;
 					}
 				}
 				else
-					right = getEndX();
+					right = endX;
 
 				canContinueSearch = true;
 				++right;
 			}
 
 			//Search upwards
-			if (getStartY() <= top) {
+			if (startY <= top) {
 				CUnit *unit = CUnit::getFromIndex(top->unitIndex);
 
 				if (boundsTop <= unit->getY()) {
 					if (boundsLeft <= unit->getX() && unit->getX() < boundsRight) {
-						if (unit != sourceUnit && match(unit)) {
-							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
-							if (distance < bestDistance) {
-								bestDistance = distance;
-								bestUnit = unit;
-								hasFoundBestUnit = true;
-							}
-						}
+						if (unit != sourceUnit && match(unit))
+							candidates[candidateCount++] = unit;
 					}
 				}
 				else
-					top = getStartY() - 1;
+					top = startY - 1;
 
 				canContinueSearch = true;
 				--top;
 			}
 
 			//Search downwards
-			if (bottom < getEndY()) {
+			if (bottom < endY) {
 				CUnit *unit = CUnit::getFromIndex(bottom->unitIndex);
 
 				if (unit->getY() < boundsBottom) {
 					if (boundsLeft <= unit->getX() && unit->getX() < boundsRight) {
-						if (unit != sourceUnit && match(unit)) {
-							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
-							if (distance < bestDistance) {
-								bestDistance = distance;
-								bestUnit = unit;
-								hasFoundBestUnit = true;
-							}
-						}
+						if (unit != sourceUnit && match(unit))
+							candidates[candidateCount++] = unit;
 					}
 				}
 				else
-					bottom = getEndY();
+					bottom = endY;
 
 				canContinueSearch = true;
 				++bottom;
 			}
 
+			//Compare the units in the order they were found. Unused lanes repeat
+			//the last unit.
+			if (candidateCount > 0) {
+				for (int i = 0; i < 4; ++i) {
+					const CUnit *unit = candidates[std::min(i, candidateCount - 1)];
+					candidateX[i] = unit->getX();
+					candidateY[i] = unit->getY();
+				}
+				UnitSnapshot::getDistancesFast(x, y, candidateX, candidateY, 4, candidateDistances);
+
+				for (int i = 0; i < candidateCount; ++i) {
+					const int distance = candidateDistances[i];
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						bestUnit = candidates[i];
+						hasFoundBestUnit = true;
+					}
+				}
+			}
+
 			//Reduce the search bounds
 			if (hasFoundBestUnit) {
 				boundsLeft = std::max(boundsLeft, x - bestDistance);
@@ -0,0 +1,141 @@
+#pragma once
+#include "scbwdata.h"
+
+namespace scbw {
+
+	/// The UnitRegistry class keeps track of which units (in the visible unit
+	/// list) belong to each unit type and each player, as bitsets indexed by
+	/// CUnit::getIndex(). Instead of walking the whole unit list to find e.g.
+	/// every Supply Depot, feature code can visit only the matching units:
+	///
+	///   scbw::unitRegistry.ofType(UnitId::supply_depot).forEach([](CUnit *unit) {
+	///     //...
+	///   });
+	///
+	/// The registry is updated immediately when GPTP itself kills, creates,
+	/// morphs or gives away a unit (see unitDestructorSpecialHook(),
+	/// scbw::createUnitAtPos(), CUnit::giveTo()). Changes made by StarCraft's
+	/// own code (unit births, morphs, units being loaded/unloaded) have no
+	/// hook, so they are picked up by sync() at the start of every frame.
+	///
+	/// Note: Units are visited in ascending index order, not in the order of
+	/// the unit list.
+
+	class UnitRegistry {
+	public:
+		/// Number of 32-bit words in each bitset. Slot 0 is never used.
+		static const int WORD_COUNT = (UNIT_ARRAY_LENGTH + 1 + 31) / 32;
+
+		/// A set of units, one bit per unit index.
+		class UnitSet {
+		public:
+			/// Returns the number of units in the set.
+			int getCount() const { return this->count; }
+
+			/// Returns true if @p unit is in the set.
+			bool contains(const CUnit *unit) const;
+
+			/// Returns true if the unit with the given CUnit::getIndex() is in the set.
+			bool containsIndex(u16 index) const;
+
+			/// Calls func(unit) once for each unit in the set.
+			template <class Callback>
+			void forEach(const Callback &func) const;
+
+		private:
+			friend class UnitRegistry;
+			u32 words[WORD_COUNT];
+			int count;
+		};
+
+		UnitRegistry();
+
+		/// Removes all units from the registry (e.g. when a new game starts).
+		void clear();
+
+		/// Walks the visible unit list once, and re-files every unit whose type
+		/// or owner has changed since the last update. Units that have left the
+		/// list are removed. Called once per frame from hooks::nextFrame().
+		void sync();
+
+		/// Files @p unit under its current type and owner. If the unit has no
+		/// sprite, it is removed instead.
+		void update(const CUnit *unit);
+
+		/// Removes @p unit from the registry.
+		void remove(const CUnit *unit);
+
+		/// Returns the set of all units of the given type.
+		const UnitSet& ofType(u16 unitId) const;
+
+		/// Returns the set of all units owned by @p playerId.
+		const UnitSet& ofPlayer(u8 playerId) const;
+
+		/// Returns the set of all units in the registry.
+		const UnitSet& all() const { return this->allUnits; }
+
+		/// Calls func(unit) once for each unit of the given type owned by @p playerId.
+		template <class Callback>
+		void forEachOfTypeOwnedBy(u16 unitId, u8 playerId, const Callback &func) const;
+
+		/// Checks what must hold between two calls to sync(): every unit in the
+		/// registry is alive (the hooks remove units as they die) and filed in
+		/// exactly the sets of its recorded type and owner. Units born, morphed
+		/// or given away by StarCraft's own code are not checked, since only
+		/// sync() picks them up. Returns true if the registry is consistent.
+		/// Used by debug builds in hooks::nextFrame(), before sync().
+		bool verify() const;
+
+	private:
+		void addToSets(u16 index, u16 unitId, u8 playerId);
+		void removeFromSets(u16 index);
+
+		//Calls func(unit) for every bit set in (a[i] & b[i])
+		template <class Callback>
+		static void forEachInWords(const u32 *a, const u32 *b, const Callback &func);
+
+		UnitSet typeSets[UNIT_TYPE_COUNT];
+		UnitSet playerSets[PLAYER_COUNT];
+		UnitSet allUnits;
+
+		//The type and owner each unit is currently filed under
+		u16 filedUnitId[UNIT_ARRAY_LENGTH + 1];
+		u8 filedPlayerId[UNIT_ARRAY_LENGTH + 1];
+	};
+
+	/// The shared unit registry.
+	extern UnitRegistry unitRegistry;
+
+
+	//-------- Template member function definitions --------//
+
+	template <class Callback>
+	void UnitRegistry::forEachInWords(const u32 *a, const u32 *b, const Callback &func) {
+		for (int w = 0; w < WORD_COUNT; ++w) {
+			u32 bits = b ? (a[w] & b[w]) : a[w];
+			while (bits) {
+				int bit = 0;
+				while (!(bits & (1u << bit)))
+					++bit;
+				bits &= ~(1u << bit);
+				func(CUnit::getFromIndex((u16)(w * 32 + bit)));
+			}
+		}
+	}
+
+	template <class Callback>
+	void UnitRegistry::UnitSet::forEach(const Callback &func) const {
+		if (this->count > 0)
+			UnitRegistry::forEachInWords(this->words, nullptr, func);
+	}
+
+	template <class Callback>
+	void UnitRegistry::forEachOfTypeOwnedBy(u16 unitId, u8 playerId, const Callback &func) const {
+		const UnitSet &typeSet = this->ofType(unitId);
+		const UnitSet &playerSet = this->ofPlayer(playerId);
+
+		if (typeSet.count > 0 && playerSet.count > 0)
+			forEachInWords(typeSet.words, playerSet.words, func);
+	}
+
+} //scbw
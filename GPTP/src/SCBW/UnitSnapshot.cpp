@@ -0,0 +1,349 @@
+#include "UnitSnapshot.h"
+#include "api.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace scbw {
+
+	UnitSnapshot unitSnapshot;
+
+	UnitSnapshot::UnitSnapshot() : builtFrame(0), isBuilt(false) {}
+
+	bool UnitSnapshot::isUpToDate() const {
+		return this->isBuilt && this->builtFrame == *elapsedTimeFrames;
+	}
+
+	void UnitSnapshot::build() {
+		//Empty slots are never selected, since their ownerBit is 0
+		std::memset(this->ownerBit, 0, sizeof(this->ownerBit));
+
+		for (CUnit *unit = *firstVisibleUnit; unit; unit = unit->link.next) {
+			if (!unit->sprite)
+				continue;
+
+			const u16 i = unit->getIndex();
+			const Box16 &bounds = units_dat::UnitBounds[unit->id];
+
+			this->x[i] = unit->getX();
+			this->y[i] = unit->getY();
+			this->left[i] = this->x[i] - bounds.left;
+			this->top[i] = this->y[i] - bounds.top;
+			this->right[i] = this->x[i] + bounds.right;
+			this->bottom[i] = this->y[i] + bounds.bottom;
+
+			//Same owner rules as scbw::isUnitEnemy()
+			u8 owner = unit->playerId;
+			if (owner == 11)
+				owner = unit->sprite->playerId;
+			this->ownerBit[i] = 1 << owner;
+
+			this->unitId[i] = unit->id;
+			this->status[i] = unit->status;
+			this->hitPoints[i] = unit->hitPoints;
+			this->shields[i] = unit->shields;
+			this->playerId[i] = unit->playerId;
+		}
+
+		this->builtFrame = *elapsedTimeFrames;
+		this->isBuilt = true;
+	}
+
+	void UnitSnapshot::update() {
+		if (!this->isUpToDate())
+			this->build();
+	}
+
+	void UnitSnapshot::clear() {
+		this->isBuilt = false;
+	}
+
+	//-------- Filter kernels --------//
+
+	namespace {
+
+		//Packs eight 16-bit comparison results into one selection byte
+		inline u8 toMaskByte(__m128i cmp16) {
+			return (u8)_mm_movemask_epi8(_mm_packs_epi16(cmp16, _mm_setzero_si128()));
+		}
+
+		//Packs two sets of four 32-bit comparison results into one selection byte
+		inline u8 toMaskByte(__m128i cmpLow32, __m128i cmpHigh32) {
+			return toMaskByte(_mm_packs_epi32(cmpLow32, cmpHigh32));
+		}
+
+		inline __m128i load128(const void *p) {
+			return _mm_loadu_si128((const __m128i*) p);
+		}
+
+		//Loads four 16-bit values into the low half
+		inline __m128i load64(const void *p) {
+			return _mm_loadl_epi64((const __m128i*) p);
+		}
+
+	} //unnamed namespace
+
+	void UnitSnapshot::selectAll(Selection &sel) const {
+		const __m128i zero = _mm_setzero_si128();
+
+		for (int i = 0; i < SLOT_COUNT; i += 8) {
+			const __m128i isEmpty = _mm_cmpeq_epi16(load128(&this->ownerBit[i]), zero);
+			sel.bytes[i / 8] = ~toMaskByte(isEmpty);
+		}
+	}
+
+	void UnitSnapshot::keepOwners(Selection &sel, u16 playerMask) const {
+		const __m128i mask = _mm_set1_epi16((short)playerMask);
+		const __m128i zero = _mm_setzero_si128();
+
+		for (int i = 0; i < SLOT_COUNT; i += 8) {
+			if (!sel.bytes[i / 8])
+				continue;
+
+			const __m128i owners = _mm_and_si128(load128(&this->ownerBit[i]), mask);
+			sel.bytes[i / 8] &= ~toMaskByte(_mm_cmpeq_epi16(owners, zero));
+		}
+	}
+
+	void UnitSnapshot::keepEnemiesOf(Selection &sel, u8 playerId) const {
+		u16 enemyMask = 0;
+		for (int owner = 0; owner < PLAYER_COUNT; ++owner) {
+			if (playerAlliance[playerId].flags[owner] == 0)
+				enemyMask |= 1 << owner;
+		}
+
+		this->keepOwners(sel, enemyMask);
+	}
+
+	void UnitSnapshot::keepAlliesOf(Selection &sel, u8 playerId) const {
+		u16 allyMask = 0;
+		for (int owner = 0; owner < PLAYER_COUNT; ++owner) {
+			if (playerAlliance[playerId].flags[owner] != 0)
+				allyMask |= 1 << owner;
+		}
+
+		this->keepOwners(sel, allyMask);
+	}
+
+	void UnitSnapshot::keepInBox(Selection &sel, int left, int top, int right, int bottom) const {
+		const __m128i boxLeft = _mm_set1_epi16((short)CLAMP(left, -32768, 32767));
+		const __m128i boxTop = _mm_set1_epi16((short)CLAMP(top, -32768, 32767));
+		const __m128i boxRight = _mm_set1_epi16((short)CLAMP(right, -32768, 32767));
+		const __m128i boxBottom = _mm_set1_epi16((short)CLAMP(bottom, -32768, 32767));
+
+		for (int i = 0; i < SLOT_COUNT; i += 8) {
+			if (!sel.bytes[i / 8])
+				continue;
+
+			//Inside: unitLeft < right && unitTop < bottom
+			const __m128i inside = _mm_and_si128(
+				_mm_cmplt_epi16(load128(&this->left[i]), boxRight),
+				_mm_cmplt_epi16(load128(&this->top[i]), boxBottom));
+
+			//Outside: unitRight < left || unitBottom < top
+			const __m128i outside = _mm_or_si128(
+				_mm_cmplt_epi16(load128(&this->right[i]), boxLeft),
+				_mm_cmplt_epi16(load128(&this->bottom[i]), boxTop));
+
+			sel.bytes[i / 8] &= toMaskByte(_mm_andnot_si128(outside, inside));
+		}
+	}
+
+	void UnitSnapshot::keepStatusClear(Selection &sel, u32 statusFlags) const {
+		const __m128i flags = _mm_set1_epi32((int)statusFlags);
+		const __m128i zero = _mm_setzero_si128();
+
+		for (int i = 0; i < SLOT_COUNT; i += 8) {
+			if (!sel.bytes[i / 8])
+				continue;
+
+			const __m128i low = _mm_cmpeq_epi32(_mm_and_si128(load128(&this->status[i]), flags), zero);
+			const __m128i high = _mm_cmpeq_epi32(_mm_and_si128(load128(&this->status[i + 4]), flags), zero);
+			sel.bytes[i / 8] &= toMaskByte(low, high);
+		}
+	}
+
+	void UnitSnapshot::keepStatusSet(Selection &sel, u32 statusFlags) const {
+		const __m128i flags = _mm_set1_epi32((int)statusFlags);
+
+		for (int i = 0; i < SLOT_COUNT; i += 8) {
+			if (!sel.bytes[i / 8])
+				continue;
+
+			const __m128i low = _mm_cmpeq_epi32(_mm_and_si128(load128(&this->status[i]), flags), flags);
+			const __m128i high = _mm_cmpeq_epi32(_mm_and_si128(load128(&this->status[i + 4]), flags), flags);
+			sel.bytes[i / 8] &= toMaskByte(low, high);
+		}
+	}
+
+	int UnitSnapshot::toIndexList(const Selection &sel, u16 *indices) {
+		int count = 0;
+
+		for (int byteIndex = 0; byteIndex < SLOT_COUNT / 8; ++byteIndex) {
+			u8 bits = sel.bytes[byteIndex];
+			for (int bit = 0; bits; ++bit, bits >>= 1) {
+				if (bits & 1)
+					indices[count++] = byteIndex * 8 + bit;
+			}
+		}
+
+		return count;
+	}
+
+	//-------- Distance kernels --------//
+
+	namespace {
+
+		//Sign-extends the low / high four values of eight 16-bit values
+		inline __m128i lowToS32(__m128i v16) {
+			return _mm_srai_epi32(_mm_unpacklo_epi16(v16, v16), 16);
+		}
+
+		inline __m128i highToS32(__m128i v16) {
+			return _mm_srai_epi32(_mm_unpackhi_epi16(v16, v16), 16);
+		}
+
+		inline __m128i select32(__m128i mask, __m128i a, __m128i b) {
+			return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+		}
+
+		inline __m128i abs32(__m128i v) {
+			const __m128i sign = _mm_srai_epi32(v, 31);
+			return _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+		}
+
+		//Same as scbw::getDistanceFast(0, 0, dx, dy), for dx, dy >= 0
+		inline __m128i getDistanceFast4(__m128i dx, __m128i dy) {
+			const __m128i isSwapped = _mm_cmplt_epi32(dx, dy);
+			const __m128i dMax = select32(isSwapped, dy, dx);
+			const __m128i dMin = select32(isSwapped, dx, dy);
+
+			const __m128i dMin3 = _mm_add_epi32(_mm_add_epi32(dMin, dMin), dMin);
+			__m128i distance = _mm_add_epi32(_mm_srai_epi32(dMin3, 3), _mm_srai_epi32(dMin3, 8));
+			distance = _mm_add_epi32(distance, dMax);
+			distance = _mm_sub_epi32(distance, _mm_srai_epi32(dMax, 4));
+			distance = _mm_sub_epi32(distance, _mm_srai_epi32(dMax, 6));
+
+			//dMin <= dMax / 4: the distance is dMax
+			const __m128i isDiagonal = _mm_cmpgt_epi32(dMin, _mm_srai_epi32(dMax, 2));
+			return select32(isDiagonal, distance, dMax);
+		}
+
+		//Same as the edge distance along one axis in CUnit::getDistanceToTarget()
+		inline __m128i getGap4(__m128i gapBefore, __m128i gapAfter) {
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i isBefore = _mm_cmpgt_epi32(gapBefore, _mm_set1_epi32(-1));
+			const __m128i after = _mm_and_si128(gapAfter, _mm_cmpgt_epi32(gapAfter, zero));
+			return select32(isBefore, gapBefore, after);
+		}
+
+		inline u32 getBoxDistance(s32 left, s32 top, s32 right, s32 bottom,
+			s32 targetLeft, s32 targetTop, s32 targetRight, s32 targetBottom)
+		{
+			s32 dx = left - targetRight - 1;
+			if (dx < 0) {
+				dx = targetLeft - right - 1;
+				if (dx < 0)
+					dx = 0;
+			}
+
+			s32 dy = top - targetBottom - 1;
+			if (dy < 0) {
+				dy = targetTop - bottom - 1;
+				if (dy < 0)
+					dy = 0;
+			}
+
+			return getDistanceFast(0, 0, dx, dy);
+		}
+
+	} //unnamed namespace
+
+	void UnitSnapshot::getDistancesFast(s32 x, s32 y,
+		const s16 *targetX, const s16 *targetY, int count, u32 *distances)
+	{
+		const __m128i sourceX = _mm_set1_epi32(x);
+		const __m128i sourceY = _mm_set1_epi32(y);
+
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128i tx = load128(&targetX[i]), ty = load128(&targetY[i]);
+
+			const __m128i low = getDistanceFast4(
+				abs32(_mm_sub_epi32(sourceX, lowToS32(tx))),
+				abs32(_mm_sub_epi32(sourceY, lowToS32(ty))));
+			const __m128i high = getDistanceFast4(
+				abs32(_mm_sub_epi32(sourceX, highToS32(tx))),
+				abs32(_mm_sub_epi32(sourceY, highToS32(ty))));
+
+			_mm_storeu_si128((__m128i*) &distances[i], low);
+			_mm_storeu_si128((__m128i*) &distances[i + 4], high);
+		}
+
+		if (i + 4 <= count) {
+			const __m128i tx = load64(&targetX[i]), ty = load64(&targetY[i]);
+			_mm_storeu_si128((__m128i*) &distances[i], getDistanceFast4(
+				abs32(_mm_sub_epi32(sourceX, lowToS32(tx))),
+				abs32(_mm_sub_epi32(sourceY, lowToS32(ty)))));
+			i += 4;
+		}
+
+		for (; i < count; ++i)
+			distances[i] = getDistanceFast(x, y, targetX[i], targetY[i]);
+	}
+
+	void UnitSnapshot::getBoxDistances(s32 left, s32 top, s32 right, s32 bottom,
+		const s16 *targetLeft, const s16 *targetTop,
+		const s16 *targetRight, const s16 *targetBottom,
+		int count, u32 *distances)
+	{
+		//Gaps before the target are (left - targetRight - 1), gaps after the
+		//target are (targetLeft - right - 1)
+		const __m128i beforeX = _mm_set1_epi32(left - 1), afterX = _mm_set1_epi32(right + 1);
+		const __m128i beforeY = _mm_set1_epi32(top - 1), afterY = _mm_set1_epi32(bottom + 1);
+
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128i tLeft = load128(&targetLeft[i]), tRight = load128(&targetRight[i]);
+			const __m128i tTop = load128(&targetTop[i]), tBottom = load128(&targetBottom[i]);
+
+			const __m128i low = getDistanceFast4(
+				getGap4(_mm_sub_epi32(beforeX, lowToS32(tRight)), _mm_sub_epi32(lowToS32(tLeft), afterX)),
+				getGap4(_mm_sub_epi32(beforeY, lowToS32(tBottom)), _mm_sub_epi32(lowToS32(tTop), afterY)));
+			const __m128i high = getDistanceFast4(
+				getGap4(_mm_sub_epi32(beforeX, highToS32(tRight)), _mm_sub_epi32(highToS32(tLeft), afterX)),
+				getGap4(_mm_sub_epi32(beforeY, highToS32(tBottom)), _mm_sub_epi32(highToS32(tTop), afterY)));
+
+			_mm_storeu_si128((__m128i*) &distances[i], low);
+			_mm_storeu_si128((__m128i*) &distances[i + 4], high);
+		}
+
+		if (i + 4 <= count) {
+			const __m128i tLeft = load64(&targetLeft[i]), tRight = load64(&targetRight[i]);
+			const __m128i tTop = load64(&targetTop[i]), tBottom = load64(&targetBottom[i]);
+			_mm_storeu_si128((__m128i*) &distances[i], getDistanceFast4(
+				getGap4(_mm_sub_epi32(beforeX, lowToS32(tRight)), _mm_sub_epi32(lowToS32(tLeft), afterX)),
+				getGap4(_mm_sub_epi32(beforeY, lowToS32(tBottom)), _mm_sub_epi32(lowToS32(tTop), afterY))));
+			i += 4;
+		}
+
+		for (; i < count; ++i) {
+			distances[i] = getBoxDistance(left, top, right, bottom,
+				targetLeft[i], targetTop[i], targetRight[i], targetBottom[i]);
+		}
+	}
+
+	void UnitSnapshot::getDistancesFrom(s32 x, s32 y, u32 *distances) const {
+		getDistancesFast(x, y, this->x, this->y, SLOT_COUNT, distances);
+	}
+
+	void UnitSnapshot::getDistancesToTargets(const CUnit *unit, u32 *distances) const {
+		//Turrets measure distances from their base unit
+		if (unit->isSubunit())
+			unit = unit->subunit;
+
+		getBoxDistances(unit->getLeft(), unit->getTop(), unit->getRight(), unit->getBottom(),
+			this->left, this->top, this->right, this->bottom, SLOT_COUNT, distances);
+	}
+
+} //scbw
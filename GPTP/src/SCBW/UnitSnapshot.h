@@ -0,0 +1,144 @@
+#pragma once
+#include "scbwdata.h"
+
+namespace scbw {
+
+	/// The UnitSnapshot class copies the CUnit fields most used by target
+	/// filters (position, collision box, owner, status, HP, shields and unit ID)
+	/// into packed structure-of-arrays form, indexed by CUnit::getIndex().
+	/// It is built on demand: call update() before reading it, and it is built
+	/// at most once per frame, so frames that never read it cost nothing.
+	///
+	/// The filter functions use SSE2 to test 8 units at a time, and narrow down
+	/// a Selection (one bit per unit). Use toIndexList() to get the remaining
+	/// unit indices, then refine them with the usual CUnit-based checks:
+	///
+	///   scbw::UnitSnapshot::Selection sel;
+	///   unitSnapshot.update();
+	///   unitSnapshot.selectAll(sel);
+	///   unitSnapshot.keepEnemiesOf(sel, unit->playerId);
+	///   unitSnapshot.keepStatusClear(sel, UnitStatus::Invincible);
+	///   const int count = unitSnapshot.toIndexList(sel, indices);
+	///
+	/// The distance kernels measure distances from one point or box to many
+	/// units at once, e.g. with getDistancesToTargets() before picking the
+	/// nearest of the selected units.
+	///
+	/// Note: Like SpatialGrid, the snapshot does not see changes made to units
+	/// after it was built in the current frame.
+
+	class UnitSnapshot {
+	public:
+		/// Number of slots in each array. Slot 0 is never used, so that unit
+		/// indices can be used directly. Rounded up to a multiple of 8.
+		static const int SLOT_COUNT = (UNIT_ARRAY_LENGTH + 1 + 7) & ~7;
+
+		/// One bit per slot. Bit (i % 8) of bytes[i / 8] is set if slot i is selected.
+		struct Selection {
+			u8 bytes[SLOT_COUNT / 8];
+		};
+
+		UnitSnapshot();
+
+		/// Copies the fields of all units in the visible unit list.
+		void build();
+
+		/// Calls build() unless the snapshot was already built during the
+		/// current frame.
+		void update();
+
+		/// Discards the snapshot (e.g. when a new game starts).
+		void clear();
+
+		/// Returns true if the snapshot was built during the current frame.
+		bool isUpToDate() const;
+
+		/// @name Filter kernels
+		//////////////////////////////////////////////////////////////// @{
+
+		/// Selects every slot that holds a unit.
+		void selectAll(Selection &sel) const;
+
+		/// Keeps units that @p playerId sees as enemies (see scbw::isUnitEnemy()).
+		void keepEnemiesOf(Selection &sel, u8 playerId) const;
+
+		/// Keeps units that @p playerId sees as allies (including its own units).
+		void keepAlliesOf(Selection &sel, u8 playerId) const;
+
+		/// Keeps units whose collision box overlaps the given bounds (the same test
+		/// used by SpatialGrid::forEach()).
+		void keepInBox(Selection &sel, int left, int top, int right, int bottom) const;
+
+		/// Keeps units whose status has none of the bits in @p statusFlags set.
+		/// e.g. UnitStatus::Invincible for "not invincible" or UnitStatus::InAir
+		/// for "ground units only".
+		void keepStatusClear(Selection &sel, u32 statusFlags) const;
+
+		/// Keeps units whose status has all of the bits in @p statusFlags set.
+		void keepStatusSet(Selection &sel, u32 statusFlags) const;
+
+		/// Writes the indices of all selected units to @p indices, in ascending
+		/// order. @p indices must be able to hold UNIT_ARRAY_LENGTH entries.
+		/// @return   The number of indices written.
+		static int toIndexList(const Selection &sel, u16 *indices);
+
+		//////////////////////////////////////////////////////////////// @}
+
+		/// @name Distance kernels
+		/// These give exactly the same results as scbw::getDistanceFast() and
+		/// CUnit::getDistanceToTarget(), for 8 targets at a time (then 4, then
+		/// one at a time for the rest). UnitFinder::getNearestTarget() measures
+		/// the units found in each step of its search with getDistancesFast().
+		//////////////////////////////////////////////////////////////// @{
+
+		/// Sets distances[i] to scbw::getDistanceFast(x, y, targetX[i], targetY[i])
+		/// for each i in [0, count).
+		static void getDistancesFast(s32 x, s32 y,
+			const s16 *targetX, const s16 *targetY, int count, u32 *distances);
+
+		/// Sets distances[i] to the distance between the edges of the box
+		/// (left, top, right, bottom) and the i-th target box, measured the same
+		/// way as CUnit::getDistanceToTarget(), for each i in [0, count).
+		static void getBoxDistances(s32 left, s32 top, s32 right, s32 bottom,
+			const s16 *targetLeft, const s16 *targetTop,
+			const s16 *targetRight, const s16 *targetBottom,
+			int count, u32 *distances);
+
+		/// Sets distances[i] to scbw::getDistanceFast(x, y, this->x[i], this->y[i])
+		/// for every slot. @p distances must hold SLOT_COUNT entries; values for
+		/// empty slots are meaningless.
+		void getDistancesFrom(s32 x, s32 y, u32 *distances) const;
+
+		/// Sets distances[i] to unit->getDistanceToTarget() for the unit in
+		/// slot i, for every slot. @p distances must hold SLOT_COUNT entries;
+		/// values for empty slots are meaningless.
+		void getDistancesToTargets(const CUnit *unit, u32 *distances) const;
+
+		//////////////////////////////////////////////////////////////// @}
+
+		/// @name Packed unit data (indexed by CUnit::getIndex())
+		//////////////////////////////////////////////////////////////// @{
+
+		s16 x[SLOT_COUNT], y[SLOT_COUNT];
+		s16 left[SLOT_COUNT], top[SLOT_COUNT], right[SLOT_COUNT], bottom[SLOT_COUNT];
+		u16 ownerBit[SLOT_COUNT];	//1 << owner (see isUnitEnemy()); 0 for empty slots
+		u16 unitId[SLOT_COUNT];
+		u32 status[SLOT_COUNT];
+		s32 hitPoints[SLOT_COUNT];
+		s32 shields[SLOT_COUNT];
+		u8 playerId[SLOT_COUNT];
+
+		//////////////////////////////////////////////////////////////// @}
+
+	private:
+		//Keeps units where (ownerBit & playerMask) != 0
+		void keepOwners(Selection &sel, u16 playerMask) const;
+
+		u32 builtFrame;
+		bool isBuilt;
+	};
+
+	/// The shared unit snapshot. Call unitSnapshot.update() before using it.
+	extern UnitSnapshot unitSnapshot;
+
+} //scbw
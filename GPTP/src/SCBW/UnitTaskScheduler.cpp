@@ -0,0 +1,104 @@
+#include "UnitTaskScheduler.h"
+#include <algorithm>
+#include <cassert>
+
+namespace scbw {
+
+	UnitTaskScheduler unitTaskScheduler;
+
+	UnitTaskScheduler::UnitTaskScheduler() : taskCount(0) {}
+
+	int UnitTaskScheduler::addTask(TaskFunc func, int interval, int budget,
+		const UnitRegistry::UnitSet *units)
+	{
+		assert(func && interval > 0 && budget > 0);
+		if (this->taskCount >= MAX_TASKS)
+			return -1;
+
+		Task &task = this->tasks[this->taskCount];
+		task.func = func;
+		task.units = units;
+		task.interval = (u16)std::min(interval, UNIT_ARRAY_LENGTH);
+		task.budget = (u16)std::min(budget, UNIT_ARRAY_LENGTH);
+		task.isStarted = false;
+		task.nextIndex = 0;
+		task.dueFrame = 0;
+		task.lag = task.maxLag = 0;
+
+		return this->taskCount++;
+	}
+
+	void UnitTaskScheduler::clearTasks() {
+		this->taskCount = 0;
+	}
+
+	void UnitTaskScheduler::reset() {
+		for (int i = 0; i < this->taskCount; ++i) {
+			Task &task = this->tasks[i];
+			task.isStarted = false;
+			task.nextIndex = 0;
+			task.lag = task.maxLag = 0;
+		}
+	}
+
+	void UnitTaskScheduler::run(u32 frame) {
+		for (int i = 0; i < this->taskCount; ++i)
+			this->runTask(this->tasks[i], frame);
+	}
+
+	void UnitTaskScheduler::runTask(Task &task, u32 frame) {
+		if (!task.isStarted) {
+			task.isStarted = true;
+			task.dueFrame = frame;
+			task.nextIndex = 0;
+		}
+
+		const UnitRegistry::UnitSet &units = task.units ? *task.units : unitRegistry.all();
+		if (units.getCount() == 0) {
+			//Nothing to do; continue with the slice of the next frame
+			task.dueFrame = frame + 1;
+			task.nextIndex = 0;
+			task.lag = 0;
+			return;
+		}
+
+		int budget = task.budget;
+
+		while (task.dueFrame <= frame) {
+			//Index 0 is never used, so slice 0 starts at the interval itself
+			if (task.nextIndex == 0) {
+				const u16 slice = (u16)(task.dueFrame % task.interval);
+				task.nextIndex = slice ? slice : task.interval;
+			}
+
+			for (; task.nextIndex <= UNIT_ARRAY_LENGTH; task.nextIndex += task.interval) {
+				if (!units.containsIndex(task.nextIndex))
+					continue;
+
+				if (budget == 0) {
+					//Out of budget; finish this slice in the next frame
+					task.lag = frame - task.dueFrame;
+					task.maxLag = std::max(task.maxLag, task.lag);
+					return;
+				}
+
+				--budget;
+				task.func(CUnit::getFromIndex(task.nextIndex));
+			}
+
+			++task.dueFrame;
+			task.nextIndex = 0;
+		}
+
+		task.lag = 0;
+	}
+
+	u32 UnitTaskScheduler::getLag(int taskId) const {
+		return 0 <= taskId && taskId < this->taskCount ? this->tasks[taskId].lag : 0;
+	}
+
+	u32 UnitTaskScheduler::getMaxLag(int taskId) const {
+		return 0 <= taskId && taskId < this->taskCount ? this->tasks[taskId].maxLag : 0;
+	}
+
+} //scbw
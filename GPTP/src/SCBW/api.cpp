@@ -1,5 +1,7 @@
 #include "api.h"
+#include <SCBW/UnitEventBus.h>
 #include <SCBW/UnitFinder.h>
+#include <SCBW/UnitRegistry.h>
 #include <algorithm>
 #include <cassert>
 
@@ -366,6 +368,11 @@ namespace scbw {
 				POPAD
 		}
 
+		if (unit) {
+			unitRegistry.update(unit);
+			unitEventBus.update(unit);
+		}
+
 		return unit;
 	}
 
@@ -2,6 +2,8 @@
 #include "CUnit.h"
 #include "../api.h"
 #include "../enumerations.h"
+#include "../UnitEventBus.h"
+#include "../UnitRegistry.h"
 
 //-------- Unit stats and properties --------//
 
@@ -731,7 +733,10 @@ bool CUnit::giveTo(u8 playerId) {
 	assert(this);
 	assert(playerId < 12);
 
-	return giveUnitToPlayer(this, playerId) != 0;
+	const bool result = giveUnitToPlayer(this, playerId) != 0;
+	scbw::unitRegistry.update(this);
+	scbw::unitEventBus.update(this);
+	return result;
 }
 
 //Identical to function @ 0x00475A50
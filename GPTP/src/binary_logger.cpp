@@ -0,0 +1,233 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "binary_logger.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+//Log file layout (see also tools/binary_log_decoder.cpp):
+//  "GPTPBLOG" and a version byte, followed by chunks of the form
+//  [u8 type] [varint payload size] [payload]
+//
+//  CHUNK_FORMAT:   varint ID, varint length, format string (no terminator)
+//  CHUNK_RECORDS:  varint record count, then for each record:
+//                  signed varint tick delta, signed varint frame delta,
+//                  varint category, varint format ID, u8 argument count,
+//                  signed varint for each argument
+//                  (deltas are relative to the previous record in the chunk)
+//  CHUNK_DROPPED:  varint total number of dropped records so far
+//  CHUNK_CLOCK:    varint timestamp counter ticks per second
+
+namespace GPTP {
+
+	BinaryLogger binaryLogger;
+
+	namespace {
+
+		const char LOG_FILE_MAGIC[8] = { 'G', 'P', 'T', 'P', 'B', 'L', 'O', 'G' };
+		const u8 LOG_FILE_VERSION = 1;
+
+		enum ChunkType {
+			CHUNK_FORMAT = 1,
+			CHUNK_RECORDS = 2,
+			CHUNK_DROPPED = 3,
+			CHUNK_CLOCK = 4,
+		};
+
+		void putVarint(std::vector<u8> &out, u64 value) {
+			while (value >= 0x80) {
+				out.push_back((u8)(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back((u8)value);
+		}
+
+		//Zigzag encoding, so that small negative numbers stay short
+		void putSignedVarint(std::vector<u8> &out, s64 value) {
+			putVarint(out, ((u64)value << 1) ^ (u64)(value >> 63));
+		}
+
+		void writeChunk(FILE *file, ChunkType type, const std::vector<u8> &payload) {
+			std::vector<u8> header;
+			header.push_back((u8)type);
+			putVarint(header, payload.size());
+
+			fwrite(&header[0], 1, header.size(), file);
+			if (!payload.empty())
+				fwrite(&payload[0], 1, payload.size(), file);
+		}
+
+		//Used to measure the timestamp counter frequency over a whole game
+		u64 startTick;
+		LARGE_INTEGER startTime;
+
+	} //unnamed namespace
+
+	BinaryLogger::BinaryLogger()
+		: writeIndex(0), readIndex(0), droppedCount(0), isInGame(false), isRunning(false),
+		formatCount(0), writtenFormatCount(0), writtenDroppedCount(0),
+		logFile(NULL), flushThread(NULL), stopEvent(NULL) {}
+
+	void BinaryLogger::startGame() {
+		if (this->isInGame)
+			this->endGame();
+
+		this->isInGame = true;
+	}
+
+	bool BinaryLogger::openLog() {
+		//Do not try again for every record if the file cannot be opened
+		this->isInGame = false;
+
+		time_t currentTime;
+		time(&currentTime);
+
+		char buffer[100];
+		strftime(buffer, sizeof(buffer), "Game %Y-%m-%d %Hh %Mm %Ss.blog",
+			localtime(&currentTime));
+
+		FILE *file = fopen(buffer, "wb");
+		if (!file)
+			return false;
+
+		fwrite(LOG_FILE_MAGIC, 1, sizeof(LOG_FILE_MAGIC), file);
+		fwrite(&LOG_FILE_VERSION, 1, 1, file);
+
+		//Each log file must contain all format strings it uses
+		this->logFile = file;
+		this->readIndex = this->writeIndex;
+		this->droppedCount = 0;
+		this->writtenDroppedCount = 0;
+		this->writtenFormatCount = 0;
+
+		this->stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		this->flushThread = CreateThread(NULL, 0, flushThreadProc, this, 0, NULL);
+		if (!this->flushThread) {
+			CloseHandle(this->stopEvent);
+			fclose(file);
+			this->logFile = NULL;
+			return false;
+		}
+
+		startTick = __rdtsc();
+		QueryPerformanceCounter(&startTime);
+		this->isInGame = true;
+		this->isRunning = true;
+		return true;
+	}
+
+	void BinaryLogger::endGame() {
+		this->isInGame = false;
+		if (!this->isRunning)
+			return;
+
+		this->isRunning = false;
+		SetEvent(this->stopEvent);
+		WaitForSingleObject(this->flushThread, INFINITE);
+		CloseHandle(this->flushThread);
+		CloseHandle(this->stopEvent);
+		this->flushThread = this->stopEvent = NULL;
+
+		this->flush();
+
+		//Store the timestamp counter frequency, so that the decoder can show times
+		LARGE_INTEGER endTime, frequency;
+		QueryPerformanceCounter(&endTime);
+		QueryPerformanceFrequency(&frequency);
+		const u64 elapsedTicks = __rdtsc() - startTick;
+		const double elapsedSeconds = (double)(endTime.QuadPart - startTime.QuadPart) / frequency.QuadPart;
+
+		if (elapsedSeconds > 0) {
+			std::vector<u8> payload;
+			putVarint(payload, (u64)(elapsedTicks / elapsedSeconds));
+			writeChunk((FILE*)this->logFile, CHUNK_CLOCK, payload);
+		}
+
+		fclose((FILE*)this->logFile);
+		this->logFile = NULL;
+	}
+
+	u16 BinaryLogger::registerFormat(const char *format) {
+		const u32 id = this->formatCount;
+		if (id >= (u32)MAX_FORMATS)
+			return MAX_FORMATS;
+
+		this->formats[id] = format;
+		_ReadWriteBarrier();
+		this->formatCount = id + 1;
+		return (u16)id;
+	}
+
+	unsigned long __stdcall BinaryLogger::flushThreadProc(void *param) {
+		BinaryLogger *logger = (BinaryLogger*)param;
+
+		while (WaitForSingleObject(logger->stopEvent, FLUSH_INTERVAL) == WAIT_TIMEOUT)
+			logger->flush();
+
+		return 0;
+	}
+
+	void BinaryLogger::flush() {
+		FILE *file = (FILE*)this->logFile;
+		static std::vector<u8> payload;
+
+		//Read the write index before the format count, so that every format
+		//used by the records below has been registered.
+		const u32 endIndex = this->writeIndex;
+		_ReadWriteBarrier();
+		const u32 endFormat = this->formatCount;
+
+		for (; this->writtenFormatCount < endFormat; ++this->writtenFormatCount) {
+			const char *format = this->formats[this->writtenFormatCount];
+			const size_t length = strlen(format);
+
+			payload.clear();
+			putVarint(payload, this->writtenFormatCount);
+			putVarint(payload, length);
+			payload.insert(payload.end(), format, format + length);
+			writeChunk(file, CHUNK_FORMAT, payload);
+		}
+
+		const u32 dropped = this->droppedCount;
+		if (dropped != this->writtenDroppedCount) {
+			payload.clear();
+			putVarint(payload, dropped);
+			writeChunk(file, CHUNK_DROPPED, payload);
+			this->writtenDroppedCount = dropped;
+		}
+
+		const u32 beginIndex = this->readIndex;
+		if (beginIndex == endIndex)
+			return;
+
+		payload.clear();
+		putVarint(payload, endIndex - beginIndex);
+
+		u64 lastTick = 0;
+		u32 lastFrame = 0;
+		for (u32 i = beginIndex; i != endIndex; ++i) {
+			const LogRecord &record = this->ring[i & (RING_SIZE - 1)];
+			putSignedVarint(payload, (s64)(record.tick - lastTick));
+			putSignedVarint(payload, (s64)record.frame - (s64)lastFrame);
+			putVarint(payload, record.category);
+			putVarint(payload, record.formatId);
+			payload.push_back(record.argCount);
+			for (int a = 0; a < record.argCount; ++a)
+				putSignedVarint(payload, record.args[a]);
+
+			lastTick = record.tick;
+			lastFrame = record.frame;
+		}
+
+		//Hand the slots back to the game thread after they have been read
+		_ReadWriteBarrier();
+		this->readIndex = endIndex;
+
+		writeChunk(file, CHUNK_RECORDS, payload);
+		fflush(file);
+	}
+
+} //GPTP
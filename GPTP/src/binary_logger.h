@@ -0,0 +1,213 @@
+/// Low-overhead binary logging, usable in Release builds.
+///
+/// Unlike GPTP::logger, this does not format any text on the game thread.
+/// Each log call copies a fixed-size record (frame, CPU timestamp, category,
+/// format ID and up to 4 integer arguments) into a lock-free ring buffer. A
+/// background thread drains the buffer, compresses the records and writes
+/// them to "Game <date>.blog". Use tools/binary_log_decoder.cpp to turn the
+/// log back into text or CSV.
+///
+/// Usage:
+///
+///   GPTP_BLOG(GPTP::LogCategory::AI, "Unit %d casts spell %d", unit->getIndex(), techId);
+///
+/// The format string must be a string literal, and may only use integer
+/// conversions (%d, %i, %u, %x, %X, %c). It is stored once per call site.
+/// If the ring buffer is full, records are dropped (and counted) instead of
+/// blocking the game thread.
+///
+/// Binary logging is off by default. When GPTP_BINARY_LOGGING_ENABLED is not
+/// defined, GPTP_BLOG() and the GPTP_BLOG_*_GAME() macros compile to nothing.
+/// When it is defined, the log file is only created (and the background
+/// thread only started) once a game writes its first record.
+
+#pragma once
+#include "types.h"
+#include <SCBW/scbwdata.h>
+#include <intrin.h>
+
+//Uncomment this to enable the binary logger.
+//#define GPTP_BINARY_LOGGING_ENABLED
+
+namespace GPTP {
+
+	namespace LogCategory {
+		enum Enum {
+			General = 0,
+			Hooks = 1,
+			AI = 2,
+			Units = 3,
+			Graphics = 4,
+		};
+	}
+
+	struct LogRecord {
+		u64 tick;			//CPU timestamp counter (__rdtsc())
+		u32 frame;			//*elapsedTimeFrames
+		u16 category;
+		u16 formatId;
+		s32 args[4];
+		u8  argCount;
+	};
+
+	class BinaryLogger {
+	public:
+		/// Number of records in the ring buffer. Must be a power of 2.
+		static const int RING_SIZE = 16384;
+		/// Maximum number of distinct format strings (i.e. GPTP_BLOG() call sites).
+		static const int MAX_FORMATS = 1024;
+		/// How often (in milliseconds) the background thread drains the buffer.
+		static const int FLUSH_INTERVAL = 50;
+
+		BinaryLogger();
+
+		/// Starts logging a new game. The log file is opened and the background
+		/// thread started when the first record is written.
+		void startGame();
+
+		/// Writes the remaining records, stops the background thread and closes
+		/// the log file.
+		void endGame();
+
+		/// Assigns an ID to @p format. Called once per GPTP_BLOG() call site.
+		u16 registerFormat(const char *format);
+
+		/// Appends a record to the ring buffer. Only call from the game thread.
+		void write(u16 category, u16 formatId);
+		void write(u16 category, u16 formatId, s32 a0);
+		void write(u16 category, u16 formatId, s32 a0, s32 a1);
+		void write(u16 category, u16 formatId, s32 a0, s32 a1, s32 a2);
+		void write(u16 category, u16 formatId, s32 a0, s32 a1, s32 a2, s32 a3);
+
+		/// Returns the number of records dropped because the buffer was full.
+		u32 getDroppedCount() const { return this->droppedCount; }
+
+	private:
+		LogRecord* beginRecord(u16 category, u16 formatId);
+		void commitRecord();
+
+		/// Opens a new log file and starts the background thread.
+		bool openLog();
+
+		static unsigned long __stdcall flushThreadProc(void *param);
+
+		//Compresses and writes all records and format strings added since the
+		//last call. Only called by the background thread (or after it stopped).
+		void flush();
+
+		LogRecord ring[RING_SIZE];
+		volatile u32 writeIndex;	//Only modified by the game thread
+		volatile u32 readIndex;		//Only modified by the background thread
+		u32 droppedCount;
+		bool isInGame;
+		bool isRunning;
+
+		const char *formats[MAX_FORMATS];
+		volatile u32 formatCount;
+		u32 writtenFormatCount;
+		u32 writtenDroppedCount;
+
+		void *logFile;			//FILE*
+		void *flushThread;		//HANDLE
+		void *stopEvent;		//HANDLE
+	};
+
+	extern BinaryLogger binaryLogger;
+
+} //GPTP
+
+#ifdef GPTP_BINARY_LOGGING_ENABLED
+#define GPTP_BLOG(category, format, ...) \
+	do { \
+		static const u16 _blogFormatId = GPTP::binaryLogger.registerFormat(format); \
+		GPTP::binaryLogger.write((u16)(category), _blogFormatId, __VA_ARGS__); \
+	} while (0)
+#define GPTP_BLOG_START_GAME() GPTP::binaryLogger.startGame()
+#define GPTP_BLOG_END_GAME() GPTP::binaryLogger.endGame()
+#else
+#define GPTP_BLOG(category, format, ...) ((void)0)
+#define GPTP_BLOG_START_GAME() ((void)0)
+#define GPTP_BLOG_END_GAME() ((void)0)
+#endif
+
+
+//-------- Inline member function definitions --------//
+
+namespace GPTP {
+
+	inline LogRecord* BinaryLogger::beginRecord(u16 category, u16 formatId) {
+		if (formatId >= MAX_FORMATS)
+			return NULL;
+
+		if (!this->isRunning) {
+			if (!this->isInGame || !this->openLog())
+				return NULL;
+		}
+
+		const u32 index = this->writeIndex;
+		if (index - this->readIndex >= (u32)RING_SIZE) {
+			++this->droppedCount;
+			return NULL;
+		}
+
+		LogRecord *record = &this->ring[index & (RING_SIZE - 1)];
+		record->tick = __rdtsc();
+		record->frame = *elapsedTimeFrames;
+		record->category = category;
+		record->formatId = formatId;
+		return record;
+	}
+
+	inline void BinaryLogger::commitRecord() {
+		//x86 does not reorder stores, so the background thread sees the record
+		//before the new write index. Only the compiler must be stopped here.
+		_ReadWriteBarrier();
+		this->writeIndex = this->writeIndex + 1;
+	}
+
+	inline void BinaryLogger::write(u16 category, u16 formatId) {
+		if (LogRecord *record = this->beginRecord(category, formatId)) {
+			record->argCount = 0;
+			this->commitRecord();
+		}
+	}
+
+	inline void BinaryLogger::write(u16 category, u16 formatId, s32 a0) {
+		if (LogRecord *record = this->beginRecord(category, formatId)) {
+			record->args[0] = a0;
+			record->argCount = 1;
+			this->commitRecord();
+		}
+	}
+
+	inline void BinaryLogger::write(u16 category, u16 formatId, s32 a0, s32 a1) {
+		if (LogRecord *record = this->beginRecord(category, formatId)) {
+			record->args[0] = a0;
+			record->args[1] = a1;
+			record->argCount = 2;
+			this->commitRecord();
+		}
+	}
+
+	inline void BinaryLogger::write(u16 category, u16 formatId, s32 a0, s32 a1, s32 a2) {
+		if (LogRecord *record = this->beginRecord(category, formatId)) {
+			record->args[0] = a0;
+			record->args[1] = a1;
+			record->args[2] = a2;
+			record->argCount = 3;
+			this->commitRecord();
+		}
+	}
+
+	inline void BinaryLogger::write(u16 category, u16 formatId, s32 a0, s32 a1, s32 a2, s32 a3) {
+		if (LogRecord *record = this->beginRecord(category, formatId)) {
+			record->args[0] = a0;
+			record->args[1] = a1;
+			record->args[2] = a2;
+			record->args[3] = a3;
+			record->argCount = 4;
+			this->commitRecord();
+		}
+	}
+
+} //GPTP
@@ -5,9 +5,12 @@
 
 #include "Bitmap.h"
 #include "Font.h"
+#include "FontCache.h"
 #include "../SCBW/scbwdata.h"
 #include <cassert>
 #include <algorithm>
+#include <vector>
+#include <emmintrin.h>
 
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
@@ -165,106 +168,80 @@ namespace graphics {
 		if (!fnt)
 			return false;
 
+		const TextLayout &layout = getTextLayout(pszStr, size);
+
 		// verify if drawing should be done
-		if (x + fnt->getTextWidth(pszStr) < 0 ||
-			y + fnt->getTextHeight(pszStr) < 0 ||
+		if (x + layout.width < 0 ||
+			y + layout.height < 0 ||
 			x >= this->getWidth() || y >= this->getHeight())
 			return false;
 
-		// Reference an unsigned character array
-		const u8 *pbChars = (u8*)pszStr;
-
-		u8 lastColor = 0, color = 0;
-		int Xoffset = x, Yoffset = y;
-
-		// Iterate all characters in the message
-		for (int c = 0; pbChars[c]; ++c) {
-			// Perform control character and whitespace functions
-			if (pbChars[c] <= ' ') {
-				switch (pbChars[c]) {
-				case 1:       // restore last colour
-					color = lastColor;
-					continue;
-				case '\t':    // 9    tab
-					Xoffset += fnt->getCharWidth(pbChars[c]);
-					continue;
-				case '\n':    // 10   newline
-					Xoffset = x;
-					Yoffset += fnt->maxHeight();
-					continue;
-				case 11:      // invisible
-				case 20:
-					color = (u8)~0;
-					continue;
-				case '\f':    // 12   formfeed
-					break;
-				case '\r':    // 13   carriage return
-				case 26:
-					continue;
-				case 18:      // right align
-					Xoffset += this->getWidth() - fnt->getTextWidth(pszStr) - x;
-					continue;
-				case 19:      // center align
-					Xoffset += (this->getWidth() - fnt->getTextWidth(pszStr)) / 2 - x;
-					continue;
-				case ' ':     // space
-					Xoffset += fnt->maxWidth() / 2;
-					continue;
-				default:      // colour code
-					lastColor = color;
-					color = gbColorTable[pbChars[c]];
-					continue;
-				}
-			}
+		GlyphCache &glyphCache = GlyphCache::get(size);
+		const GlyphRun *runs = glyphCache.getRuns();
+
+		//Horizontal offset added by alignment codes and Korean characters
+		int shift = 0;
+
+		for (unsigned int i = 0; i < layout.items.size(); ++i) {
+			const TextLayoutItem &item = layout.items[i];
 
-			//Korean support
-			if (GetUserDefaultLangID() == MAKELANGID(LANG_KOREAN, SUBLANG_KOREAN)
-				&& IsDBCSLeadByte(pbChars[c])
-				&& !(pbChars[c] == 169 || pbChars[c] == 153)) {
-				this->blitKoreanChar((char*)&pbChars[c], Xoffset, Yoffset, size, color);
-				if (pbChars[++c])
-					continue;
+			switch (item.type) {
+			case TextLayoutItem::Glyph: {
+				const GlyphInfo *glyph = glyphCache.getGlyph(item.chars[0]);
+				if (glyph->runCount > 0)
+					this->blitGlyph(*glyph, runs, glyphCache.getPixels(item.color), x + item.x + shift, y + item.y);
+				break;
+			}
+			case TextLayoutItem::KoreanChar: {
+				int Xoffset = x + item.x + shift, Yoffset = y + item.y;
+				this->blitKoreanChar((const char*)item.chars, Xoffset, Yoffset, size, item.color);
+				shift = Xoffset - x - item.x;
+				break;
+			}
+			case TextLayoutItem::AlignRight:
+				shift += this->getWidth() - layout.width - x;
+				break;
+			case TextLayoutItem::AlignCenter:
+				shift += (this->getWidth() - layout.width) / 2 - x;
+				break;
+			case TextLayoutItem::NewLine:
+				shift = 0;
 				break;
 			}
+		}
+		return true;
+	}
 
-			// Skip if the character is not supported by the font
-			FontChar *fntChr = fnt->getChar(pbChars[c]);
-			if (!fntChr)
-				continue;
-
-			// If the colour is not "invisible"
-			if (color != ~0)
-			{
-				// begin drawing character process
-				for (int i = 0, pos = 0; pos < fntChr->getHeight() * fntChr->getWidth(); ++i, ++pos)
-				{
-					// font position
-					pos += fntChr->pixelOffset(i);
-
-					// x offset
-					int newX = Xoffset + (fntChr->getX() + pos % fntChr->getWidth());
-					if (newX >= this->getWidth()) break;
-					if (newX < 0) continue;
-
-					// y offset
-					int newY = Yoffset + (fntChr->getY() + pos / fntChr->getWidth());
-					if (newY >= this->getHeight()) break;
-					if (newY < 0) continue;
-
-					// blit offset
-					int offset = newY * this->getWidth() + newX;
-					if (offset >= this->getWidth() * this->getHeight()) break;
-					if (offset < 0) continue;
-
-					// Plot pixel
-					this->data[offset] = gbFontColors[color][fntChr->colorMask(i)];
-				}
-			} // invis colour
+	void Bitmap::blitGlyph(const GlyphInfo &glyph, const GlyphRun *runs, const u8 *pixels, int x, int y) {
+		const int width = this->getWidth(), height = this->getHeight();
+		runs += glyph.firstRun;
 
-			// Increment the X offset for the width of the character
-			Xoffset += fntChr->getWidth();
+		if (this->isAreaInside(x + glyph.left, y + glyph.top, x + glyph.right, y + glyph.bottom)) {
+			for (int i = 0; i < glyph.runCount; ++i) {
+				const GlyphRun &run = runs[i];
+				memcpy(&this->data[(y + run.y) * width + x + run.x], &pixels[run.firstPixel], run.length);
+			}
+			return;
+		}
+
+		for (int i = 0; i < glyph.runCount; ++i) {
+			const GlyphRun &run = runs[i];
+			const int left = x + run.x, row = y + run.y;
+
+			//The rest of the character is skipped after the first pixel that
+			//crosses the right edge, even if it is on a later row.
+			int length = run.length;
+			const bool isCut = left + length > width;
+			if (isCut)
+				length = width - left;
+
+			const int skipped = std::max(-left, 0);
+			if (0 <= row && row < height && skipped < length)
+				memcpy(&this->data[row * width + left + skipped], &pixels[run.firstPixel + skipped], length - skipped);
+
+			if (isCut)
+				break;
 		}
-		return true;
 	}
 
 
@@ -278,12 +255,16 @@ namespace graphics {
 
 	void Bitmap::drawLine(int x1, int y1, int x2, int y2, ColorId color) {
 		//If horizontal
-		if (y1 == y2)
+		if (y1 == y2) {
 			this->drawHorizontalLine(x1, x2, y1, color);
+			return;
+		}
 
 		//If vertical
-		else if (x1 == x2)
+		if (x1 == x2) {
 			this->drawVerticalLine(x1, y1, y2, color);
+			return;
+		}
 
 		//Trivial check
 		if (this->isLineTriviallyIgnorable(x1, y1, x2, y2))
@@ -291,12 +272,25 @@ namespace graphics {
 
 		//Use Bresenham's line algorithm
 		//Code taken from http://members.chello.at/~easyfilter/bresenham.html
-		else {
-			const int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
-			const int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
-			int err = dx + dy;
+		const int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+		const int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+		int err = dx + dy;
+
+		//All points lie within the box spanned by the two end points
+		const bool isInside = this->isAreaInside(
+			std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2));
 
-			int x = x1, y = y1;
+		int x = x1, y = y1;
+		if (isInside) {
+			this->drawDotUnsafe(x, y, color);
+			while (x != x2 || y != y2) {
+				const int e2 = err * 2;
+				if (e2 >= dy) { err += dy; x += sx; }
+				if (e2 <= dx) { err += dx; y += sy; }
+				this->drawDotUnsafe(x, y, color);
+			}
+		}
+		else {
 			this->drawDot(x, y, color);
 			while (x != x2 || y != y2) {
 				const int e2 = err * 2;
@@ -374,41 +368,145 @@ namespace graphics {
 
 	//-------- Circle drawing --------//
 
+	namespace {
+
+		//Precomputed output of Bresenham's circle algorithm for one radius.
+		struct CircleTable {
+			struct Point { int px, py; };
+
+			int radius;
+			std::vector<Point> points;		//(px, py) of each step of the algorithm
+			std::vector<int> rowHalfWidths;	//Widest -px for each py, or -1 if the row is not visited
+
+			CircleTable() : radius(0) {}
+
+			void build(int radius) {
+				this->radius = radius;
+				this->points.clear();
+				this->rowHalfWidths.assign(radius + 1, -1);
+
+				//Bresenham's circle algorithm
+				//Code taken from http://members.chello.at/easyfilter/bresenham.html
+				int px = -radius, py = 0, err = 2 - 2 * radius; /* II. Quadrant */
+				do {
+					const Point point = { px, py };
+					this->points.push_back(point);
+
+					if (py >= (int)this->rowHalfWidths.size())
+						this->rowHalfWidths.resize(py + 1, -1);
+					this->rowHalfWidths[py] = std::max(this->rowHalfWidths[py], -px);
+
+					const int r = err;
+					if (r <= py) err += ++py * 2 + 1;            /* e_xy+e_y < 0 */
+					if (r > px || err > py) err += ++px * 2 + 1; /* e_xy+e_x > 0 or no 2nd y-step */
+				} while (px < 0);
+			}
+		};
+
+		const int MAX_CACHED_CIRCLE_RADIUS = 256;
+
+		//Returns the circle table for @p radius (> 0). Tables for small radii
+		//are built once and kept; larger ones share a single scratch table.
+		const CircleTable& getCircleTable(int radius) {
+			static CircleTable cachedTables[MAX_CACHED_CIRCLE_RADIUS + 1];
+			static CircleTable largeTable;
+
+			CircleTable &table = (radius <= MAX_CACHED_CIRCLE_RADIUS) ? cachedTables[radius] : largeTable;
+			if (table.radius != radius)
+				table.build(radius);
+			return table;
+		}
+
+	} //unnamed namespace
+
 	void Bitmap::drawCircle(int x, int y, int radius, ColorId color) {
 		if (radius <= 0) return;
 
-		//Bresenham's circle algorithm
-		//Code taken from http://members.chello.at/easyfilter/bresenham.html  
-		int px = -radius, py = 0, err = 2 - 2 * radius; /* II. Quadrant */
-		do {
-			this->drawDot(x - px, y + py, color); /*   I. Quadrant */
-			this->drawDot(x - py, y - px, color); /*  II. Quadrant */
-			this->drawDot(x + px, y - py, color); /* III. Quadrant */
-			this->drawDot(x + py, y + px, color); /*  IV. Quadrant */
-			const int r = err;
-			if (r <= py) err += ++py * 2 + 1;            /* e_xy+e_y < 0 */
-			if (r > px || err > py) err += ++px * 2 + 1; /* e_xy+e_x > 0 or no 2nd y-step */
-		} while (px < 0);
+		//Trivial check
+		if (x + radius < 0 || x - radius >= this->getWidth()
+			|| y + radius < 0 || y - radius >= this->getHeight())
+			return;
+
+		const CircleTable &table = getCircleTable(radius);
+		const int pointCount = table.points.size();
+
+		if (this->isAreaInside(x - radius, y - radius, x + radius, y + radius)) {
+			for (int i = 0; i < pointCount; ++i) {
+				const int px = table.points[i].px, py = table.points[i].py;
+				this->drawDotUnsafe(x - px, y + py, color); /*   I. Quadrant */
+				this->drawDotUnsafe(x - py, y - px, color); /*  II. Quadrant */
+				this->drawDotUnsafe(x + px, y - py, color); /* III. Quadrant */
+				this->drawDotUnsafe(x + py, y + px, color); /*  IV. Quadrant */
+			}
+		}
+		else {
+			for (int i = 0; i < pointCount; ++i) {
+				const int px = table.points[i].px, py = table.points[i].py;
+				this->drawDot(x - px, y + py, color);
+				this->drawDot(x - py, y - px, color);
+				this->drawDot(x + px, y - py, color);
+				this->drawDot(x + py, y + px, color);
+			}
+		}
 	}
 
 	void Bitmap::drawFilledCircle(int x, int y, int radius, ColorId color) {
 		if (radius <= 0) return;
 
-		//Bresenham's circle algorithm, modified
-		//Code taken from http://members.chello.at/easyfilter/bresenham.html  
-		int px = -radius, py = 0, err = 2 - 2 * radius; /* II. Quadrant */
-		do {
-			this->drawHorizontalLine(x + px, x - px, y + py, color);  //Quadrants 1, 2
-			this->drawHorizontalLine(x + px, x - px, y - py, color);  //Quadrants 3, 4
-			const int r = err;
-			if (r <= py) err += ++py * 2 + 1;            /* e_xy+e_y < 0 */
-			if (r > px || err > py) err += ++px * 2 + 1; /* e_xy+e_x > 0 or no 2nd y-step */
-		} while (px < 0);
+		//Trivial check
+		if (x + radius < 0 || x - radius >= this->getWidth()
+			|| y + radius < 0 || y - radius >= this->getHeight())
+			return;
+
+		//Fill each row with the widest span that Bresenham's algorithm draws on it
+		const CircleTable &table = getCircleTable(radius);
+		const int rowCount = table.rowHalfWidths.size();
+
+		for (int py = 0; py < rowCount; ++py) {
+			const int halfWidth = table.rowHalfWidths[py];
+			if (halfWidth < 0) continue;
+
+			const int left = std::max(x - halfWidth, 0);
+			const int right = std::min(x + halfWidth, this->getWidth() - 1);
+			if (left > right) continue;
+
+			if (0 <= y + py && y + py < this->getHeight())
+				this->drawHorizontalLineUnsafe(left, right, y + py, color);  //Quadrants 1, 2
+			if (py != 0 && 0 <= y - py && y - py < this->getHeight())
+				this->drawHorizontalLineUnsafe(left, right, y - py, color);  //Quadrants 3, 4
+		}
 	}
 
 
 	//-------- Unsafe functions for fast drawing --------//
 
+	namespace {
+
+		//memset() for short spans, using 16-byte SSE2 stores
+		inline void fillBytes(u8 *dest, int count, u8 value) {
+			if (count < 16) {
+				while (count-- > 0)
+					*dest++ = value;
+				return;
+			}
+
+			const __m128i fill = _mm_set1_epi8((char)value);
+			u8 *const end = dest + count;
+			for (; dest + 16 <= end; dest += 16)
+				_mm_storeu_si128((__m128i*)dest, fill);
+
+			//Cover the remaining bytes with one overlapping store
+			if (dest < end)
+				_mm_storeu_si128((__m128i*)(end - 16), fill);
+		}
+
+	} //unnamed namespace
+
+	bool Bitmap::isAreaInside(int left, int top, int right, int bottom) const {
+		return left >= 0 && right < this->getWidth()
+			&& top >= 0 && bottom < this->getHeight();
+	}
+
 	void Bitmap::drawDotUnsafe(int x, int y, ColorId color) {
 		assert(0 <= x && x < this->getWidth());
 		assert(0 <= y && y < this->getHeight());
@@ -422,7 +520,7 @@ namespace graphics {
 		assert(0 <= y && y < this->getHeight());
 		assert(x1 <= x2);
 
-		memset(&this->data[y * this->getWidth() + x1], color, x2 - x1 + 1);
+		fillBytes(&this->data[y * this->getWidth() + x1], x2 - x1 + 1, color);
 	}
 
 	void Bitmap::drawVerticalLineUnsafe(int x, int y1, int y2, ColorId color) {
@@ -431,8 +529,10 @@ namespace graphics {
 		assert(0 <= y2 && y2 < this->getHeight());
 		assert(y1 <= y2);
 
-		for (int y = y1; y <= y2; ++y)
-			this->drawDotUnsafe(x, y, color);
+		const int stride = this->getWidth();
+		u8 *dest = &this->data[y1 * stride + x];
+		for (int y = y1; y <= y2; ++y, dest += stride)
+			*dest = color;
 	}
 
 
@@ -5,6 +5,9 @@
 
 namespace graphics {
 
+	struct GlyphInfo;
+	struct GlyphRun;
+
 	class Bitmap {
 	public:
 		bool blitString(const char *pszStr, int x, int y, u8 size);
@@ -28,6 +31,14 @@ namespace graphics {
 		void drawHorizontalLineUnsafe(int x1, int x2, int y, ColorId color);
 		void drawVerticalLineUnsafe(int x, int y1, int y2, ColorId color);
 
+		//Returns true if the (inclusive) area lies entirely inside the bitmap,
+		//so that it can be drawn with the unsafe functions.
+		bool isAreaInside(int left, int top, int right, int bottom) const;
+
+		//Draws the pixel runs of a cached font character at (x, y), clipped the
+		//same way as the original per-pixel loop in blitString().
+		void blitGlyph(const GlyphInfo &glyph, const GlyphRun *runs, const u8 *pixels, int x, int y);
+
 		void blitKoreanChar(const char *ch, int &x, int &y, u8 fontSize, u8 color);
 
 		//Trivially checks whether the line should be drawn; based on the trivial
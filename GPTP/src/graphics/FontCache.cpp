@@ -0,0 +1,206 @@
+#include "FontCache.h"
+#include "Font.h"
+#include "../SCBW/scbwdata.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace graphics {
+
+	//-------- Glyph cache --------//
+
+	GlyphCache::GlyphCache() : font(NULL) {}
+
+	GlyphCache& GlyphCache::get(u8 fontSize) {
+		assert(fontSize <= 3);
+		static GlyphCache glyphCaches[4];
+
+		GlyphCache &cache = glyphCaches[fontSize];
+		if (cache.font != fontBase[fontSize])
+			cache.build(fontBase[fontSize]);
+		return cache;
+	}
+
+	void GlyphCache::build(const Font *font) {
+		this->font = font;
+		this->runs.clear();
+		this->colorMasks.clear();
+		for (int color = 0; color < 256; ++color)
+			this->coloredPixels[color].clear();
+
+		for (int ch = 0; ch < 256; ++ch) {
+			const FontChar *fntChr = font->getChar((char)ch);
+			this->hasGlyph[ch] = fntChr != NULL;
+			if (!fntChr)
+				continue;
+
+			GlyphInfo &glyph = this->glyphs[ch];
+			glyph.firstRun = this->runs.size();
+			glyph.advance = fntChr->getWidth();
+			glyph.left = glyph.top = INT_MAX;
+			glyph.right = glyph.bottom = INT_MIN;
+
+			//Same traversal as the per-pixel loop that Bitmap::blitString() used
+			const int width = fntChr->getWidth(), height = fntChr->getHeight();
+			for (int i = 0, pos = 0; pos < height * width; ++i, ++pos) {
+				pos += fntChr->pixelOffset(i);
+				const int px = fntChr->getX() + pos % width;
+				const int py = fntChr->getY() + pos / width;
+
+				GlyphRun *lastRun = (int)this->runs.size() > glyph.firstRun ? &this->runs.back() : NULL;
+				if (lastRun && lastRun->y == py && lastRun->x + lastRun->length == px)
+					lastRun->length++;
+				else {
+					const GlyphRun run = { (s16)px, (s16)py, 1, (u32)this->colorMasks.size() };
+					this->runs.push_back(run);
+				}
+
+				this->colorMasks.push_back((u8)fntChr->colorMask(i));
+
+				glyph.left = std::min(glyph.left, px);
+				glyph.right = std::max(glyph.right, px);
+				glyph.top = std::min(glyph.top, py);
+				glyph.bottom = std::max(glyph.bottom, py);
+			}
+
+			glyph.runCount = this->runs.size() - glyph.firstRun;
+		}
+	}
+
+	const GlyphInfo* GlyphCache::getGlyph(u8 ch) const {
+		return this->hasGlyph[ch] ? &this->glyphs[ch] : NULL;
+	}
+
+	const GlyphRun* GlyphCache::getRuns() const {
+		return this->runs.empty() ? NULL : &this->runs[0];
+	}
+
+	const u8* GlyphCache::getPixels(u8 color) {
+		std::vector<u8> &pixels = this->coloredPixels[color];
+
+		if (pixels.size() != this->colorMasks.size()) {
+			pixels.resize(this->colorMasks.size());
+			for (unsigned int i = 0; i < pixels.size(); ++i)
+				pixels[i] = gbFontColors[color][this->colorMasks[i]];
+		}
+
+		return pixels.empty() ? NULL : &pixels[0];
+	}
+
+	//-------- Text layout cache --------//
+
+	namespace {
+
+		const int TEXT_LAYOUT_CACHE_SIZE = 256;	//Must be a power of 2
+
+		u32 hashText(const char *text, u8 fontSize) {
+			u32 hash = 2166136261u ^ fontSize;	//FNV-1a
+			for (; *text; ++text)
+				hash = (hash ^ (u8)*text) * 16777619u;
+			return hash;
+		}
+
+		void addItem(TextLayout &layout, u8 type, u8 color, u8 ch, u8 trailByte, int x, int y) {
+			const TextLayoutItem item = { type, color, { ch, trailByte }, x, y };
+			layout.items.push_back(item);
+		}
+
+		//Parses the text the same way Bitmap::blitString() used to draw it
+		void buildTextLayout(TextLayout &layout, const char *text, const Font *fnt, u8 fontSize) {
+			static const bool isKoreanLocale =
+				GetUserDefaultLangID() == MAKELANGID(LANG_KOREAN, SUBLANG_KOREAN);
+
+			layout.text = text;
+			layout.font = fnt;
+			layout.fontSize = fontSize;
+			layout.width = fnt->getTextWidth(text);
+			layout.height = fnt->getTextHeight(text);
+			layout.items.clear();
+
+			const u8 *pbChars = (const u8*)text;
+			u8 lastColor = 0, color = 0;
+			int x = 0, y = 0;
+
+			for (int c = 0; pbChars[c]; ++c) {
+				// Perform control character and whitespace functions
+				if (pbChars[c] <= ' ') {
+					switch (pbChars[c]) {
+					case 1:       // restore last colour
+						color = lastColor;
+						continue;
+					case '\t':    // 9    tab
+						x += fnt->getCharWidth(pbChars[c]);
+						continue;
+					case '\n':    // 10   newline
+						x = 0;
+						y += fnt->maxHeight();
+						addItem(layout, TextLayoutItem::NewLine, color, 0, 0, x, y);
+						continue;
+					case 11:      // invisible
+					case 20:
+						color = (u8)~0;
+						continue;
+					case '\f':    // 12   formfeed
+						break;
+					case '\r':    // 13   carriage return
+					case 26:
+						continue;
+					case 18:      // right align
+						addItem(layout, TextLayoutItem::AlignRight, color, 0, 0, x, y);
+						continue;
+					case 19:      // center align
+						addItem(layout, TextLayoutItem::AlignCenter, color, 0, 0, x, y);
+						continue;
+					case ' ':     // space
+						x += fnt->maxWidth() / 2;
+						continue;
+					default:      // colour code
+						lastColor = color;
+						color = gbColorTable[pbChars[c]];
+						continue;
+					}
+				}
+
+				//Korean support (the width is only known when the character is drawn)
+				if (isKoreanLocale
+					&& IsDBCSLeadByte(pbChars[c])
+					&& !(pbChars[c] == 169 || pbChars[c] == 153)) {
+					addItem(layout, TextLayoutItem::KoreanChar, color, pbChars[c], pbChars[c + 1], x, y);
+					if (pbChars[++c])
+						continue;
+					break;
+				}
+
+				// Skip if the character is not supported by the font
+				const FontChar *fntChr = fnt->getChar(pbChars[c]);
+				if (!fntChr)
+					continue;
+
+				addItem(layout, TextLayoutItem::Glyph, color, pbChars[c], 0, x, y);
+
+				// Increment the X offset for the width of the character
+				x += fntChr->getWidth();
+			}
+		}
+
+	} //unnamed namespace
+
+	const TextLayout& getTextLayout(const char *text, u8 fontSize) {
+		assert(text && fontSize <= 3);
+		static TextLayout cachedLayouts[TEXT_LAYOUT_CACHE_SIZE];
+
+		const Font *fnt = fontBase[fontSize];
+		TextLayout &layout = cachedLayouts[hashText(text, fontSize) & (TEXT_LAYOUT_CACHE_SIZE - 1)];
+
+		if (layout.font != fnt || layout.fontSize != fontSize || layout.text != text)
+			buildTextLayout(layout, text, fnt, fontSize);
+
+		return layout;
+	}
+
+} //graphics
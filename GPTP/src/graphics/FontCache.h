@@ -0,0 +1,97 @@
+//Caches used by Bitmap::blitString() to draw text without decoding each
+//font character and re-measuring each string on every call.
+
+#pragma once
+#include "../types.h"
+#include <string>
+#include <vector>
+
+namespace graphics {
+
+	class Font;
+
+	//Text color tables, defined in Bitmap.cpp
+	extern u8 gbColorTable[];
+	extern u8 gbFontColors[24][8];
+
+	/// A horizontal run of consecutive glyph pixels. Coordinates are relative
+	/// to the pen position, and already include FontChar::getX() / getY().
+	struct GlyphRun {
+		s16 x, y;
+		u16 length;
+		u32 firstPixel;		//Index of the first pixel in GlyphCache::getPixels()
+	};
+
+	/// Decoded form of a FontChar.
+	struct GlyphInfo {
+		int firstRun, runCount;
+		int advance;						//FontChar::getWidth()
+		int left, top, right, bottom;		//Inclusive bounds of all runs
+	};
+
+	/// Stores every character of one of the fontBase fonts as a list of pixel
+	/// runs, in the same order in which Bitmap::blitString() used to plot them.
+	/// The palette-mapped pixels of each run are built once per text color.
+	class GlyphCache {
+	public:
+		/// Returns the glyph cache of fontBase[fontSize] (0-3), rebuilding it if
+		/// the font has changed. @p fontSize must be valid and the font loaded.
+		static GlyphCache& get(u8 fontSize);
+
+		/// Returns the decoded glyph for @p ch, or NULL if the font does not
+		/// have the character.
+		const GlyphInfo* getGlyph(u8 ch) const;
+
+		const GlyphRun* getRuns() const;
+
+		/// Returns the pixels of all glyphs, mapped through gbFontColors[color].
+		const u8* getPixels(u8 color);
+
+	private:
+		GlyphCache();
+		void build(const Font *font);
+
+		const Font *font;
+		GlyphInfo glyphs[256];
+		bool hasGlyph[256];
+		std::vector<GlyphRun> runs;
+		std::vector<u8> colorMasks;				//FontChar::colorMask() of each pixel
+		std::vector<u8> coloredPixels[256];		//Built on first use of each color
+	};
+
+	/// A step in drawing a string. Positions are relative to the start of the
+	/// string, not counting alignment codes and Korean characters; those are
+	/// measured when the string is drawn.
+	struct TextLayoutItem {
+		enum Type {
+			Glyph,
+			KoreanChar,
+			AlignRight,
+			AlignCenter,
+			NewLine,
+		};
+
+		u8 type;
+		u8 color;
+		u8 chars[2];		//The character (and the trail byte for Korean characters)
+		int x, y;
+	};
+
+	/// The result of parsing a string for Bitmap::blitString().
+	struct TextLayout {
+		TextLayout() : font(NULL), fontSize(0), width(0), height(0) {}
+
+		std::string text;
+		const Font *font;
+		u8 fontSize;
+		int width, height;		//Font::getTextWidth() / getTextHeight()
+		std::vector<TextLayoutItem> items;
+	};
+
+	/// Returns the layout of @p text drawn with fontBase[fontSize]. Layouts are
+	/// cached by (text, font size), so that labels redrawn every frame are only
+	/// parsed and measured once. The returned reference is valid until the next
+	/// call.
+	const TextLayout& getTextLayout(const char *text, u8 fontSize);
+
+} //graphics
@@ -2,17 +2,19 @@
 #include "graphics_misc.h"
 #include "graphics_errors.h"
 #include "Bitmap.h"
+#include "Font.h"
 #include "../SCBW/scbwdata.h"
+#include <algorithm>
 
 namespace graphics {
 
 	//-------- Registering shapes --------//
 
-	void Shape::setText(int x, int y, int stringIndex, FontSize fontSize, CoordType coordType) {
+	void Shape::setText(int x, int y, int textLength, FontSize fontSize, CoordType coordType) {
 		this->type = TEXT;
 		this->p1.x = x;
 		this->p1.y = y;
-		this->stringIndex = stringIndex;
+		this->textLength = textLength;
 		this->fontSize = fontSize;
 		this->coordType = coordType;
 	}
@@ -73,35 +75,46 @@ namespace graphics {
 		this->coordType = coordType;
 	};
 
+	int Shape::getSize() const {
+		if (this->type == TEXT)
+			return getSizeWithText(this->textLength);
+		return sizeof(Shape);
+	}
+
 	//-------- Drawing --------//
 
-	void Shape::draw() const {
-		Point32 p1 = this->p1, p2 = this->p2;
+	bool Shape::getScreenPoints(Point32 &p1, Point32 &p2) const {
+		p1 = this->p1;
+		p2 = this->p2;
 		switch (this->coordType) {
 		case ON_SCREEN:
-			break;
+			return true;
 		case ON_MAP:
 			p1.x -= *screenX;
 			p1.y -= *screenY;
 			p2.x -= *screenX;
 			p2.y -= *screenY;
-			break;
+			return true;
 		case ON_MOUSE:
 			p1.x += mouse->x;
 			p1.y += mouse->y;
 			p2.x += mouse->x;
 			p2.y += mouse->y;
-			break;
+			return true;
 		default:
-			setError(ERR_UNKNOWN_COORD_TYPE);
-			break;
+			return false;
 		}
+	}
+
+	void Shape::draw() const {
+		Point32 p1, p2;
+		if (!this->getScreenPoints(p1, p2))
+			setError(ERR_UNKNOWN_COORD_TYPE);
 
 		switch (this->type) {
 		case TEXT:
 			//TODO: Add ability to change font size
-			gameScreenBuffer->blitString(
-				getStringFromIndex(this->stringIndex).c_str(), p1.x, p1.y, this->fontSize);
+			gameScreenBuffer->blitString(this->getText(), p1.x, p1.y, this->fontSize);
 			break;
 		case DOT:
 			gameScreenBuffer->drawDot(p1.x, p1.y, this->color);
@@ -127,4 +140,82 @@ namespace graphics {
 		}
 	}
 
+	//-------- Screen bounds --------//
+
+	namespace {
+
+		//Same limits as in Bitmap::blitKoreanChar()
+		const int KOR_CHAR_MAX_WIDTH = 32;
+		const int KOR_CHAR_MAX_HEIGHT = 32;
+
+		//Conservatively estimates the area covered by Bitmap::blitString().
+		bool getTextScreenBounds(const char *str, int x, int y, FontSize fontSize, Box32 &bounds) {
+			if (fontSize < FONT_SMALL || fontSize > FONT_LARGEST)
+				return false;
+
+			const Font *font = fontBase[fontSize];
+			if (!font || !str)
+				return false;
+
+			bool isAligned = false;
+			int extraWidth = 0, extraHeight = 0;
+			for (const u8 *ch = (const u8*)str; *ch; ++ch) {
+				if (*ch == 18 || *ch == 19)  //Right / center align
+					isAligned = true;
+				else if (*ch >= 0x80) {      //May be drawn as a Korean character
+					extraWidth += KOR_CHAR_MAX_WIDTH + 1;
+					extraHeight = KOR_CHAR_MAX_HEIGHT + 3;
+				}
+			}
+
+			//Glyphs are drawn with an offset within their character cell
+			bounds.left = x;
+			bounds.top = y;
+			bounds.right = x + font->getTextWidth(str) + extraWidth + font->maxWidth();
+			bounds.bottom = y + font->getTextHeight(str) + extraHeight + font->maxHeight();
+
+			if (isAligned) {
+				bounds.left = 0;
+				bounds.right = std::max(bounds.right, (int)gameScreenBuffer->getWidth() + font->maxWidth());
+			}
+
+			return true;
+		}
+
+	} //unnamed namespace
+
+	bool Shape::getScreenBounds(Box32 &bounds) const {
+		Point32 p1, p2;
+		if (!this->getScreenPoints(p1, p2))
+			return false;
+
+		switch (this->type) {
+		case TEXT:
+			return getTextScreenBounds(this->getText(), p1.x, p1.y, this->fontSize, bounds);
+		case DOT:
+			bounds.left = bounds.right = p1.x;
+			bounds.top = bounds.bottom = p1.y;
+			return true;
+		case LINE:
+		case BOX:
+		case FILLED_BOX:
+			bounds.left = std::min(p1.x, p2.x);
+			bounds.right = std::max(p1.x, p2.x);
+			bounds.top = std::min(p1.y, p2.y);
+			bounds.bottom = std::max(p1.y, p2.y);
+			return true;
+		case CIRCLE:
+		case FILLED_CIRCLE:
+			if (this->radius <= 0)
+				return false;
+			bounds.left = p1.x - this->radius;
+			bounds.right = p1.x + this->radius;
+			bounds.top = p1.y - this->radius;
+			bounds.bottom = p1.y + this->radius;
+			return true;
+		default:
+			return false;
+		}
+	}
+
 } //graphics
\ No newline at end of file
@@ -8,9 +8,12 @@ namespace graphics {
 	//Speed-efficient non-virtual class for storing shapes that will be drawn.
 	//All shape setter methods merely copy data and contain no actual logic.
 	//All coordinates are relative to screen.
+	//Shapes are stored back-to-back in the per-frame shape buffer (see
+	//graphics.cpp). Text shapes are followed by their null-terminated string.
 	class Shape {
 	public:
-		void setText(int x, int y, int stringIndex, FontSize fontSize, CoordType coordType);
+		//Text is stored in the getSize() - sizeof(Shape) bytes after the shape.
+		void setText(int x, int y, int textLength, FontSize fontSize, CoordType coordType);
 		void setDot(int x, int y, ColorId color, CoordType coordType);
 		void setLine(int x1, int y1, int x2, int y2, ColorId color, CoordType coordType);
 		void setBox(int left, int top, int right, int bottom, ColorId color, CoordType coordType);
@@ -19,7 +22,32 @@ namespace graphics {
 		void setFilledCircle(int x, int y, int radius, ColorId color, CoordType coordType);
 		void draw() const;
 
+		//Returns the buffer where the text of a text shape is stored.
+		char* getTextBuffer() { return (char*)(this + 1); }
+		const char* getText() const { return (const char*)(this + 1); }
+
+		//Returns the number of bytes the shape occupies in the shape buffer.
+		int getSize() const;
+
+		//Returns the number of bytes needed for a text shape, rounded up to keep
+		//the next shape aligned.
+		static int getSizeWithText(int textLength) {
+			return sizeof(Shape) + ((textLength + 1 + 3) & ~3);
+		}
+
+		//Shapes with the same key are drawn by the same Bitmap function in the
+		//same coordinate space.
+		int getBatchKey() const { return this->coordType * 16 + this->type; }
+
+		//Calculates the screen-space area (inclusive) that draw() may write to.
+		//Returns false if the shape draws nothing.
+		bool getScreenBounds(Box32 &bounds) const;
+
 	private:
+		//Converts p1 and p2 to screen coordinates. Returns false if the
+		//coordinate type is unknown.
+		bool getScreenPoints(Point32 &p1, Point32 &p2) const;
+
 		enum ShapeType {
 			NONE,
 			TEXT,
@@ -36,7 +64,7 @@ namespace graphics {
 		int radius;
 		ColorId color;
 		FontSize fontSize;
-		int stringIndex;
+		int textLength;
 	};
 
 } //graphics
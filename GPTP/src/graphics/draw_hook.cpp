@@ -2,16 +2,16 @@
 #include "../SCBW/api.h"
 #include "../hook_tools.h"
 #include "graphics_misc.h"
+#include "../profiler.h"
 
 namespace {
 
 	//-------- Draw hook taken from BWAPI --------//
-	bool wantRefresh = false;
 	void __stdcall DrawHook(graphics::Bitmap *surface, Bounds *bounds) {
-		if (wantRefresh) {
-			wantRefresh = false;
-			scbw::refreshScreen();
-		}
+		GPTP_PROFILE_HOOK(DrawHook);
+		//Instead of refreshing the whole screen, only redraw the areas covered
+		//by the shapes in this frame and the previous one.
+		graphics::markShapeRefreshRegions();
 
 		oldDrawGameProc(surface, bounds);
 
@@ -22,8 +22,7 @@ namespace {
 		//  if ( numShapes )
 		//    wantRefresh = true;
 		//}
-		if (graphics::drawAllShapes() > 0)
-			wantRefresh = true;
+		graphics::drawAllShapes();
 	}
 
 } //unnamed namespace
@@ -1,98 +1,230 @@
+//For _vsnprintf()
+#define _CRT_SECURE_NO_WARNINGS
+
 #include <cassert>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 #include "graphics.h"
 #include "graphics_errors.h"
 #include "graphics_misc.h"
 #include "Shape.h"
+#include "Bitmap.h"
+#include "../SCBW/scbwdata.h"
+#include "../SCBW/api.h"
 
 namespace graphics {
 
-	const int MAX_SHAPES = 10000;
-	const int MAX_STRINGS = 2000;
+	//The shape buffer starts at this size and doubles when it is full. It is
+	//never shrunk, so after the first few frames no memory is allocated.
+	const int INITIAL_BUFFER_SIZE = 256 * 1024;
+	//Shapes beyond this size are dropped (ERR_TOO_MANY_SHAPES).
+	const int MAX_BUFFER_SIZE = 16 * 1024 * 1024;
+	//Draw shapes grouped by coordinate type and shape type, instead of in the
+	//order they were added. This changes which shape ends up on top when
+	//shapes of different types overlap.
+	const bool SORT_SHAPES_BEFORE_DRAWING = false;
+	//ON_MAP shapes that lie farther than this outside the current screen are
+	//not recorded. The margin covers scrolling between recording and drawing.
+	const int MAP_CULLING_MARGIN = 128;
+
+	//Per-frame linear buffer; shapes are stored back-to-back (see Shape.h)
+	std::vector<u8> shapeBuffer;
+	int shapeBufferUsed = 0;
+	//Offset of each shape in shapeBuffer, in drawing order
+	std::vector<u32> shapeOffsets;
+	bool areShapesSorted = true;
+
+	//Number of ON_MAP shapes recorded / culled in this frame
+	int mapShapesKept = 0;
+	int mapShapesCulled = 0;
+
+	inline Shape* getShape(int index) {
+		return (Shape*)&shapeBuffer[shapeOffsets[index]];
+	}
+
+	inline int getShapeCount() {
+		return shapeOffsets.size();
+	}
 
-	//Static arrays for fast drawing
-	Shape shapes[MAX_SHAPES];
-	std::string strings[MAX_STRINGS];
-	int shapeCount = 0;
-	int stringCount = 0;
+	//Reserves @p size bytes in the shape buffer for a new shape. The returned
+	//pointer is valid until the next call. Returns nullptr if the buffer is full.
+	Shape* allocateShape(int size) {
+		if (shapeBufferUsed + size > (int)shapeBuffer.size()) {
+			if (shapeBufferUsed + size > MAX_BUFFER_SIZE) {
+				setError(ERR_TOO_MANY_SHAPES);
+				return nullptr;
+			}
+
+			const int newSize = std::max(std::max((int)shapeBuffer.size() * 2, INITIAL_BUFFER_SIZE),
+				shapeBufferUsed + size);
+			shapeBuffer.resize(std::min(newSize, MAX_BUFFER_SIZE));
+		}
+
+		Shape *shape = (Shape*)&shapeBuffer[shapeBufferUsed];
+		shapeOffsets.push_back(shapeBufferUsed);
+		shapeBufferUsed += size;
+		areShapesSorted = false;
+		return shape;
+	}
+
+	inline Shape* allocateShape() {
+		return allocateShape(sizeof(Shape));
+	}
 
 	void resetAllGraphics() {
-		shapeCount = 0;
-		stringCount = 0;
+		shapeBufferUsed = 0;
+		shapeOffsets.clear();
+		areShapesSorted = true;
+		mapShapesKept = 0;
+		mapShapesCulled = 0;
 		clearErrors();
 	}
 
+	//Returns false if the shape with the given (inclusive) bounds is an ON_MAP
+	//shape that is too far away from the screen to be seen.
+	bool isShapeVisible(int left, int top, int right, int bottom, CoordType ct) {
+		if (ct != ON_MAP)
+			return true;
+
+		const int screenLeft = *screenX - MAP_CULLING_MARGIN;
+		const int screenTop = *screenY - MAP_CULLING_MARGIN;
+		const int screenRight = *screenX + gameScreenBuffer->getWidth() + MAP_CULLING_MARGIN;
+		const int screenBottom = *screenY + gameScreenBuffer->getHeight() + MAP_CULLING_MARGIN;
+
+		const bool isVisible = left <= screenRight && screenLeft <= right
+			&& top <= screenBottom && screenTop <= bottom;
+
+		if (isVisible)
+			++mapShapesKept;
+		else
+			++mapShapesCulled;
+		setCullingCounters(mapShapesKept, mapShapesCulled);
+
+		return isVisible;
+	}
+
 
 	void drawText(int x, int y, const std::string& str, FontSize fontSize, CoordType ct) {
-		if (stringCount >= MAX_STRINGS) {
-			setError(ERR_TOO_MANY_STRINGS);
-			return;
-		}
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		strings[stringCount] = str;
-		shapes[shapeCount++].setText(x, y, stringCount++, fontSize, ct);
+		//Stop at the first null character, like std::string::c_str() would
+		const int length = strlen(str.c_str());
+
+		Shape *shape = allocateShape(Shape::getSizeWithText(length));
+		if (!shape) return;
+
+		shape->setText(x, y, length, fontSize, ct);
+		memcpy(shape->getTextBuffer(), str.c_str(), length + 1);
+	}
+
+	void drawTextf(int x, int y, FontSize fontSize, CoordType ct, const char *format, ...) {
+		va_list args;
+
+		va_start(args, format);
+		const int length = _vscprintf(format, args);
+		va_end(args);
+		if (length < 0) return;
+
+		Shape *shape = allocateShape(Shape::getSizeWithText(length));
+		if (!shape) return;
+
+		shape->setText(x, y, length, fontSize, ct);
+
+		va_start(args, format);
+		_vsnprintf(shape->getTextBuffer(), length + 1, format, args);
+		va_end(args);
 	}
 
 	void drawDot(int x, int y, ColorId color, CoordType ct) {
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		shapes[shapeCount++].setDot(x, y, color, ct);
+		if (!isShapeVisible(x, y, x, y, ct)) return;
+		if (Shape *shape = allocateShape())
+			shape->setDot(x, y, color, ct);
 	}
 
 	void drawLine(int x1, int y1, int x2, int y2, ColorId color, CoordType ct) {
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		shapes[shapeCount++].setLine(x1, y1, x2, y2, color, ct);
+		if (!isShapeVisible(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), ct)) return;
+		if (Shape *shape = allocateShape())
+			shape->setLine(x1, y1, x2, y2, color, ct);
 	}
 
 	void drawBox(int left, int top, int right, int bottom, ColorId color, CoordType ct) {
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		shapes[shapeCount++].setBox(left, top, right, bottom, color, ct);
+		if (!isShapeVisible(std::min(left, right), std::min(top, bottom), std::max(left, right), std::max(top, bottom), ct)) return;
+		if (Shape *shape = allocateShape())
+			shape->setBox(left, top, right, bottom, color, ct);
 	}
 
 	void drawCircle(int x, int y, int radius, ColorId color, CoordType ct) {
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		shapes[shapeCount++].setCircle(x, y, radius, color, ct);
+		if (!isShapeVisible(x - radius, y - radius, x + radius, y + radius, ct)) return;
+		if (Shape *shape = allocateShape())
+			shape->setCircle(x, y, radius, color, ct);
 	}
 
 	void drawFilledBox(int left, int top, int right, int bottom, ColorId color, CoordType ct) {
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		shapes[shapeCount++].setFilledBox(left, top, right, bottom, color, ct);
+		if (!isShapeVisible(std::min(left, right), std::min(top, bottom), std::max(left, right), std::max(top, bottom), ct)) return;
+		if (Shape *shape = allocateShape())
+			shape->setFilledBox(left, top, right, bottom, color, ct);
 	}
 
 	void drawFilledCircle(int x, int y, int radius, ColorId color, CoordType ct) {
-		if (shapeCount >= MAX_SHAPES) {
-			setError(ERR_TOO_MANY_SHAPES);
-			return;
-		}
-		shapes[shapeCount++].setFilledCircle(x, y, radius, color, ct);
+		if (!isShapeVisible(x - radius, y - radius, x + radius, y + radius, ct)) return;
+		if (Shape *shape = allocateShape())
+			shape->setFilledCircle(x, y, radius, color, ct);
 	}
 
-	const std::string& getStringFromIndex(int stringIndex) {
-		assert(0 <= stringIndex && stringIndex < MAX_STRINGS);
-		return strings[stringIndex];
-	}
+	//Orders shape offsets by their batch key; used with std::stable_sort() so
+	//that shapes with the same key keep their relative order.
+	struct CompareShapeBatchKey {
+		bool operator()(u32 lhs, u32 rhs) const {
+			return ((const Shape*)&shapeBuffer[lhs])->getBatchKey()
+				< ((const Shape*)&shapeBuffer[rhs])->getBatchKey();
+		}
+	};
 
 	int drawAllShapes() {
+		if (SORT_SHAPES_BEFORE_DRAWING && !areShapesSorted) {
+			std::stable_sort(shapeOffsets.begin(), shapeOffsets.end(), CompareShapeBatchKey());
+			areShapesSorted = true;
+		}
+
+		const int shapeCount = getShapeCount();
 		for (int i = 0; i < shapeCount; ++i)
-			shapes[i].draw();
+			getShape(i)->draw();
 		drawErrorMessages();
 		return shapeCount;  //TODO: Fix this
 	}
 
+	//-------- Refresh regions --------//
+
+	void markShapeRefreshRegions() {
+		//Screen bounds drawn over in the previous call; these must be redrawn to
+		//erase shapes that have moved or disappeared since then.
+		static std::vector<Box32> previousBounds;
+		static std::vector<Box32> currentBounds;
+
+		currentBounds.clear();
+
+		Box32 bounds;
+		const int shapeCount = getShapeCount();
+		for (int i = 0; i < shapeCount; ++i) {
+			if (getShape(i)->getScreenBounds(bounds))
+				currentBounds.push_back(bounds);
+		}
+
+		if (getErrorMessageBounds(bounds))
+			currentBounds.push_back(bounds);
+
+		for (unsigned int i = 0; i < previousBounds.size(); ++i) {
+			const Box32 &b = previousBounds[i];
+			scbw::refreshScreen(b.left, b.top, b.right, b.bottom);
+		}
+
+		for (unsigned int i = 0; i < currentBounds.size(); ++i) {
+			const Box32 &b = currentBounds[i];
+			scbw::refreshScreen(b.left, b.top, b.right, b.bottom);
+		}
+
+		previousBounds.swap(currentBounds);
+	}
+
 } //graphics
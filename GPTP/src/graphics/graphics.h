@@ -44,6 +44,10 @@ namespace graphics {
 	void drawText(int x, int y, const std::string& str,
 		FontSize fontSize = FONT_MEDIUM, CoordType ct = ON_SCREEN);
 
+	/// Same as drawText(), but formats the text printf-style. The text is
+	/// written straight into the shape buffer, without a temporary string.
+	void drawTextf(int x, int y, FontSize fontSize, CoordType ct, const char *format, ...);
+
 	void drawDot(int x, int y, ColorId color, CoordType ct = ON_SCREEN);
 
 	void drawLine(int x1, int y1, int x2, int y2, ColorId color, CoordType ct = ON_SCREEN);
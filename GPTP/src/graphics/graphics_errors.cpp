@@ -1,10 +1,16 @@
+//For sprintf()
+#define _CRT_SECURE_NO_WARNINGS
+
 #include "graphics_errors.h"
 #include "Bitmap.h"
+#include "Font.h"
 #include "../SCBW/scbwdata.h"
+#include <cstdio>
 
 namespace graphics {
 
 	int errorFlags;
+	int keptShapeCounter, culledShapeCounter;
 
 	void setError(GraphicsErrorId error) {
 		errorFlags |= error;
@@ -12,6 +18,13 @@ namespace graphics {
 
 	void clearErrors() {
 		errorFlags = 0;
+		keptShapeCounter = 0;
+		culledShapeCounter = 0;
+	}
+
+	void setCullingCounters(int keptCount, int culledCount) {
+		keptShapeCounter = keptCount;
+		culledShapeCounter = culledCount;
 	}
 
 	void drawErrorMessages() {
@@ -22,10 +35,6 @@ namespace graphics {
 			gameScreenBuffer->blitString("Error: Too many shapes!", 10, 10, 2);
 		}
 
-		if (errorFlags & ERR_TOO_MANY_STRINGS) {
-			gameScreenBuffer->blitString("Error: Too many strings!", 10, 40, 2);
-		}
-
 		if (errorFlags & ERR_UNKNOWN_SHAPE) {
 			gameScreenBuffer->blitString("Error: Unknown shape found.", 10, 70, 2);
 		}
@@ -34,8 +43,32 @@ namespace graphics {
 			gameScreenBuffer->blitString("Error: Unknown coordinate type found.", 10, 100, 2);
 		}
 
+		if (culledShapeCounter) {
+			char buffer[64];
+			sprintf(buffer, "Map shapes: %d kept, %d culled", keptShapeCounter, culledShapeCounter);
+			gameScreenBuffer->blitString(buffer, 10, 130, 2);
+		}
+
 #endif
 
 	};
 
+	bool getErrorMessageBounds(Box32 &bounds) {
+
+#ifndef NDEBUG
+
+		if (errorFlags || culledShapeCounter) {
+			//All messages are drawn at x = 10, from y = 10 to y = 130
+			bounds.left = 0;
+			bounds.top = 0;
+			bounds.right = gameScreenBuffer->getWidth() - 1;
+			bounds.bottom = 130 + Font::getTextHeight("E", 2) * 2;
+			return true;
+		}
+
+#endif
+
+		return false;
+	}
+
 } //graphics
@@ -1,12 +1,12 @@
 //Simple error handling for drawing graphics
 
 #pragma once
+#include "../SCBW/structures/common.h"
 
 namespace graphics {
 
 	enum GraphicsErrorId {
 		ERR_TOO_MANY_SHAPES = 0x1,
-		ERR_TOO_MANY_STRINGS = 0x2,
 		ERR_UNKNOWN_SHAPE = 0x4,
 		ERR_UNKNOWN_COORD_TYPE = 0x8,
 	};
@@ -14,11 +14,19 @@ namespace graphics {
 	//Sets an error flag.
 	void setError(GraphicsErrorId error);
 
-	//Clears all error flags.
+	//Clears all error flags and culling counters.
 	void clearErrors();
 
+	//Sets the number of ON_MAP shapes recorded / culled in the current frame.
+	//If any shapes were culled, drawErrorMessages() shows both counters.
+	void setCullingCounters(int keptCount, int culledCount);
+
 	//Checks current error flags and draws appropriate error messages to the screen.
 	//If NDEBUG is defined (i.e. release builds), this function does nothing.
 	void drawErrorMessages();
 
+	//Retrieves the screen area (inclusive) used by drawErrorMessages().
+	//Returns false if there are no error messages to draw.
+	bool getErrorMessageBounds(Box32 &bounds);
+
 } //graphics
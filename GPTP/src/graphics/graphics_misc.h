@@ -4,8 +4,11 @@
 
 namespace graphics {
 
-	const std::string& getStringFromIndex(int stringIndex);
-
 	int drawAllShapes();
 
+	//Marks the refresh regions (see refreshRegions in scbwdata.h) covered by
+	//the shapes of the current frame and the previous call, so that StarCraft
+	//redraws them before drawAllShapes() is called.
+	void markShapeRefreshRegions();
+
 } //graphics
@@ -0,0 +1,105 @@
+#include "hook_thunk.h"
+#include <cassert>
+#include <cstring>
+
+namespace GPTP {
+
+	namespace {
+
+		void putDword(u8 *&out, u32 value) {
+			memcpy(out, &value, sizeof(value));
+			out += sizeof(value);
+		}
+
+	} //unnamed namespace
+
+	ThunkSignature& ThunkSignature::arg(Register::Enum reg) {
+		assert(this->argCount < MAX_ARGS && reg != Register::ESP);
+		const Arg argument = { true, (u8)reg };
+		this->args[this->argCount++] = argument;
+		return *this;
+	}
+
+	ThunkSignature& ThunkSignature::stackArg(int index) {
+		assert(this->argCount < MAX_ARGS && 0 <= index && index < 256);
+		const Arg argument = { false, (u8)index };
+		this->args[this->argCount++] = argument;
+		return *this;
+	}
+
+	ThunkSignature& ThunkSignature::returns(int size) {
+		assert(size == 1 || size == 2 || size == 4);
+		this->returnSize = size;
+		return *this;
+	}
+
+	ThunkSignature& ThunkSignature::popStack(int bytes) {
+		assert(0 <= bytes && bytes < 0x10000);
+		this->stackBytes = bytes;
+		return *this;
+	}
+
+	size_t ThunkSignature::emit(u8 *buffer, const void *hook) const {
+		u8 *out = buffer;
+
+		//Save the registers that a __cdecl function may change
+		u8 savedRegisters[3];
+		int savedCount = 0;
+		for (int reg = Register::EAX; reg <= Register::EDX; ++reg) {
+			if (reg == Register::EAX && this->returnSize != 0)
+				continue;
+			savedRegisters[savedCount++] = (u8)reg;
+			*out++ = 0x50 + (u8)reg;				//PUSH reg
+		}
+
+		//Push the arguments from last to first
+		int pushedCount = savedCount;
+		for (int i = this->argCount - 1; i >= 0; --i) {
+			const Arg &argument = this->args[i];
+			if (argument.isRegister)
+				*out++ = 0x50 + argument.value;		//PUSH reg
+			else {
+				//Skip the pushed values and the return address
+				const u32 offset = 4 * (pushedCount + 1 + argument.value);
+				if (offset < 0x80) {
+					*out++ = 0xFF; *out++ = 0x74; *out++ = 0x24;	//PUSH DWORD PTR [ESP + offset8]
+					*out++ = (u8)offset;
+				}
+				else {
+					*out++ = 0xFF; *out++ = 0xB4; *out++ = 0x24;	//PUSH DWORD PTR [ESP + offset32]
+					putDword(out, offset);
+				}
+			}
+			++pushedCount;
+		}
+
+		*out++ = 0xE8;								//CALL hook
+		putDword(out, (u32)((size_t)hook - (size_t)(out + 4)));
+
+		if (this->argCount > 0) {
+			*out++ = 0x83; *out++ = 0xC4;			//ADD ESP, imm8
+			*out++ = (u8)(4 * this->argCount);
+		}
+
+		if (this->returnSize == 1) {
+			*out++ = 0x0F; *out++ = 0xB6; *out++ = 0xC0;	//MOVZX EAX, AL
+		}
+		else if (this->returnSize == 2) {
+			*out++ = 0x0F; *out++ = 0xB7; *out++ = 0xC0;	//MOVZX EAX, AX
+		}
+
+		while (savedCount > 0)
+			*out++ = 0x58 + savedRegisters[--savedCount];	//POP reg
+
+		if (this->stackBytes > 0) {
+			*out++ = 0xC2;							//RETN imm16
+			*out++ = (u8)this->stackBytes;
+			*out++ = (u8)(this->stackBytes >> 8);
+		}
+		else
+			*out++ = 0xC3;							//RETN
+
+		return out - buffer;
+	}
+
+} //GPTP
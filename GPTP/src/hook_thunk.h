@@ -0,0 +1,83 @@
+/// Generated register-marshalling thunks for hooks.
+///
+/// Many StarCraft functions take their arguments in arbitrary registers. A
+/// ThunkSignature describes where each argument of a hook function comes from,
+/// and emit() generates a small x86 thunk that pushes those arguments, calls
+/// the (__cdecl) hook function and returns like the original function did.
+///
+/// Unlike a hand-written PUSHAD/POPAD wrapper, the thunk only saves the
+/// registers that a __cdecl function may change (EAX, ECX and EDX, minus the
+/// return register), and it keeps no state in static variables, so it is
+/// reentrant. Example:
+///
+///   //u32 getModifiedUnitSpeedHook(const CUnit* unit, u32 baseSpeed);
+///   //with unit in EDX and baseSpeed in EAX, result in EAX
+///   jmpPatch(createThunk(GPTP::ThunkSignature()
+///     .arg(GPTP::Register::EDX).arg(GPTP::Register::EAX).returns(4),
+///     hooks::getModifiedUnitSpeedHook), 0x0047B5F0);
+///
+/// This file does not depend on Windows; see createThunk() in hook_tools.h for
+/// allocating the thunks in executable memory.
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+
+namespace GPTP {
+
+	namespace Register {
+		//Values are the x86 register numbers
+		enum Enum {
+			EAX = 0,
+			ECX = 1,
+			EDX = 2,
+			EBX = 3,
+			ESP = 4,
+			EBP = 5,
+			ESI = 6,
+			EDI = 7,
+		};
+	}
+
+	class ThunkSignature {
+	public:
+		/// Maximum number of arguments of a hook function.
+		static const int MAX_ARGS = 8;
+		/// Maximum number of bytes written by emit().
+		static const int MAX_THUNK_SIZE = 96;
+
+		ThunkSignature() : argCount(0), returnSize(0), stackBytes(0) {}
+
+		/// Passes the value of @p reg as the next argument. For 8- and 16-bit
+		/// parameters, the hook function only reads the low bits (e.g. BL for EBX).
+		ThunkSignature& arg(Register::Enum reg);
+
+		/// Passes a stack argument of the hooked function as the next argument.
+		/// @p index 0 is the first dword above the return address.
+		ThunkSignature& stackArg(int index);
+
+		/// Returns the result of the hook function in EAX. Results of @p size 1
+		/// or 2 bytes (e.g. bool or u16) are zero-extended to 32 bits.
+		ThunkSignature& returns(int size);
+
+		/// Removes @p bytes of stack arguments when returning (RETN bytes).
+		ThunkSignature& popStack(int bytes);
+
+		/// Writes the thunk for @p hook to @p buffer, which must have room for
+		/// MAX_THUNK_SIZE bytes and must not be moved afterwards (the CALL is
+		/// relative). Returns the number of bytes written.
+		size_t emit(u8 *buffer, const void *hook) const;
+
+	private:
+		struct Arg {
+			bool isRegister;
+			u8 value;			//Register::Enum or stack argument index
+		};
+
+		Arg args[MAX_ARGS];
+		int argCount;
+		int returnSize;			//0 if the hook function returns void
+		int stackBytes;
+	};
+
+} //GPTP
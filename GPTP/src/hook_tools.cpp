@@ -1,35 +1,129 @@
 #include "hook_tools.h"
 
+namespace {
+
+	//Changes the protection of memory pages with VirtualProtect()
+	class VirtualMemoryProtector : public GPTP::MemoryProtector {
+	public:
+		VirtualMemoryProtector() : pageSize(0) {}
+
+		size_t getPageSize() const {
+			if (!this->pageSize) {
+				SYSTEM_INFO systemInfo;
+				GetSystemInfo(&systemInfo);
+				this->pageSize = systemInfo.dwPageSize;
+			}
+			return this->pageSize;
+		}
+
+		bool unprotect(void* page, u32& oldProtection) {
+			DWORD oldProt = 0;
+			const BOOL result = VirtualProtect(page, 1, PAGE_EXECUTE_READWRITE, &oldProt);
+			oldProtection = oldProt;
+			return result != FALSE;
+		}
+
+		bool restore(void* page, u32 oldProtection) {
+			DWORD oldProt = 0;
+			return VirtualProtect(page, 1, oldProtection, &oldProt) != FALSE;
+		}
+
+		void flushInstructionCache(void* page) {
+			FlushInstructionCache(GetCurrentProcess(), page, this->getPageSize());
+		}
+
+	private:
+		mutable size_t pageSize;
+	};
+
+	VirtualMemoryProtector memoryProtector;
+
+	//Set between beginPatchSet() and endPatchSet()
+	GPTP::PatchSet* activePatchSet = NULL;
+
+	//Executable memory for createThunk()
+	const size_t THUNK_ARENA_SIZE = 4096;
+	u8* thunkArena = NULL;
+	size_t thunkArenaUsed = 0;
+
+	//Writes a relative JMP or CALL instruction directly, without a temporary buffer
+	void writeBranch(u8 opcode, const void* target, void* position, unsigned int nops) {
+		DWORD oldProt = 0;
+		VirtualProtect(position, 5 + nops, PAGE_EXECUTE_READWRITE, &oldProt);
+
+		u8* const data = (u8*)position;
+		data[0] = opcode;
+		*(s32*)(&data[1]) = (s32)target - (s32)position - 5;  //Relative address
+		memset(&data[5], 0x90, nops); //NOP instructions
+
+		VirtualProtect(position, 5 + nops, oldProt, &oldProt);
+		FlushInstructionCache(GetCurrentProcess(), position, 5 + nops);
+	}
+
+} //unnamed namespace
+
 //Injects a relative CALL to [target] at the [position].
 //Original function from BWAPI by Kovarex; Modified by pastelmind
 void callPatch(const void* target, void* position, const unsigned int nops) {
-	u8* const data = new u8[5 + nops];
-	data[0] = 0xE8; //Relative CALL instruction
-	const u32 address = (u32)target - (u32)position - 5;  //Relative address
-	*(u32*)(&data[1]) = address;
-	for (unsigned int i = 0; i < nops; ++i)
-		data[5 + i] = 0x90; //NOP instruction
-	memoryPatch(position, data, 5 + nops);
-	delete[] data;
+	if (activePatchSet)
+		activePatchSet->addCall(target, position, nops);
+	else if (target) //NULL if createThunk() failed
+		writeBranch(0xE8, target, position, nops); //Relative CALL instruction
 }
 
 //Injects a relative JMP to [target] at the [position].
 //Original function from BWAPI by Kovarex; Modified by pastelmind
 void jmpPatch(const void* target, void* position, unsigned int nops) {
-	u8* const data = new u8[5 + nops];
-	data[0] = 0xE9; //Relative JMP instruction
-	const s32 address = (s32)target - (s32)position - 5;  //Relative address
-	*(s32*)(&data[1]) = address;
-	for (unsigned int i = 0; i < nops; ++i)
-		data[5 + i] = 0x90; //NOP instruction
-	memoryPatch(position, data, 5 + nops);
-	delete[] data;
+	if (activePatchSet)
+		activePatchSet->addJmp(target, position, nops);
+	else if (target) //NULL if createThunk() failed
+		writeBranch(0xE9, target, position, nops); //Relative JMP instruction
 }
 
 //Inject an array of bytes, using the given length.
 void memoryPatch(void* const address, const u8* data, const size_t size) {
+	if (activePatchSet) {
+		activePatchSet->add(address, data, size);
+		return;
+	}
+
 	DWORD oldProt = 0;
 	VirtualProtect(address, size, PAGE_EXECUTE_READWRITE, &oldProt);
 	memcpy(address, data, size);
 	VirtualProtect(address, size, oldProt, &oldProt);
 }
+
+void beginPatchSet(GPTP::PatchSet& patchSet) {
+	activePatchSet = &patchSet;
+}
+
+bool endPatchSet() {
+	GPTP::PatchSet* const patchSet = activePatchSet;
+	activePatchSet = NULL;
+	return patchSet != NULL && patchSet->apply(memoryProtector);
+}
+
+GPTP::MemoryProtector& getMemoryProtector() {
+	return memoryProtector;
+}
+
+void* createThunk(const GPTP::ThunkSignature& signature, const void* hook) {
+	if (!thunkArena || THUNK_ARENA_SIZE - thunkArenaUsed < GPTP::ThunkSignature::MAX_THUNK_SIZE) {
+		thunkArena = (u8*)VirtualAlloc(NULL, THUNK_ARENA_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+		thunkArenaUsed = 0;
+
+		if (!thunkArena) {
+			//Keep the hooked code as it is rather than jumping to NULL
+			if (activePatchSet)
+				activePatchSet->reject(GPTP::PatchSet::ERROR_OUT_OF_MEMORY, hook);
+			return NULL;
+		}
+	}
+
+	u8* const thunk = thunkArena + thunkArenaUsed;
+	const size_t size = signature.emit(thunk, hook);
+	thunkArenaUsed += (size + 15) & ~15; //Keep thunks 16-byte aligned
+
+	FlushInstructionCache(GetCurrentProcess(), thunk, size);
+	return thunk;
+}
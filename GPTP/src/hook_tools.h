@@ -2,6 +2,8 @@
 
 #pragma once
 #include "types.h"
+#include "patch_set.h"
+#include "hook_thunk.h"
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -58,3 +60,40 @@ void memoryPatch(void* const address, const u8* data, const size_t size);
 inline void memoryPatch(const u32 address, const u8* data, const size_t size) {
 	memoryPatch((void*)address, data, size);
 }
+
+/// Starts collecting patches into [patchSet].
+///
+/// Until endPatchSet() is called, jmpPatch(), callPatch() and memoryPatch()
+/// add their patches to [patchSet] instead of writing to memory immediately.
+/// This is used by Plugin::InitializePlugin() to inject all hooks at once.
+///
+/// @param  patchSet  Must stay alive until endPatchSet() is called.
+void beginPatchSet(GPTP::PatchSet& patchSet);
+
+/// Applies all patches collected since beginPatchSet().
+///
+/// If any of the patches cannot be applied (e.g. two of them overlap), none of
+/// them are, and the reason is available from the PatchSet.
+///
+/// @return   true if all patches were applied.
+bool endPatchSet();
+
+/// Returns the VirtualProtect()-based MemoryProtector used by the functions
+/// above, e.g. to call GPTP::PatchSet::rollback().
+GPTP::MemoryProtector& getMemoryProtector();
+
+/// Generates a thunk that calls [hook] with the arguments described by
+/// [signature] (see hook_thunk.h).
+///
+/// The thunk is placed in executable memory that is never freed. Use the
+/// returned address with jmpPatch() or callPatch() in place of a hand-written
+/// naked wrapper function.
+///
+/// If no executable memory can be allocated, the patch set being collected
+/// (see beginPatchSet()) fails to apply, and jmpPatch() / callPatch() outside
+/// of a patch set write nothing.
+///
+/// @param  signature The registers and stack arguments passed to [hook].
+/// @param  hook      A __cdecl function.
+/// @return           The address of the thunk, or NULL on failure.
+void* createThunk(const GPTP::ThunkSignature& signature, const void* hook);
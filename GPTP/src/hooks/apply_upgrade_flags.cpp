@@ -5,11 +5,13 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
+#include <profiler.h>
 
 namespace hooks {
 
 	//This hook function is called when creating a new unit.
 	void applyUpgradeFlagsToNewUnitHook(CUnit *unit) {
+		GPTP_PROFILE_HOOK(ApplyUpgradeFlagsToNewUnit);
 		//Default StarCraft behavior
 		using scbw::getUpgradeLevel;
 
@@ -75,6 +77,7 @@ namespace hooks {
 	//This function is called when an upgrade is finished, or when transferring a
 	//unit's ownership from one player to another (via triggers or Mind Control).
 	void applyUpgradeFlagsToExistingUnitsHook(u8 playerId, u8 upgradeId) {
+		GPTP_PROFILE_HOOK(ApplyUpgradeFlagsToExistingUnits);
 		//Default StarCraft logic
 		bool isSpeedUpgrade = true, isCooldownUpgrade = false;
 		u16 validUnitId1 = -1, validUnitId2 = -1;
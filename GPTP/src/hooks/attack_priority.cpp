@@ -3,9 +3,12 @@
 #include "attack_priority.h"
 #include <SCBW/scbwdata.h>
 #include <SCBW/api.h>
+#include <SCBW/TargetingTables.h>
+#include <SCBW/TypeInfoCache.h>
 #include <cassert>
 #include <algorithm>
 #include <SCBW/UnitFinder.h>
+#include <profiler.h>
 
 
 const int ATTACK_PRIORITY_GROUP_SIZE = 16;
@@ -71,7 +74,7 @@ namespace {
 		//If the unit can't turn around, check if the target is within the attack angle.
 		if (!(actualUnit->status & UnitStatus::CanTurnAroundToAttack)) {
 			if (!isTargetPosWithinAttackAngle(target->getX(), target->getY(),
-				actualUnit, units_dat::GroundWeapon[actualUnit->id]))
+				actualUnit, scbw::typeInfoCache.getUnit(actualUnit->id).groundWeapon))
 			{
 				return false;
 			}
@@ -91,6 +94,7 @@ namespace hooks {
 
 	//Calculates the attack priority of the @p target for the @p attacker.
 	u32 getAttackPriorityHook(const CUnit* target, const CUnit* attacker) {
+		GPTP_PROFILE_HOOK(GetAttackPriority);
 		//Default StarCraft behavior
 
 		const CUnit *actualTarget = target;
@@ -101,18 +105,15 @@ namespace hooks {
 				actualTarget = firstLoadedUnit;
 		}
 
-		//Units that are not important
-		if (target->id == UnitId::larva
-			|| target->id == UnitId::egg
-			|| target->id == UnitId::cocoon
-			|| target->id == UnitId::lurker_egg)
+		//Units that are not important (larvae, eggs, cocoons, lurker eggs)
+		if (scbw::targetingTables.getPriorityClass(target->id) == scbw::AttackPriorityClass::Unimportant)
 			return 5;
 
 		//Normal units
 		u32 attackPriority = 4;
 
 		//Workers
-		if (units_dat::BaseProperty[actualTarget->id] & UnitProperty::Worker)
+		if (scbw::targetingTables.getPriorityClass(actualTarget->id) == scbw::AttackPriorityClass::Worker)
 			attackPriority = 2;
 
 		//Units that can fight back
@@ -138,6 +139,7 @@ namespace hooks {
 
 	//Searches for the best attack target nearby for the @p unit.
 	const CUnit* findBestAttackTargetHook(CUnit* unit) {
+		GPTP_PROFILE_HOOK(FindBestAttackTarget);
 		//Default StarCraft behavior
 
 		attackPriorityData.reset();
@@ -149,7 +151,7 @@ namespace hooks {
 			seekRange += 64;
 		//AI units have use default sight range if it is bigger
 		else if (unit->pAI)
-			seekRange = std::max(seekRange, units_dat::SightRange[unit->id] * 32);
+			seekRange = std::max(seekRange, scbw::typeInfoCache.getUnit(unit->id).sightRange * 32);
 
 		int searchRange = seekRange + 64;
 		u32 minRange = getMinimumRange(unit);
@@ -168,6 +170,7 @@ namespace hooks {
 
 	//Searches for a random attack target nearby for the @p unit.
 	const CUnit* findRandomAttackTargetHook(CUnit* unit) {
+		GPTP_PROFILE_HOOK(FindRandomAttackTarget);
 		//Default StarCraft behavior
 
 		attackPriorityData.reset();
@@ -2,6 +2,7 @@
 #include "unit_morph.h"
 #include <SCBW/enumerations.h>
 #include <SCBW/scbwdata.h>
+#include <profiler.h>
 
 //-------- Helper function declarations. Do NOT modify! ---------//
 
@@ -17,6 +18,7 @@ namespace hooks {
 	//Checks if @p unitId is a building that can be morphed from another building.
 	//Note: This hook affects the behavior of CUnit::isRemorphingBuilding().
 	bool isMorphedBuildingHook(u16 unitId) {
+		GPTP_PROFILE_HOOK(IsMorphedBuilding);
 		//Default StarCraft behavior
 
 		if (unitId == UnitId::lair
@@ -34,6 +36,7 @@ namespace hooks {
 	//For example, Greater Spires are counted as Spires, so that the AI would not
 	//try to rebuild another Spire after morphing one into a Greater Spire.
 	int getMorphBuildingTypeCountHook(const CUnit *unit, u16 unitId, bool ignoreIncomplete) {
+		GPTP_PROFILE_HOOK(GetMorphBuildingTypeCount);
 		//Default StarCraft behavior
 
 		int unitCount = getNumberOfUnitType(unit, unitId, ignoreIncomplete);
@@ -1,6 +1,7 @@
 #include "bunker_hooks.h"
 #include <SCBW/scbwdata.h>
 #include "../SCBW/enumerations.h"
+#include "../profiler.h"
 
 //Helper function declarations. Do NOT modify!
 namespace {
@@ -15,6 +16,7 @@ namespace hooks {
 
 	/// Checks whether the unit can attack from inside a bunker.
 	bool unitCanAttackInsideBunkerHook(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(UnitCanAttackInsideBunker);
 		//Default StarCraft behavior
 		const u16 unitId = unit->id;
 		if (unitId == UnitId::TerranMarine
@@ -32,6 +34,7 @@ namespace hooks {
 	}
 
 	void createBunkerAttackThingyHook(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(CreateBunkerAttackThingy);
 		//Default StarCraft behavior
 		CImage *bunkerImage = unit->connectedUnit->sprite->mainGraphic;
 
@@ -1,66 +1,73 @@
 #include "cloak_nearby_units.h"
-#include <SCBW/UnitFinder.h>
+#include <SCBW/AuraEngine.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
-#include <algorithm>
+#include <profiler.h>
 
 //Helper functions
 namespace {
-	void secondaryOrder_Cloak(CUnit *unit);
+	bool secondaryOrder_Cloak(CUnit *unit);
+
+	//Returns true if @p unit can be cloaked by @p cloaker.
+	bool canBeCloakedBy(const CUnit *cloaker, const CUnit *unit) {
+		//Don't cloak fellow Arbiters and Nukes
+		if (unit->id == UnitId::arbiter
+			|| unit->id == UnitId::danimoth
+			|| unit->id == UnitId::nuclear_missile)
+			return false;
+
+		//Don't cloak buildings and doodad units (?)
+		if (units_dat::BaseProperty[unit->id] & (UnitProperty::Building | UnitProperty::NeutralAccessories))
+			return false;
+
+		//Don't cloak hallucinations
+		if (unit->status & UnitStatus::IsHallucination)
+			return false;
+
+		//Not sure. Perhaps to prevent warping-in units and buildings from being cloaked?
+		if (unit->mainOrderId == OrderId::Warpin)
+			return false;
+
+		//Only cloak units owned by the same player
+		if (cloaker->playerId != unit->playerId)
+			return false;
+
+		return true;
+	}
+
+	//Cloaks @p unit. Returns true if the console needs to be refreshed.
+	bool cloakUnit(CUnit *unit) {
+		bool needsRefresh = secondaryOrder_Cloak(unit);
+
+		//Remove energy cost for units that use energy to cloak
+		if (!(unit->status & UnitStatus::CloakingForFree)) {
+			unit->status |= UnitStatus::CloakingForFree;
+			needsRefresh = true;
+		}
+
+		return needsRefresh;
+	}
+
+	int cloakingFieldAura = -1;
+
 } //unnamed namespace
 
 namespace hooks {
 
 	//Cloak all units near @p cloaker.
 	void cloakNearbyUnitsHook(CUnit *cloaker) {
+		GPTP_PROFILE_HOOK(CloakNearbyUnits);
 		//Default StarCraft behavior
 
+		if (cloakingFieldAura < 0)
+			cloakingFieldAura = scbw::auraEngine.addAura(canBeCloakedBy, cloakUnit);
+
 		//Use the unit's air weapon range
 		u32 cloakRadius = cloaker->getMaxWeaponRange(cloaker->getAirWeapon());
 
-		//Run the unit finder
-		scbw::UnitFinder unitsToCloak(
-			cloaker->getX() - cloakRadius, cloaker->getY() - cloakRadius,
-			cloaker->getX() + cloakRadius, cloaker->getY() + cloakRadius);
-
-		bool needsRefresh = false;
-
-		unitsToCloak.forEach([cloaker, cloakRadius, &needsRefresh](CUnit* unit) {
-			//Don't cloak fellow Arbiters and Nukes
-			if (unit->id == UnitId::arbiter
-				|| unit->id == UnitId::danimoth
-				|| unit->id == UnitId::nuclear_missile)
-				return;
-
-			//Don't cloak buildings and doodad units (?)
-			if (units_dat::BaseProperty[unit->id] & (UnitProperty::Building | UnitProperty::NeutralAccessories))
-				return;
-
-			//Don't cloak hallucinations
-			if (unit->status & UnitStatus::IsHallucination)
-				return;
-
-			//Not sure. Perhaps to prevent warping-in units and buildings from being cloaked?
-			if (unit->mainOrderId == OrderId::Warpin)
-				return;
-
-			//Only cloak units owned by the same player
-			if (cloaker->playerId != unit->playerId)
-				return;
-
-			//Distance check
-			if (cloaker->getDistanceToTarget(unit) <= cloakRadius) {
-				secondaryOrder_Cloak(unit);
-				//Remove energy cost for units that use energy to cloak
-				if (!(unit->status & UnitStatus::CloakingForFree)) {
-					unit->status |= UnitStatus::CloakingForFree;
-					needsRefresh = true;
-				}
-			}
-		});
-
-		if (needsRefresh)
-			scbw::refreshConsole();
+		//Units covered by several cloakers are only cloaked once per frame, and
+		//the console is refreshed once per cloaker if needed.
+		scbw::auraEngine.emit(cloakingFieldAura, cloaker, cloakRadius);
 	}
 
 } //hooks
@@ -69,17 +76,18 @@ namespace hooks {
 
 namespace {
 
-	void secondaryOrder_Cloak(CUnit *unit) {
+	//Returns true if the console needs to be refreshed.
+	bool secondaryOrder_Cloak(CUnit *unit) {
 		CUnit** const firstBurrowedUnit = (CUnit**)0x0063FF5C;
 
 		if (unit->isCloaked++)
-			return;
+			return false;
 
 		if (unit->status & UnitStatus::RequiresDetection)
-			return;
+			return false;
 
 		if (unit->burrow_link.next)
-			return;
+			return false;
 
 		unit->burrow_link.next = *firstBurrowedUnit;
 		unit->burrow_link.prev = nullptr;
@@ -87,7 +95,7 @@ namespace {
 			(*firstBurrowedUnit)->burrow_link.prev = unit;
 		*firstBurrowedUnit = unit;
 
-		scbw::refreshConsole();
+		return true;
 	}
 
 } //unnamed namespace
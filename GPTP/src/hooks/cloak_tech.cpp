@@ -1,12 +1,14 @@
 #include "cloak_tech.h"
 #include "../SCBW/enumerations/UnitId.h"
 #include "../SCBW/enumerations/TechId.h"
+#include "../profiler.h"
 
 namespace hooks {
 
 	//Returns the tech ID used by this unit for the cloaking spell.
 	//For the cloaking energy consumption, see energy_regeneration.cpp
 	u8 getCloakingTech(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(GetCloakingTech);
 		//Default StarCraft behavior
 
 		if (unit->id == UnitId::ghost
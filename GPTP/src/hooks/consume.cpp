@@ -8,6 +8,7 @@
 #include <SCBW/enumerations.h>
 #include "tech_target_check.h"
 #include <algorithm>
+#include <profiler.h>
 
 //-------- Helper function declarations. Do NOT modify! --------//
 namespace {
@@ -20,6 +21,7 @@ namespace hooks {
 
 	/// This function is called when a @p target is consumed by the @p caster.
 	void consumeHitHook(CUnit *target, CUnit* caster) {
+		GPTP_PROFILE_HOOK(ConsumeHit);
 		//Default StarCraft behavior
 
 		//Don't proceed if the target does not exist.
@@ -2,31 +2,14 @@
 #include "consume.h"
 #include <hook_tools.h>
 
-namespace {
-
-	void __declspec(naked) consumeHitWrapper() {
-		static CUnit *target, *caster;
-
-		__asm {
-			PUSHAD
-				MOV caster, ESI
-				MOV target, EAX
-		}
-
-		hooks::consumeHitHook(target, caster);
-
-		__asm {
-			POPAD
-				RETN
-		}
-	}
-
-} //Unnamed namespace
-
 namespace hooks {
 
 	void injectConsumeHooks() {
-		callPatch(consumeHitWrapper, 0x0048BB27);
+		using namespace GPTP::Register;
+
+		//Inject with callPatch(): target in EAX, caster in ESI
+		callPatch(createThunk(GPTP::ThunkSignature().arg(EAX).arg(ESI),
+			consumeHitHook), 0x0048BB27);
 	}
 
-} //hooks
\ No newline at end of file
+} //hooks
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "detector.h"
 #include "../SCBW/scbwdata.h"
 #include "../SCBW/enumerations.h"
+#include "../profiler.h"
 
 namespace hooks {
 
@@ -8,6 +9,7 @@ namespace hooks {
 	/// This affects CUnit::canDetect().
 	/// This overrides the EXE edit settings for Detectors in FireGraft.
 	bool unitCanDetectHook(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(UnitCanDetect);
 		//Default StarCraft behavior
 		return units_dat::BaseProperty[unit->id] & UnitProperty::Detector
 			&& unit->status & UnitStatus::Completed    // Is completed
@@ -15,27 +17,29 @@ namespace hooks {
 			&& !unit->isBlind;
 	}
 
+	/// Returns the distance (in pixels) at which a detector can see cloaked and
+	/// burrowed units.
+	u32 getDetectionRange(const CUnit *unit) {
+		//Default StarCraft behavior
+		if (unit->status & UnitStatus::GroundedBuilding)
+			return 224;
+		else
+			return 32 * unit->getSightRange();
+	}
+
 	//Check if the @p unit can see the @p target (assuming target is cloaked).
 	u32 getCloakedTargetVisibility(const CUnit *unit, const CUnit* target) {
+		GPTP_PROFILE_HOOK(GetCloakedTargetVisibility);
 		//Default StarCraft behavior
 		if (target->status & UnitStatus::IsHallucination)
 			return 0;
 
-		if (unit->canDetect() && unit != target) {
-			if (target->sprite->isVisibleTo(unit->playerId)) {
-				u32 detectionRange;
-
-				if (unit->status & UnitStatus::GroundedBuilding)
-					detectionRange = 224;
-				else
-					detectionRange = 32 * unit->getSightRange();
-
-				if (unit->getDistanceToTarget(target) <= detectionRange)
-					return ((1 << unit->playerId) | playerVision->flags[unit->playerId] | unit->parasiteFlags);
-			}
-		}
-
-		return 0;
+		//If @p unit can detect, is not the @p target, @p target is visible to
+		//the owner of @p unit, and @p target is within getDetectionRange(unit),
+		//returns ((1 << unit->playerId) | playerVision->flags[unit->playerId] | unit->parasiteFlags).
+		//Uses the detection map in detector_util.cpp, so that the detectors do
+		//not have to be measured against each cloaked unit.
+		return getDetectorVisibility(unit, target);
 	}
 
 } //hooks
\ No newline at end of file
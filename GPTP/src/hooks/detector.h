@@ -4,8 +4,15 @@
 namespace hooks {
 
 	bool unitCanDetectHook(const CUnit *unit);
+	u32 getDetectionRange(const CUnit *unit);
 	u32 getCloakedTargetVisibility(const CUnit *unit, const CUnit* target);
 
+	/// Helpers defined in detector_util.cpp. The detection map is rebuilt once
+	/// per frame, using unitCanDetectHook() and getDetectionRange().
+	/// Call resetDetectionMap() in gameOn().
+	void resetDetectionMap();
+	u32 getDetectorVisibility(const CUnit *unit, const CUnit *target);
+
 	void injectDetectorHooks();
 
 } //hooks
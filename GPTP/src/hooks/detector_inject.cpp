@@ -5,26 +5,6 @@ extern const u32 Func_CanDetect;  //Defined in CUnit.cpp
 
 namespace {
 
-	//Inject with jmpPatch()
-	void __declspec(naked) unitCanDetectWrapper() {
-		static CUnit *unit;
-		static u32 result;
-
-		__asm {
-			PUSHAD
-				MOV EBP, ESP
-				MOV unit, EAX
-		}
-
-		result = hooks::unitCanDetectHook(unit) ? 1 : 0;
-
-		__asm {
-			POPAD
-				MOV EAX, result
-				RETN
-		}
-	}
-
 	struct DetectorCheckParam {
 		u32 visionFlags;
 		CUnit *target;
@@ -42,7 +22,12 @@ namespace {
 namespace hooks {
 
 	void injectDetectorHooks() {
-		jmpPatch(unitCanDetectWrapper, Func_CanDetect);
+		using namespace GPTP::Register;
+
+		//Inject with jmpPatch(): unit in EAX
+		jmpPatch(createThunk(GPTP::ThunkSignature().arg(EAX).returns(1),
+			unitCanDetectHook), Func_CanDetect);
+
 		memoryPatch(0x0044118E, &getCloakedTargetVisibilityWrapper);
 		memoryPatch(0x004411A6, &getCloakedTargetVisibilityWrapper);
 	}
@@ -0,0 +1,285 @@
+//All functions in this file are meant to be hook helpers for detector.h.
+//Do NOT modify any functions in this file!
+
+#include "detector.h"
+#include "../SCBW/api.h"
+#include "../SCBW/scbwdata.h"
+#include <algorithm>
+#include <cstring>
+
+//-------- Detection map --------//
+
+//Instead of measuring the distance between every detector and every cloaked
+//unit, the detection ranges of all detectors are drawn once per frame into a
+//map of 32x32 pixel cells for each player:
+//
+//  fullCoverage: every unit centered in the cell is in range of a detector
+//  nearCoverage: a unit centered in the cell may be in range of a detector
+//
+//Cells in nearCoverage but not in fullCoverage (the edges of the detection
+//ranges) fall back to checking the distance to each of the player's detectors.
+
+namespace {
+
+	const int MAP_SIZE = 256;				//Largest map size, in tiles
+	const int MAP_WORDS = MAP_SIZE / 32;
+	const int UNIT_WORDS = (UNIT_ARRAY_LENGTH + 1 + 31) / 32;
+
+	typedef u32 CoverageMap[MAP_SIZE][MAP_WORDS];
+
+	struct Detector {
+		const CUnit *unit;
+		s16 left, top, right, bottom;		//Bounds used for distance checks
+		u32 range;
+	};
+
+	CoverageMap fullCoverage[PLAYER_COUNT];
+	CoverageMap nearCoverage[PLAYER_COUNT];
+	u32 coveredPlayers;						//Players whose maps are not empty
+
+	//Detectors sorted by owner
+	Detector detectors[UNIT_ARRAY_LENGTH];
+	int firstDetector[PLAYER_COUNT + 1];
+	u32 isDetector[UNIT_WORDS];				//Bit set for each unit in detectors
+
+	//Detectors that give vision to other players through Parasite
+	const Detector *parasitedDetectors[UNIT_ARRAY_LENGTH];
+	int parasitedDetectorCount;
+
+	//Largest distance from the center to the edge of any unit type
+	int maxUnitExtent;
+
+	bool isBuilt;
+	u32 builtFrame;
+
+	//Visibility of each target, computed once per frame
+	struct TargetVisibility {
+		u32 frame;
+		u32 flags;
+		bool isValid;
+	};
+
+	TargetVisibility targetVisibility[UNIT_ARRAY_LENGTH + 1];
+
+	inline bool testBit(const u32 *words, int index) {
+		return (words[index / 32] & (1u << (index % 32))) != 0;
+	}
+
+	inline void setBit(u32 (&map)[MAP_SIZE][MAP_WORDS], int tileX, int tileY) {
+		map[tileY][tileX / 32] |= 1u << (tileX % 32);
+	}
+
+	//Never less than scbw::getDistanceFast(0, 0, dx, dy), and never decreases
+	//when dx or dy grows
+	u32 getDistanceUpperBound(u32 dx, u32 dy) {
+		const u32 dMax = std::max(dx, dy), dMin = std::min(dx, dy);
+		return dMax + (dMin * 3 >> 3) + (dMin * 3 >> 8);
+	}
+
+	//Never more than scbw::getDistanceFast(0, 0, dx, dy), and never decreases
+	//when dx or dy grows
+	u32 getDistanceLowerBound(u32 dx, u32 dy) {
+		return std::max(dx, dy) * 59 >> 6;
+	}
+
+	//Distance along one axis between a detector spanning [low, high] and a
+	//point, as measured by CUnit::getDistanceToTarget()
+	inline s32 getGap(s32 low, s32 high, s32 point) {
+		if (low - point - 1 >= 0)
+			return low - point - 1;
+		return std::max(point - high - 1, 0);
+	}
+
+	//Smallest and largest getGap() for any point in [first, last]
+	void getGapRange(s32 low, s32 high, s32 first, s32 last, s32 &minGap, s32 &maxGap) {
+		const s32 firstGap = getGap(low, high, first), lastGap = getGap(low, high, last);
+		maxGap = std::max(firstGap, lastGap);
+
+		if (last < low - 1)
+			minGap = lastGap;
+		else if (first > high + 1)
+			minGap = firstGap;
+		else
+			minGap = 0;
+	}
+
+	void stampDetector(const Detector &detector, u8 playerId) {
+		const s32 reach = detector.range + maxUnitExtent + 1;
+		const int firstTileX = std::max((detector.left - reach) / 32, 0);
+		const int lastTileX = std::min((detector.right + reach) / 32, MAP_SIZE - 1);
+		const int firstTileY = std::max((detector.top - reach) / 32, 0);
+		const int lastTileY = std::min((detector.bottom + reach) / 32, MAP_SIZE - 1);
+
+		for (int tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+			s32 minGapY, maxGapY;
+			getGapRange(detector.top, detector.bottom, tileY * 32, tileY * 32 + 31, minGapY, maxGapY);
+
+			for (int tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+				s32 minGapX, maxGapX;
+				getGapRange(detector.left, detector.right, tileX * 32, tileX * 32 + 31, minGapX, maxGapX);
+
+				//The target's own size can only make the gaps smaller, by at
+				//most maxUnitExtent
+				const u32 nearDistance = getDistanceLowerBound(
+					std::max(minGapX - maxUnitExtent, 0), std::max(minGapY - maxUnitExtent, 0));
+				if (nearDistance > detector.range)
+					continue;
+
+				setBit(nearCoverage[playerId], tileX, tileY);
+				if (getDistanceUpperBound(maxGapX, maxGapY) <= detector.range)
+					setBit(fullCoverage[playerId], tileX, tileY);
+			}
+		}
+	}
+
+	//Same as CUnit::getDistanceToTarget() <= range
+	bool isInRange(const Detector &detector, const CUnit *target) {
+		s32 dx = detector.left - target->getRight() - 1;
+		if (dx < 0) {
+			dx = target->getLeft() - detector.right - 1;
+			if (dx < 0)
+				dx = 0;
+		}
+
+		s32 dy = detector.top - target->getBottom() - 1;
+		if (dy < 0) {
+			dy = target->getTop() - detector.bottom - 1;
+			if (dy < 0)
+				dy = 0;
+		}
+
+		return scbw::getDistanceFast(0, 0, dx, dy) <= detector.range;
+	}
+
+	void buildDetectionMap() {
+		for (int playerId = 0; playerId < PLAYER_COUNT; ++playerId) {
+			if (coveredPlayers & (1u << playerId)) {
+				std::memset(fullCoverage[playerId], 0, sizeof(CoverageMap));
+				std::memset(nearCoverage[playerId], 0, sizeof(CoverageMap));
+			}
+		}
+
+		coveredPlayers = 0;
+		std::memset(isDetector, 0, sizeof(isDetector));
+		parasitedDetectorCount = 0;
+
+		//Count the detectors of each player, then place them in player order
+		int detectorCount[PLAYER_COUNT] = {};
+		for (const CUnit *unit = *firstVisibleUnit; unit; unit = unit->link.next) {
+			if (unit->playerId < PLAYER_COUNT && hooks::unitCanDetectHook(unit)) {
+				detectorCount[unit->playerId]++;
+				isDetector[unit->getIndex() / 32] |= 1u << (unit->getIndex() % 32);
+			}
+		}
+
+		firstDetector[0] = 0;
+		for (int playerId = 0; playerId < PLAYER_COUNT; ++playerId)
+			firstDetector[playerId + 1] = firstDetector[playerId] + detectorCount[playerId];
+
+		int nextDetector[PLAYER_COUNT];
+		std::copy(firstDetector, firstDetector + PLAYER_COUNT, nextDetector);
+
+		for (const CUnit *unit = *firstVisibleUnit; unit; unit = unit->link.next) {
+			if (!testBit(isDetector, unit->getIndex()))
+				continue;
+
+			//Turrets measure distances from their base unit
+			const CUnit *base = unit->isSubunit() ? unit->subunit : unit;
+
+			Detector &detector = detectors[nextDetector[unit->playerId]++];
+			detector.unit = unit;
+			detector.left = base->getLeft();
+			detector.top = base->getTop();
+			detector.right = base->getRight();
+			detector.bottom = base->getBottom();
+			detector.range = hooks::getDetectionRange(unit);
+
+			stampDetector(detector, unit->playerId);
+			coveredPlayers |= 1u << unit->playerId;
+
+			if (unit->parasiteFlags)
+				parasitedDetectors[parasitedDetectorCount++] = &detector;
+		}
+
+		builtFrame = *elapsedTimeFrames;
+		isBuilt = true;
+	}
+
+	bool isDetectedBy(u8 playerId, const CUnit *target) {
+		for (int i = firstDetector[playerId]; i < firstDetector[playerId + 1]; ++i) {
+			if (detectors[i].unit != target && isInRange(detectors[i], target))
+				return true;
+		}
+		return false;
+	}
+
+	//Returns the vision flags of all players whose detectors can see @p target.
+	u32 getTargetVisibility(const CUnit *target) {
+		const int tileX = std::min(std::max(target->getX() / 32, 0), MAP_SIZE - 1);
+		const int tileY = std::min(std::max(target->getY() / 32, 0), MAP_SIZE - 1);
+		const u32 tileBit = 1u << (tileX % 32);
+		const bool isTargetDetector = testBit(isDetector, target->getIndex());
+
+		u32 flags = 0;
+		for (u8 playerId = 0; playerId < PLAYER_COUNT; ++playerId) {
+			if (!(coveredPlayers & (1u << playerId))
+				|| !(nearCoverage[playerId][tileY][tileX / 32] & tileBit)
+				|| !target->sprite->isVisibleTo(playerId))
+				continue;
+
+			//A detector does not detect itself
+			const bool isFullyCovered = (fullCoverage[playerId][tileY][tileX / 32] & tileBit)
+				&& !(isTargetDetector && target->playerId == playerId);
+
+			if (isFullyCovered || isDetectedBy(playerId, target))
+				flags |= (1 << playerId) | playerVision->flags[playerId];
+		}
+
+		for (int i = 0; i < parasitedDetectorCount; ++i) {
+			const Detector &detector = *parasitedDetectors[i];
+			if (detector.unit != target
+				&& target->sprite->isVisibleTo(detector.unit->playerId)
+				&& isInRange(detector, target))
+				flags |= detector.unit->parasiteFlags;
+		}
+
+		return flags;
+	}
+
+} //unnamed namespace
+
+namespace hooks {
+
+	void resetDetectionMap() {
+		maxUnitExtent = 0;
+		for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+			const Box16 &bounds = units_dat::UnitBounds[unitId];
+			maxUnitExtent = std::max<int>(maxUnitExtent,
+				std::max(std::max(bounds.left, bounds.right), std::max(bounds.top, bounds.bottom)));
+		}
+
+		for (int i = 0; i <= UNIT_ARRAY_LENGTH; ++i)
+			targetVisibility[i].isValid = false;
+
+		isBuilt = false;
+	}
+
+	u32 getDetectorVisibility(const CUnit *unit, const CUnit *target) {
+		if (!isBuilt || builtFrame != *elapsedTimeFrames)
+			buildDetectionMap();
+
+		if (unit == target || !testBit(isDetector, unit->getIndex()))
+			return 0;
+
+		TargetVisibility &visibility = targetVisibility[target->getIndex()];
+		if (!visibility.isValid || visibility.frame != builtFrame) {
+			visibility.flags = getTargetVisibility(target);
+			visibility.frame = builtFrame;
+			visibility.isValid = true;
+		}
+
+		return visibility.flags
+			& ((1 << unit->playerId) | playerVision->flags[unit->playerId] | unit->parasiteFlags);
+	}
+
+} //hooks
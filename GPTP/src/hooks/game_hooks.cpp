@@ -3,19 +3,52 @@
 #include "game_hooks.h"
 #include <graphics/graphics.h>
 #include <SCBW/api.h>
+#include <SCBW/AuraEngine.h>
 #include <SCBW/scbwdata.h>
+#include <SCBW/SpatialGrid.h>
+#include <SCBW/TargetingTables.h>
+#include <SCBW/TypeInfoCache.h>
+#include <SCBW/UnitEventBus.h>
+#include <SCBW/UnitRegistry.h>
+#include <SCBW/UnitSnapshot.h>
+#include <SCBW/UnitTaskScheduler.h>
 #include <SCBW/ExtendSightLimit.h>
+#include "detector.h"
 #include "psi_field.h"
 #include <cstdio>
+#include <profiler.h>
 
 
 namespace hooks {
 
 	/// This hook is called every frame; most of your plugin's logic goes here.
 	bool nextFrame() {
+		GPTP_PROFILE_HOOK(NextFrame);
 		if (!scbw::isGamePaused()) { //If the game is not paused
 			scbw::setInGameLoopState(true); //Needed for scbw::random() to work
 			graphics::resetAllGraphics();
+			GPTP_PROFILE_DRAW_OVERLAY();
+
+			//Picks up any changes plugins made to the DAT arrays; the
+			//targeting tables follow at their next lookup
+			scbw::typeInfoCache.build();
+
+			scbw::spatialGrid.build();
+
+#ifndef NDEBUG
+			//Before sync(), which would hide units that died without being removed
+			if (!scbw::unitRegistry.verify())
+				scbw::printText(PLUGIN_NAME ": UnitRegistry holds dead units or is inconsistent!");
+#endif
+
+			scbw::unitRegistry.sync();
+
+			//Lets every unit receive each aura again in this frame
+			scbw::auraEngine.beginFrame();
+
+			//Delivers the unit events of the last frame (see SCBW/UnitEventBus.h)
+			scbw::unitEventBus.dispatch();
+
 			hooks::updatePsiFieldProviders();
 
 			//This block is executed once every game.
@@ -29,12 +62,26 @@ namespace hooks {
 				//Write your code here
 			}
 
+			//Per-unit logic that does not need to run every frame should be
+			//registered with scbw::unitTaskScheduler.addTask() instead.
+			scbw::unitTaskScheduler.run(*elapsedTimeFrames);
+
 			scbw::setInGameLoopState(false);
 		}
 		return true;
 	}
 
 	bool gameOn() {
+		scbw::typeInfoCache.build();
+		scbw::targetingTables.build();
+		scbw::spatialGrid.clear();
+		scbw::unitSnapshot.clear();
+		scbw::unitRegistry.clear();
+		scbw::unitEventBus.clear();
+		scbw::auraEngine.reset();
+		scbw::unitTaskScheduler.reset();
+		hooks::resetPsiFieldCoverage();
+		hooks::resetDetectionMap();
 		return true;
 	}
 
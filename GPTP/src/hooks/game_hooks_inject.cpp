@@ -2,6 +2,8 @@
 #include <SCBW/api.h>
 #include <hook_tools.h>
 #include <logger.h>
+#include <binary_logger.h>
+#include <profiler.h>
 
 bool isGameOn = false;
 
@@ -16,6 +18,9 @@ void __declspec(naked) onGameStart() { // From BWAPI by Kovarex, slightly modifi
 		isGameOn = true;
 		hooks::gameOn();
 		GPTP::logger.startGame();
+		GPTP_BLOG_START_GAME();
+		GPTP_PROFILE_START_GAME();
+		GPTP_TRACE_START_GAME();
 	}
 	__asm {
 		POPAD
@@ -33,6 +38,9 @@ void __declspec(naked) onGameEnd() { // From BWAPI by Kovarex, slightly modified
 		isGameOn = false;
 		hooks::gameEnd();
 		GPTP::logger.endGame();
+		GPTP_BLOG_END_GAME();
+		GPTP_PROFILE_END_GAME();
+		GPTP_TRACE_END_GAME();
 	}
 	__asm {
 		POPAD
@@ -49,6 +57,7 @@ void __declspec(naked) nextFrameHook() { // From BWAPI by Kovarex, slightly modi
 			MOV EBP, ESP
 	}
 	{
+		GPTP_PROFILE_END_FRAME();
 		hooks::nextFrame();
 	}
 
@@ -1,6 +1,7 @@
 #include "harvest.h"
 #include "../SCBW/enumerations.h"
 #include "../SCBW/api.h"
+#include "../profiler.h"
 
 //Helper functions
 void updateMineralPatchImage(CUnit *mineralPatch);
@@ -43,6 +44,7 @@ namespace hooks {
 
 	//Transfers a set amount of resources from a resource patch to a worker.
 	void transferResourceToWorkerHook(CUnit *worker, CUnit *resource) {
+		GPTP_PROFILE_HOOK(TransferResourceToWorker);
 		//Default StarCraft behavior
 
 		u32 chunkImageId;
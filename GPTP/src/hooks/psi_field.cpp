@@ -1,10 +1,12 @@
 #include "psi_field.h"
 #include "../SCBW/scbwdata.h"
+#include "../profiler.h"
 
 namespace hooks {
 
 	//Check if the given unit id can generate psi fields
 	bool canMakePsiField(u16 unitId) {
+		GPTP_PROFILE_HOOK(CanMakePsiField);
 		//Default StarCraft behavior
 		if (unitId == UnitId::pylon)
 			return true;
@@ -13,6 +15,7 @@ namespace hooks {
 
 	//Actual state check whether a unit can generate a psi field
 	bool isReadyToMakePsiField(CUnit *unit) {
+		GPTP_PROFILE_HOOK(IsReadyToMakePsiField);
 		//Default StarCraft behavior
 
 		if (unit->id == UnitId::pylon)
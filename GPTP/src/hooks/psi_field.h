@@ -13,10 +13,23 @@ namespace hooks {
 	bool isReadyToMakePsiField(CUnit *unit);
 	bool canMakePsiField(u16 unitId);
 
-	/// This function must be called once per frame in nextFrame().
+	/// This function must be called once per frame in nextFrame(), after
+	/// scbw::unitRegistry.sync().
 	/// This uses canMakePsiField() and isReadyToMakePsiField() internally.
 	void updatePsiFieldProviders();
 
+	/// Clears the psi field coverage, and finds the unit types that can make psi
+	/// fields. This function must be called in gameOn().
+	void resetPsiFieldCoverage();
+
+	/// Returns true if the position (@p x, @p y) (in pixels) is inside a psi
+	/// field of @p playerId. Positions are rounded down to a multiple of 16
+	/// pixels, so the answer is exact for the center of any building placed on
+	/// the tile grid.
+	/// The coverage is updated in updatePsiFieldProviders() and whenever a psi
+	/// provider is destroyed.
+	bool isPositionPowered(u8 playerId, int x, int y);
+
 	//Call this in initialize.h.
 	void injectPsiFieldHooks();
 
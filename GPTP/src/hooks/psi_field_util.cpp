@@ -3,8 +3,10 @@
 
 #include "psi_field.h"
 #include "../SCBW/scbwdata.h"
+#include "../SCBW/UnitRegistry.h"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 //-------- Unit id safeguard --------//
 
@@ -73,7 +75,6 @@ void addPsiField(CUnit *unit) {
 		(*firstPsiFieldProvider)->psi_link.prev = unit;
 	*firstPsiFieldProvider = unit;
 	addPsiFieldSprite(unit);
-	*canUpdatePoweredStatus = true;
 }
 
 
@@ -93,14 +94,20 @@ void removeFromPsiProviderList(CUnit *psiProvider) {
 	psiProvider->psi_link.next = nullptr;
 }
 
+bool updatePsiFieldCoverage();
+
 //Removes @p unit from the psi provider list and destroys the psi field sprite.
 void removePsiField(CUnit *unit) {
+	const bool wasProvider = *firstPsiFieldProvider == unit || unit->psi_link.next || unit->psi_link.prev;
+
 	if (unit->building.pylonAura) {
 		unit->building.pylonAura->free();
 		unit->building.pylonAura = nullptr;
-		*canUpdatePoweredStatus = true;   //Might work?
 	}
 	removeFromPsiProviderList(unit);
+
+	if (wasProvider && updatePsiFieldCoverage())
+		*canUpdatePoweredStatus = true;
 }
 
 //-------- Update psi field position --------//
@@ -126,10 +133,138 @@ void updatePsiFieldPosition(const CUnit *unit) {
 
 		psiField->setPosition(unit->getX(), unit->getY());
 		refreshSpriteData(psiField);
-		*canUpdatePoweredStatus = true;
 	}
 }
 
+//-------- Psi field coverage --------//
+
+namespace {
+
+	//Buildings placed on the tile grid have their centers on multiples of 16
+	//pixels (tile centers for odd sizes, tile corners for even sizes), so the
+	//coverage is sampled at every 16 pixels rather than once per tile.
+	const int CELL_SIZE = 16;
+	const int COVERAGE_SIZE = 256 * 32 / CELL_SIZE;	//Largest map size, in cells
+	const int COVERAGE_WORDS = COVERAGE_SIZE / 32;
+	const int PROVIDER_WORDS = (UNIT_ARRAY_LENGTH + 1 + 31) / 32;
+
+	//One bit per cell, set if the top left corner of the cell is inside a psi field
+	typedef u32 CoverageMap[COVERAGE_SIZE][COVERAGE_WORDS];
+
+	//Shape of a psi field, in 32x32 pixel cells around the provider
+	//(256 pixels to each side, 160 pixels up and down)
+	const bool psiFieldMask[10][16] = {
+		{ 0,0,0,0,0,1,1,1,1,1,1,0,0,0,0,0 },
+		{ 0,0,1,1,1,1,1,1,1,1,1,1,1,1,0,0 },
+		{ 0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0 },
+		{ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },
+		{ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },
+		{ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },
+		{ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },
+		{ 0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0 },
+		{ 0,0,1,1,1,1,1,1,1,1,1,1,1,1,0,0 },
+		{ 0,0,0,0,0,1,1,1,1,1,1,0,0,0,0,0 },
+	};
+
+	CoverageMap coverage[PLAYER_COUNT];
+	CoverageMap newCoverage;
+
+	//Owner and position of each psi provider when the coverage was last built
+	struct ProviderState {
+		u8 playerId;
+		u16 x, y;
+	};
+
+	ProviderState providerStates[UNIT_ARRAY_LENGTH + 1];
+	u32 stampedProviders[PROVIDER_WORDS];	//Bit set for each unit in providerStates
+
+	//Unit types for which hooks::canMakePsiField() returns true
+	u16 providerTypes[UNIT_TYPE_COUNT];
+	int providerTypeCount = 0;
+
+	//Adds the psi field of a provider at (@p x, @p y) to @p map.
+	//Uses the same bounds as the power check of buildings in StarCraft.
+	void stampPsiField(CoverageMap &map, int x, int y) {
+		const int firstCellX = std::max((x - 256) / CELL_SIZE, 0);
+		const int lastCellX = std::min((x + 256) / CELL_SIZE, COVERAGE_SIZE - 1);
+		const int firstCellY = std::max((y - 160) / CELL_SIZE, 0);
+		const int lastCellY = std::min((y + 160) / CELL_SIZE, COVERAGE_SIZE - 1);
+
+		for (int cellY = firstCellY; cellY <= lastCellY; ++cellY) {
+			const int dy = cellY * CELL_SIZE - y;
+			if (dy < -160 || dy >= 160)
+				continue;
+
+			const bool *maskRow = psiFieldMask[(dy + 160) / 32];
+			for (int cellX = firstCellX; cellX <= lastCellX; ++cellX) {
+				const int dx = cellX * CELL_SIZE - x;
+				if (dx >= -256 && dx < 256 && maskRow[(dx + 256) / 32])
+					map[cellY][cellX / 32] |= 1u << (cellX % 32);
+			}
+		}
+	}
+
+} //unnamed namespace
+
+//Rebuilds the coverage maps of players whose psi providers have appeared,
+//disappeared, moved or changed owners since the last call.
+//Returns true if the coverage of any player has changed.
+bool updatePsiFieldCoverage() {
+	u32 seen[PROVIDER_WORDS] = {};
+	u32 dirtyPlayers = 0;
+
+	for (CUnit *unit = *firstPsiFieldProvider; unit; unit = unit->psi_link.next) {
+		const u16 index = unit->getIndex();
+		const u32 bit = 1u << (index % 32);
+		ProviderState &state = providerStates[index];
+		seen[index / 32] |= bit;
+
+		const bool isStamped = (stampedProviders[index / 32] & bit) != 0;
+		if (isStamped && state.playerId == unit->playerId
+			&& state.x == unit->getX() && state.y == unit->getY())
+			continue;
+
+		if (isStamped)
+			dirtyPlayers |= 1u << state.playerId;
+		dirtyPlayers |= 1u << unit->playerId;
+
+		state.playerId = unit->playerId;
+		state.x = unit->getX();
+		state.y = unit->getY();
+		stampedProviders[index / 32] |= bit;
+	}
+
+	//Providers that have left the list
+	for (int w = 0; w < PROVIDER_WORDS; ++w) {
+		u32 gone = stampedProviders[w] & ~seen[w];
+		stampedProviders[w] &= seen[w];
+
+		for (int bit = 0; gone; ++bit, gone >>= 1) {
+			if (gone & 1)
+				dirtyPlayers |= 1u << providerStates[w * 32 + bit].playerId;
+		}
+	}
+
+	bool hasChanged = false;
+	for (int playerId = 0; playerId < PLAYER_COUNT; ++playerId) {
+		if (!(dirtyPlayers & (1u << playerId)))
+			continue;
+
+		std::memset(newCoverage, 0, sizeof(newCoverage));
+		for (const CUnit *unit = *firstPsiFieldProvider; unit; unit = unit->psi_link.next) {
+			if (unit->playerId == playerId)
+				stampPsiField(newCoverage, unit->getX(), unit->getY());
+		}
+
+		if (std::memcmp(newCoverage, coverage[playerId], sizeof(newCoverage)) != 0) {
+			std::memcpy(coverage[playerId], newCoverage, sizeof(newCoverage));
+			hasChanged = true;
+		}
+	}
+
+	return hasChanged;
+}
+
 //-------- Update psi field provider --------//
 
 //Defined in psi_field_inject.cpp
@@ -137,11 +272,33 @@ void hideAllPsiFields();
 
 namespace hooks {
 
-	void updatePsiFieldProviders() {
-		for (CUnit *unit = *firstVisibleUnit; unit; unit = unit->link.next) {
-			if (hooks::canMakePsiField(unit->id)) {
-				assert(isValidPsiProviderType(unit->id));
+	void resetPsiFieldCoverage() {
+		std::memset(coverage, 0, sizeof(coverage));
+		std::memset(stampedProviders, 0, sizeof(stampedProviders));
 
+		providerTypeCount = 0;
+		for (u16 unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+			if (hooks::canMakePsiField(unitId)) {
+				assert(isValidPsiProviderType(unitId));
+				providerTypes[providerTypeCount++] = unitId;
+			}
+		}
+	}
+
+	bool isPositionPowered(u8 playerId, int x, int y) {
+		if (playerId >= PLAYER_COUNT || x < 0 || y < 0)
+			return false;
+
+		const int cellX = x / CELL_SIZE, cellY = y / CELL_SIZE;
+		if (cellX >= COVERAGE_SIZE || cellY >= COVERAGE_SIZE)
+			return false;
+
+		return (coverage[playerId][cellY][cellX / 32] & (1u << (cellX % 32))) != 0;
+	}
+
+	void updatePsiFieldProviders() {
+		for (int i = 0; i < providerTypeCount; ++i) {
+			scbw::unitRegistry.ofType(providerTypes[i]).forEach([](CUnit *unit) {
 				if (unit->status & UnitStatus::Completed) {
 					if (hooks::isReadyToMakePsiField(unit)) {
 						addPsiField(unit);
@@ -150,9 +307,13 @@ namespace hooks {
 					else
 						removePsiField(unit);
 				}
-			}
+			});
 		}
 
+		//Buildings only need to recheck their power if a psi field has changed
+		if (updatePsiFieldCoverage())
+			*canUpdatePoweredStatus = true;
+
 		if (!(*IS_PLACING_BUILDING)) {
 			for (int i = 0; i < 12 && i < *clientSelectionCount; ++i) {
 				CUnit *selUnit = clientSelectionGroup->unit[i];
@@ -4,6 +4,7 @@
 #include "../SCBW/scbwdata.h"
 #include "../SCBW/enumerations.h"
 #include "../SCBW/api.h"
+#include "../profiler.h"
 
 namespace hooks {
 
@@ -13,6 +14,7 @@ namespace hooks {
 	/// @param  unit      The unit that needs to receive rally orders.
 	/// @param  factory   The unit (building) that created the given unit.
 	void orderNewUnitToRally(CUnit* unit, CUnit* factory) {
+		GPTP_PROFILE_HOOK(OrderNewUnitToRally);
 		//Default StarCraft behavior
 
 		//Do nothing if the rally target is the factory itself or the rally target position is 0
@@ -27,6 +29,7 @@ namespace hooks {
 
 	/// Called when the player sets the rally point on the ground.
 	void setRallyPosition(CUnit *unit, u16 x, u16 y) {
+		GPTP_PROFILE_HOOK(SetRallyPosition);
 		//Default StarCraft behavior
 		unit->rally.unit = NULL;
 		unit->rally.pt.x = x;
@@ -35,6 +38,7 @@ namespace hooks {
 
 	/// Called when the player sets the rally point on a unit.
 	void setRallyUnit(CUnit *unit, CUnit *target) {
+		GPTP_PROFILE_HOOK(SetRallyUnit);
 		//Default StarCraft behavior
 		if (!target) target = unit;
 		unit->rally.unit = target;
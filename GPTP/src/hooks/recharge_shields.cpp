@@ -2,6 +2,7 @@
 #include "../SCBW/scbwdata.h"
 #include "../SCBW/enumerations.h"
 #include "../SCBW/api.h"
+#include "../profiler.h"
 
 //-------- Helper function declarations. Do NOT modify! --------//
 namespace {
@@ -48,6 +49,7 @@ namespace hooks {
 
 	/// Decides whether the @p target can recharge shields from the @p battery.
 	bool unitCanRechargeShieldsHook(const CUnit *target, const CUnit *battery) {
+		GPTP_PROFILE_HOOK(UnitCanRechargeShields);
 		//Default StarCraft behavior
 		using units_dat::ShieldsEnabled;
 		using units_dat::MaxShieldPoints;
@@ -85,6 +87,7 @@ namespace hooks {
 
 	//The order process run by a unit when recharging shields
 	void orderRechargeShieldsHook(CUnit *unit) {
+		GPTP_PROFILE_HOOK(OrderRechargeShields);
 		//Default StarCraft behavior
 
 		CUnit *battery = unit->orderTarget.unit;
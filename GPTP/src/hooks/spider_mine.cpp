@@ -2,12 +2,14 @@
 #include <SCBW/api.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/UnitFinder.h>
+#include <profiler.h>
 
 namespace hooks {
 
 	//Return the best target for the Spider Mine. If there is no suitable target,
 	//return NULL instead.
 	CUnit* findBestSpiderMineTargetHook(const CUnit *spiderMine) {
+		GPTP_PROFILE_HOOK(FindBestSpiderMineTarget);
 		//Default StarCraft behavior
 
 		//Don't search for a target if the spider mine is under a Disruption Web
@@ -44,6 +46,7 @@ namespace hooks {
 
 	//Return the initial burrowing delay time (in frames) for the Spider Mine.
 	u8 getSpiderMineBurrowTimeHook(const CUnit *spiderMine) {
+		GPTP_PROFILE_HOOK(GetSpiderMineBurrowTime);
 		//Default StarCraft behavior
 		return 60;
 	}
@@ -19,29 +19,16 @@ namespace {
 		}
 	}
 
-	void __declspec(naked) findBestSpiderMineTargetWrapper() {
-		static CUnit *spiderMine, *target;
-		__asm {
-			PUSHAD
-				MOV spiderMine, ESI
-		}
-
-		target = hooks::findBestSpiderMineTargetHook(spiderMine);
-
-		__asm {
-			POPAD
-				MOV EAX, target
-				RETN
-		}
-	}
-
 } //unnamed namespace
 
 namespace hooks {
 
 	void injectSpiderMineHooks() {
 		callPatch(getSpiderMineBurrowTimeWrapper, 0x00463E08, 3);
-		callPatch(findBestSpiderMineTargetWrapper, 0x00463E63);
+
+		//Inject with callPatch(): spider mine in ESI
+		callPatch(createThunk(GPTP::ThunkSignature().arg(GPTP::Register::ESI).returns(4),
+			findBestSpiderMineTargetHook), 0x00463E63);
 	}
 
 } //hooks
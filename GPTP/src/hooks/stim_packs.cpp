@@ -1,9 +1,11 @@
 #include "stim_packs.h"
 #include "../SCBW/api.h"
+#include "../profiler.h"
 
 namespace hooks {
 
 	void useStimPacksHook(CUnit *unit) {
+		GPTP_PROFILE_HOOK(UseStimPacks);
 		//Default StarCraft behavior
 		if (unit->hitPoints > 2560) {
 			scbw::playSound(scbw::randBetween(278, 279), unit);
@@ -16,6 +18,7 @@ namespace hooks {
 	}
 
 	bool canUseStimPacksHook(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(CanUseStimPacks);
 		//Default StarCraft behavior
 		return unit->hitPoints > 2560;
 	}
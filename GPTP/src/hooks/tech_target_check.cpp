@@ -2,6 +2,7 @@
 #include "tech_target_check.h"
 #include <SCBW/scbwdata.h>
 #include <SCBW/enumerations.h>
+#include <profiler.h>
 
 //-------- Helper function declarations. Do NOT modify! --------//
 namespace {
@@ -16,6 +17,7 @@ namespace hooks {
 	/// If successful, returns zero. If unsuccessful, returns the index of the
 	/// appropriate error message string in stat_txt.tbl.
 	u16 getTechUseErrorMessageHook(const CUnit *target, u8 castingPlayer, u16 techId) {
+		GPTP_PROFILE_HOOK(GetTechUseErrorMessage);
 		//Default StarCraft behavior
 
 		if (target->stasisTimer)
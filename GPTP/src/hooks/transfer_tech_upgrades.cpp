@@ -4,6 +4,7 @@
 #include "transfer_tech_upgrades.h"
 #include "apply_upgrade_flags.h"
 #include <SCBW/api.h>
+#include <profiler.h>
 
 namespace {
 
@@ -89,6 +90,7 @@ namespace hooks {
 
 	//Transfers all tech related to the @p source unit to @p targetPlayerId.
 	void transferUnitTechToPlayerHook(const CUnit *source, u8 targetPlayerId) {
+		GPTP_PROFILE_HOOK(TransferUnitTechToPlayer);
 		//Default StarCraft behavior
 
 		//Stop if the source unit does not exist
@@ -115,6 +117,7 @@ namespace hooks {
 
 	//Transfers all upgrades related to the @p source unit to @p targetPlayerId.
 	void transferUnitUpgradesToPlayerHook(const CUnit *source, u8 targetPlayerId) {
+		GPTP_PROFILE_HOOK(TransferUnitUpgradesToPlayer);
 		//Default StarCraft behavior
 
 		//Stop if the source unit does not exist
@@ -141,6 +144,7 @@ namespace hooks {
 
 	//Transfers all upgrade flags related to the @p unit to the unit's owner.
 	void applyUnitUpgradeFlagsToAllFriendlyUnitsHook(CUnit *unit) {
+		GPTP_PROFILE_HOOK(ApplyUnitUpgradeFlagsToAllFriendlyUnits);
 		//Default StarCraft behavior
 
 		//Stop if the source unit does not exist
@@ -1,6 +1,7 @@
 //Injector source file for the Transfer Tech & Upgrades hook module.
 #include "transfer_tech_upgrades.h"
 #include <hook_tools.h>
+#include <SCBW/UnitEventBus.h>
 
 namespace {
 
@@ -15,6 +16,9 @@ namespace {
 				MOV EBP, ESP
 		}
 
+		//Called just before the unit changes owners
+		if (source)
+			scbw::unitEventBus.changeOwner(source, targetPlayerId);
 		hooks::transferUnitTechToPlayerHook(source, targetPlayerId);
 
 		__asm {
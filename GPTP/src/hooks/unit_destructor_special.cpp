@@ -5,7 +5,10 @@
 #include "../SCBW/api.h"
 #include "psi_field.h"
 #include "../hook_tools.h"
+#include "../SCBW/UnitEventBus.h"
+#include "../SCBW/UnitRegistry.h"
 #include <algorithm>
+#include "../profiler.h"
 
 void killAllHangarUnits(CUnit *unit) {
 	while (unit->carrier.inHangarCount--) {
@@ -59,6 +62,10 @@ void freeResourceContainer(CUnit *resource) {
 void removePsiField(CUnit *unit);
 
 void unitDestructorSpecialHook(CUnit *unit) {
+	GPTP_PROFILE_HOOK(UnitDestructorSpecial);
+	scbw::unitRegistry.remove(unit);
+	scbw::unitEventBus.remove(unit);
+
 	//Destroy interceptors and scarabs
 	if (unit->id == UnitId::carrier || unit->id == UnitId::gantrithor
 		|| unit->id == UnitId::reaver || unit->id == UnitId::warbringer
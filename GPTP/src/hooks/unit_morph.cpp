@@ -3,11 +3,13 @@
 #include <SCBW/enumerations/TechId.h>
 #include <SCBW/api.h>
 #include <cassert>
+#include <profiler.h>
 
 namespace hooks {
 
 	//Check if @p unit can morph into @p morphUnitId.
 	bool unitCanMorphHook(const CUnit *unit, u16 morphUnitId) {
+		GPTP_PROFILE_HOOK(UnitCanMorph);
 		//Default StarCraft behavior
 
 		if (unit->id == UnitId::hydralisk) {
@@ -28,6 +30,7 @@ namespace hooks {
 
 	//Check if @p unitId is an egg unit.
 	bool isEggUnitHook(u16 unitId) {
+		GPTP_PROFILE_HOOK(IsEggUnit);
 		//Default StarCraft behavior
 
 		if (unitId == UnitId::egg
@@ -40,6 +43,7 @@ namespace hooks {
 
 	//Check if @p unitId is an egg unit that can be rallied
 	bool isRallyableEggUnitHook(u16 unitId) {
+		GPTP_PROFILE_HOOK(IsRallyableEggUnit);
 		//Default StarCraft behavior
 
 		if (unitId == UnitId::cocoon || unitId == UnitId::lurker_egg)
@@ -51,6 +55,7 @@ namespace hooks {
 	//Return the ID of the egg unit to use when morphing @p unitId.
 	//If the unit cannot morph, return UnitId::None.
 	u16 getUnitMorphEggTypeHook(u16 unitId) {
+		GPTP_PROFILE_HOOK(GetUnitMorphEggType);
 		//Default StarCraft behavior
 
 		if (unitId == UnitId::larva)
@@ -68,6 +73,7 @@ namespace hooks {
 	//Determine the type (unit ID) of the unit to revert to when cancelling an
 	//@p eggUnit while it is morphing.
 	u16 getCancelMorphRevertTypeHook(const CUnit *eggUnit) {
+		GPTP_PROFILE_HOOK(GetCancelMorphRevertType);
 		//Default StarCraft behavior
 
 		if (eggUnit->id == UnitId::cocoon)
@@ -82,6 +88,7 @@ namespace hooks {
 	//Determines the vertical (Y) offset by which the @p unit will be shifted to
 	//when it finishes morphing.
 	s16 getUnitVerticalOffsetOnBirth(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(GetUnitVerticalOffsetOnBirth);
 		//Default StarCraft behavior
 
 		//No offset, birth offset is handled elsewhere
@@ -107,6 +114,7 @@ namespace hooks {
 
 	//Check if @p playerId has enough supplies to build @p unitId.
 	bool hasSuppliesForUnitHook(u8 playerId, u16 unitId, bool canShowErrorMessage) {
+		GPTP_PROFILE_HOOK(HasSuppliesForUnit);
 		//Default StarCraft behavior
 		s32 supplyCost = units_dat::SupplyRequired[unitId];
 
@@ -1,6 +1,8 @@
 #include "unit_morph.h"
 #include <hook_tools.h>
 #include <SCBW/api.h>
+#include <SCBW/UnitEventBus.h>
+#include <SCBW/UnitRegistry.h>
 #include <cassert>
 
 namespace {
@@ -195,6 +197,8 @@ namespace {
 		}
 		else {
 			changeUnitType(unit, cancelChangeUnitId);
+			scbw::unitRegistry.update(unit);
+			scbw::unitEventBus.update(unit);
 			unit->remainingBuildTime = 0;
 			unit->buildQueue[unit->buildQueueSlot] = UnitId::None;
 			replaceSpriteImages(unit->sprite,
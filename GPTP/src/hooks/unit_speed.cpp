@@ -3,6 +3,7 @@
 #include "unit_speed.h"
 #include "../SCBW/enumerations.h"
 #include "../SCBW/scbwdata.h"
+#include "../profiler.h"
 
 namespace hooks {
 
@@ -10,6 +11,7 @@ namespace hooks {
 	///
 	/// @return		The modified speed value.
 	u32 getModifiedUnitSpeedHook(const CUnit* unit, u32 baseSpeed) {
+		GPTP_PROFILE_HOOK(GetModifiedUnitSpeed);
 		//Default StarCraft behavior
 		u32 speed = baseSpeed;
 		int speedModifier = (unit->stimTimer ? 1 : 0) - (unit->ensnareTimer ? 1 : 0)
@@ -32,6 +34,7 @@ namespace hooks {
 	///
 	/// @return		The modified acceleration value.
 	u32 getModifiedUnitAccelerationHook(const CUnit* unit) {
+		GPTP_PROFILE_HOOK(GetModifiedUnitAcceleration);
 		//Default StarCraft behavior
 		u32 acceleration = flingy_dat::Acceleration[units_dat::Graphic[unit->id]];
 		int modifier = (unit->stimTimer ? 1 : 0) - (unit->ensnareTimer ? 1 : 0)
@@ -47,6 +50,7 @@ namespace hooks {
 	///
 	/// @return		The modified turning speed value.
 	u32 getModifiedUnitTurnSpeedHook(const CUnit* unit) {
+		GPTP_PROFILE_HOOK(GetModifiedUnitTurnSpeed);
 		//Default StarCraft behavior
 		u32 turnSpeed = flingy_dat::TurnSpeed[units_dat::Graphic[unit->id]];
 		int modifier = (unit->stimTimer ? 1 : 0) - (unit->ensnareTimer ? 1 : 0)
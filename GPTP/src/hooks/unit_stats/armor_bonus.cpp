@@ -2,11 +2,13 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
+#include <profiler.h>
 
 namespace hooks {
 
 	/// Returns the bonus armor for this unit.
 	u8 getArmorBonusHook(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(GetArmorBonus);
 		//Default StarCraft behavior
 		using scbw::getUpgradeLevel;
 
@@ -3,34 +3,14 @@
 
 extern const u32 Func_GetArmorBonus;  //Defined in CUnit.cpp
 
-namespace {
-
-	//Inject with jmpPatch()
-	void __declspec(naked) getArmorBonusWrapper() {
-		CUnit *unit;
-		u8 armor;
-		__asm {
-			PUSHAD
-				MOV EBP, ESP
-				MOV unit, EAX
-		}
-
-		armor = hooks::getArmorBonusHook(unit);
-
-		__asm {
-			MOVZX EAX, armor
-				MOV[ESP + 28], EAX
-				POPAD
-				RETN
-		}
-	}
-
-} //unnamed namespace
-
 namespace hooks {
 
 	void injectArmorBonusHook() {
-		jmpPatch(getArmorBonusWrapper, Func_GetArmorBonus);
+		using namespace GPTP::Register;
+
+		//Inject with jmpPatch(): unit in EAX
+		jmpPatch(createThunk(GPTP::ThunkSignature().arg(EAX).returns(1),
+			getArmorBonusHook), Func_GetArmorBonus);
 	}
 
 } //hooks
@@ -2,6 +2,7 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
+#include <profiler.h>
 
 namespace hooks {
 
@@ -9,6 +10,7 @@ namespace hooks {
 	/// Return the amount of maximum energy that a unit can have.
 	/// Note: 1 energy displayed in-game equals 256 energy.
 	u16 getUnitMaxEnergyHook(const CUnit* const unit) {
+		GPTP_PROFILE_HOOK(GetUnitMaxEnergy);
 		//Default StarCraft behavior
 		using scbw::getUpgradeLevel;
 		if (units_dat::BaseProperty[unit->id] & UnitProperty::Hero)
@@ -2,6 +2,7 @@
 #include <SCBW/enumerations.h>
 #include <SCBW/scbwdata.h>
 #include <SCBW/api.h>
+#include <profiler.h>
 
 namespace hooks {
 
@@ -10,6 +11,7 @@ namespace hooks {
 	/// and Hallucination (but not when launching Nukes).
 	/// Note: sight ranges cannot exceed 11, unless extended.
 	u32 getSightRangeHook(const CUnit *unit, bool isForSpellCasting) {
+		GPTP_PROFILE_HOOK(GetSightRange);
 		//Default StarCraft logic
 		using scbw::getUpgradeLevel;
 
@@ -4,6 +4,7 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
+#include <profiler.h>
 
 namespace hooks {
 
@@ -11,6 +12,7 @@ namespace hooks {
 	/// Note: Seek ranges are measured in matrices (1 matrix = 32 pixels).
 	/// This hook affects the behavior of CUnit::getSeekRange().
 	u8 getSeekRangeHook(const CUnit *unit) {
+		GPTP_PROFILE_HOOK(GetSeekRange);
 		//Default StarCraft behavior
 		using UnitStatus::Cloaked;
 		using UnitStatus::RequiresDetection;
@@ -69,6 +71,7 @@ namespace hooks {
 	/// @param  weapon    The weapons.dat ID of the weapon.
 	/// @param  unit      The unit that owns the weapon. Use this to check upgrades.
 	u32 getMaxWeaponRangeHook(const CUnit *unit, u8 weaponId) {
+		GPTP_PROFILE_HOOK(GetMaxWeaponRange);
 		//Default StarCraft behavior
 		using scbw::getUpgradeLevel;
 
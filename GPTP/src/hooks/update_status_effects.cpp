@@ -4,6 +4,7 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/UnitFinder.h>
 #include <algorithm>
+#include <profiler.h>
 
 namespace hooks {
 
@@ -65,6 +66,7 @@ namespace hooks {
 	//Hook function for UpdateStatusEffects() (AKA RestoreAllUnitStats())
 	//Note: This function is called every 8 ticks (when unit->cycleCounter reaches 8 == 0)
 	void updateStatusEffectsHook(CUnit *unit) {
+		GPTP_PROFILE_HOOK(UpdateStatusEffects);
 		//Default StarCraft logic
 
 		if (unit->stasisTimer) {
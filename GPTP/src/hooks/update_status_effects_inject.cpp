@@ -5,30 +5,16 @@ namespace {
 
 	const u32 Hook_UpdateStatusEffects = 0x00492F70;
 
-	//Inject with jmpPatch()
-	void __declspec(naked) updateStatusEffectsWrapper() {
-		CUnit *unit;
-
-		__asm {
-			PUSHAD
-				MOV EBP, ESP
-				MOV unit, EAX
-		}
-
-		hooks::updateStatusEffectsHook(unit);
-
-		__asm {
-			POPAD
-				RETN
-		}
-	}
-
 } //unnamed namespace
 
 namespace hooks {
 
 	void injectUpdateStatusEffects() {
-		jmpPatch(updateStatusEffectsWrapper, Hook_UpdateStatusEffects);
+		using namespace GPTP::Register;
+
+		//Inject with jmpPatch(): unit in EAX
+		jmpPatch(createThunk(GPTP::ThunkSignature().arg(EAX),
+			updateStatusEffectsHook), Hook_UpdateStatusEffects);
 	}
 
 	void updateStatusEffects(CUnit *unit) {
@@ -4,6 +4,7 @@
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
 #include <algorithm>
+#include <profiler.h>
 
 namespace {
 	//Helper function: Returns true if the unit's HP <= 33%.
@@ -74,6 +75,7 @@ namespace hooks {
 	/// Updates unit timers, regenerates hp and shields, and burns down Terran buildings.
 	/// Logically equivalent to function @ 0x004EC290
 	void updateUnitStateHook(CUnit* unit) {
+		GPTP_PROFILE_HOOK(UpdateUnitState);
 		//Default StarCraft logic
 
 		//Timers
@@ -3,31 +3,18 @@
 
 namespace {
 
-	//Inject with jmpPatch()
 	const u32 Hook_UpdateUnitState = 0x004EC290;
-	void __declspec(naked) updateUnitStateWrapper() {
-		CUnit *unit;
-
-		__asm {
-			PUSHAD
-				MOV EBP, ESP
-				MOV unit, EAX
-		}
-
-		hooks::updateUnitStateHook(unit);
-
-		__asm {
-			POPAD
-				RETN
-		}
-	}
 
 } //unnamed namespace
 
 namespace hooks {
 
 	void injectUpdateUnitState() {
-		jmpPatch(updateUnitStateWrapper, Hook_UpdateUnitState);
+		using namespace GPTP::Register;
+
+		//Inject with jmpPatch(): unit in EAX
+		jmpPatch(createThunk(GPTP::ThunkSignature().arg(EAX),
+			updateUnitStateHook), Hook_UpdateUnitState);
 	}
 
 } //hooks
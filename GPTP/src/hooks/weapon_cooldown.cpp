@@ -1,6 +1,7 @@
 #include "weapon_cooldown.h"
 #include "../SCBW/scbwdata.h"
 #include "../SCBW/enumerations.h"
+#include "../profiler.h"
 
 namespace hooks {
 
@@ -8,6 +9,7 @@ namespace hooks {
 	///
 	/// @return		The modified cooldown value.
 	u32 getModifiedWeaponCooldownHook(const CUnit* unit, u8 weaponId) {
+		GPTP_PROFILE_HOOK(GetModifiedWeaponCooldown);
 		//Default StarCraft behavior
 		u32 cooldown = weapons_dat::Cooldown[weaponId];
 
@@ -2,7 +2,9 @@
 #include "../SCBW/scbwdata.h"
 #include "../SCBW/enumerations.h"
 #include "../SCBW/api.h"
+#include "../SCBW/TypeInfoCache.h"
 #include <algorithm>
+#include "../profiler.h"
 
 namespace {
 	//Helper functions
@@ -33,6 +35,7 @@ namespace hooks {
 		u8      attackingPlayer,
 		s8      direction,
 		u8      dmgDivisor) {
+		GPTP_PROFILE_HOOK(WeaponDamage);
 		//Default StarCraft behavior
 		using scbw::isCheatEnabled;
 		using CheatFlags::PowerOverwhelming;
@@ -59,11 +62,12 @@ namespace hooks {
 			target->reduceDefensiveMatrixHp(d_matrix_reduceAmount);
 		}
 
-		const u8 damageType = weapons_dat::DamageType[weaponId];
+		const scbw::UnitTypeInfo &targetInfo = scbw::typeInfoCache.getUnit(target->id);
+		const u8 damageType = scbw::typeInfoCache.getWeapon(weaponId).damageType;
 
 		//Reduce Plasma Shields...but not just yet
 		s32 shieldReduceAmount = 0;
-		if (units_dat::ShieldsEnabled[target->id] && target->shields >= 256) {
+		if (targetInfo.shieldsEnabled && target->shields >= 256) {
 			if (damageType != DamageType::IgnoreArmor) {
 				s32 plasmaShieldUpg = scbw::getUpgradeLevel(target->playerId, UpgradeId::ProtossPlasmaShields) << 8;
 				if (damage > plasmaShieldUpg) //Weird logic, Blizzard dev must have been sleepy
@@ -82,7 +86,7 @@ namespace hooks {
 		}
 
 		//Apply damage type/unit size factor
-		damage = (damage * damageFactor[damageType].unitSizeFactor[units_dat::SizeType[target->id]]) >> 8;
+		damage = (damage * damageFactor[damageType].unitSizeFactor[targetInfo.sizeType]) >> 8;
 		if (shieldReduceAmount == 0 && damage < 128)
 			damage = 128;
 
@@ -4,6 +4,7 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/enumerations.h>
 #include <SCBW/api.h>
+#include <profiler.h>
 
 
 //-------- Helper function declarations. Do NOT modify! ---------//
@@ -23,6 +24,7 @@ namespace hooks {
 	//This hook affects the following iscript opcodes: attackwith, attack, castspell
 	//This also affects CUnit::fireWeapon().
 	void fireWeaponHook(CUnit *unit, u8 weaponId) {
+		GPTP_PROFILE_HOOK(FireWeapon);
 		//Default StarCraft behavior
 
 		//Retrieve the spawning position for the bullet.
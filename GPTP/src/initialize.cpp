@@ -1,6 +1,7 @@
 #include "definitions.h"
 #include "Plugin.h"
 #include "hook_tools.h"
+#include <cstdio>
 
 //Hook header files
 #include "hooks/game_hooks.h"
@@ -57,6 +58,10 @@ BOOL WINAPI Plugin::InitializePlugin(IMPQDraftServer *lpMPQDraftServer) {
 	if (!checkStarCraftExeVersion(exePath))
 		return FALSE;
 
+	//Collect all hooks first, so that they are injected all at once
+	GPTP::PatchSet patchSet;
+	beginPatchSet(patchSet);
+
 	hooks::injectGameHooks();
 	hooks::injectDrawHook();
 
@@ -96,5 +101,13 @@ BOOL WINAPI Plugin::InitializePlugin(IMPQDraftServer *lpMPQDraftServer) {
 
 	hooks::injectSpellcasterAI();
 
+	if (!endPatchSet()) {
+		char message[200];
+		sprintf_s(message, sizeof(message), "Error: Cannot inject the hook at 0x%08X: %s.",
+			(u32)patchSet.getErrorAddress(), patchSet.getErrorString());
+		MessageBox(NULL, message, NULL, MB_OK);
+		return FALSE;
+	}
+
 	return TRUE;
 }
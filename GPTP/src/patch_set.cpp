@@ -0,0 +1,197 @@
+#include "patch_set.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace GPTP {
+
+	namespace {
+
+		bool isLowerAddress(const void *a, const void *b) {
+			return std::less<const void*>()(a, b);
+		}
+
+		u8* getPageStart(const u8 *address, size_t pageSize) {
+			return (u8*)((size_t)address & ~(pageSize - 1));
+		}
+
+	} //unnamed namespace
+
+	PatchSet::PatchSet()
+		: applied(false), rejectedError(ERROR_NONE), rejectedAddress(NULL),
+		error(ERROR_NONE), errorAddress(NULL) {}
+
+	u8* PatchSet::addPatch(void *address, size_t size) {
+		const Patch patch = { (u8*)address, size, this->bytes.size() };
+		this->patches.push_back(patch);
+		this->bytes.resize(this->bytes.size() + size);
+		return &this->bytes[patch.offset];
+	}
+
+	void PatchSet::add(void *address, const u8 *data, size_t size) {
+		if (size == 0)
+			return;
+
+		memcpy(this->addPatch(address, size), data, size);
+	}
+
+	void PatchSet::add(void *address, const u8 *data, size_t size, const u8 *expected) {
+		this->add(address, data, size);
+		this->expect(address, expected, size);
+	}
+
+	void PatchSet::addBranch(u8 opcode, const void *target, void *position, unsigned int nops) {
+		u8 *const data = this->addPatch(position, 5 + nops);
+		const s32 address = (s32)((size_t)target - (size_t)position - 5);	//Relative address
+
+		data[0] = opcode;
+		memcpy(&data[1], &address, sizeof(address));
+		memset(&data[5], 0x90, nops);	//NOP instructions
+	}
+
+	void PatchSet::addJmp(const void *target, void *position, unsigned int nops) {
+		this->addBranch(0xE9, target, position, nops);	//Relative JMP instruction
+	}
+
+	void PatchSet::addCall(const void *target, void *position, unsigned int nops) {
+		this->addBranch(0xE8, target, position, nops);	//Relative CALL instruction
+	}
+
+	void PatchSet::expect(const void *address, const u8 *expected, size_t size) {
+		if (size == 0)
+			return;
+
+		const Patch check = { (u8*)address, size, this->bytes.size() };
+		this->checks.push_back(check);
+		this->bytes.insert(this->bytes.end(), expected, expected + size);
+	}
+
+	void PatchSet::reject(Error error, const void *address) {
+		if (this->rejectedError == ERROR_NONE) {
+			this->rejectedError = error;
+			this->rejectedAddress = address;
+		}
+	}
+
+	bool PatchSet::fail(Error error, const void *address) {
+		this->error = error;
+		this->errorAddress = address;
+		return false;
+	}
+
+	bool PatchSet::apply(MemoryProtector &protector) {
+		if (this->applied)
+			return this->fail(ERROR_ALREADY_APPLIED, NULL);
+
+		if (this->rejectedError != ERROR_NONE)
+			return this->fail(this->rejectedError, this->rejectedAddress);
+
+		//Check for overlapping patches
+		std::vector<Patch> sortedPatches(this->patches);
+		std::sort(sortedPatches.begin(), sortedPatches.end(),
+			[](const Patch &a, const Patch &b) { return isLowerAddress(a.address, b.address); });
+
+		for (size_t i = 1; i < sortedPatches.size(); ++i) {
+			const Patch &previous = sortedPatches[i - 1];
+			if (isLowerAddress(sortedPatches[i].address, previous.address + previous.size))
+				return this->fail(ERROR_OVERLAP, sortedPatches[i].address);
+		}
+
+		for (size_t i = 0; i < this->checks.size(); ++i) {
+			const Patch &check = this->checks[i];
+			if (memcmp(check.address, &this->bytes[check.offset], check.size) != 0)
+				return this->fail(ERROR_UNEXPECTED_BYTES, check.address);
+		}
+
+		//Save the original bytes for rollback()
+		this->originalBytes.assign(this->bytes.size(), 0);
+		for (size_t i = 0; i < this->patches.size(); ++i) {
+			const Patch &patch = this->patches[i];
+			memcpy(&this->originalBytes[patch.offset], patch.address, patch.size);
+		}
+
+		if (!this->write(protector, this->bytes))
+			return false;
+
+		this->applied = true;
+		this->error = ERROR_NONE;
+		this->errorAddress = NULL;
+		return true;
+	}
+
+	bool PatchSet::rollback(MemoryProtector &protector) {
+		if (!this->applied)
+			return this->fail(ERROR_NOT_APPLIED, NULL);
+
+		if (!this->write(protector, this->originalBytes))
+			return false;
+
+		this->applied = false;
+		this->error = ERROR_NONE;
+		this->errorAddress = NULL;
+		return true;
+	}
+
+	bool PatchSet::write(MemoryProtector &protector, const std::vector<u8> &source) {
+		const size_t pageSize = protector.getPageSize();
+
+		//Find every page touched by a patch (a patch may cross a page boundary)
+		std::vector<u8*> pages;
+		for (size_t i = 0; i < this->patches.size(); ++i) {
+			const Patch &patch = this->patches[i];
+			u8 *const lastPage = getPageStart(patch.address + patch.size - 1, pageSize);
+			for (u8 *page = getPageStart(patch.address, pageSize); page <= lastPage; page += pageSize)
+				pages.push_back(page);
+		}
+
+		std::sort(pages.begin(), pages.end(), isLowerAddress);
+		pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+		std::vector<u32> oldProtections(pages.size());
+		for (size_t i = 0; i < pages.size(); ++i) {
+			if (!protector.unprotect(pages[i], oldProtections[i])) {
+				for (size_t k = 0; k < i; ++k)
+					protector.restore(pages[k], oldProtections[k]);
+				return this->fail(ERROR_PROTECTION, pages[i]);
+			}
+		}
+
+		for (size_t i = 0; i < this->patches.size(); ++i) {
+			const Patch &patch = this->patches[i];
+			memcpy(patch.address, &source[patch.offset], patch.size);
+		}
+
+		for (size_t i = 0; i < pages.size(); ++i) {
+			protector.restore(pages[i], oldProtections[i]);
+			protector.flushInstructionCache(pages[i]);
+		}
+
+		return true;
+	}
+
+	void PatchSet::clear() {
+		this->patches.clear();
+		this->bytes.clear();
+		this->checks.clear();
+		this->originalBytes.clear();
+		this->applied = false;
+		this->rejectedError = ERROR_NONE;
+		this->rejectedAddress = NULL;
+		this->error = ERROR_NONE;
+		this->errorAddress = NULL;
+	}
+
+	const char* PatchSet::getErrorString() const {
+		switch (this->error) {
+		case ERROR_NONE:				return "No error";
+		case ERROR_OVERLAP:				return "Overlaps another patch";
+		case ERROR_UNEXPECTED_BYTES:	return "The original bytes do not match";
+		case ERROR_PROTECTION:			return "Cannot make the memory writable";
+		case ERROR_NOT_APPLIED:			return "The patches have not been applied";
+		case ERROR_ALREADY_APPLIED:		return "The patches have already been applied";
+		case ERROR_OUT_OF_MEMORY:		return "Cannot allocate memory for the patch";
+		default:						return "Unknown error";
+		}
+	}
+
+} //GPTP
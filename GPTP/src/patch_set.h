@@ -0,0 +1,123 @@
+/// Batched, all-or-nothing memory patching.
+///
+/// A PatchSet collects patches (and optional checks of the original bytes)
+/// and applies them in one pass. Before anything is written, apply() checks
+/// that no two patches overlap, that all expected bytes match and that every
+/// page can be made writable. The protection of each page is changed once,
+/// no matter how many patches it contains. If any check fails, memory is left
+/// untouched. An applied PatchSet can be undone with rollback().
+///
+/// This file does not depend on Windows. The OS-specific part (changing page
+/// protection) is provided by a MemoryProtector; see hook_tools.h for the
+/// VirtualProtect() implementation used by GPTP.
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <vector>
+
+namespace GPTP {
+
+	/// Changes the protection of memory pages for a PatchSet.
+	class MemoryProtector {
+	public:
+		virtual ~MemoryProtector() {}
+
+		/// Size of a memory page in bytes. Must be a power of 2.
+		virtual size_t getPageSize() const = 0;
+
+		/// Makes the page at @p page writable and stores its previous protection
+		/// in @p oldProtection.
+		virtual bool unprotect(void *page, u32 &oldProtection) = 0;
+
+		/// Restores the protection returned by unprotect().
+		virtual bool restore(void *page, u32 oldProtection) = 0;
+
+		/// Called for each page after it has been written to.
+		virtual void flushInstructionCache(void * /*page*/) {}
+	};
+
+	class PatchSet {
+	public:
+		enum Error {
+			ERROR_NONE = 0,
+			ERROR_OVERLAP,				//Two patches write to the same byte
+			ERROR_UNEXPECTED_BYTES,		//The original bytes do not match
+			ERROR_PROTECTION,			//A page could not be made writable
+			ERROR_NOT_APPLIED,			//rollback() without a successful apply()
+			ERROR_ALREADY_APPLIED,		//apply() twice without rollback()
+			ERROR_OUT_OF_MEMORY,		//Memory for a patch (e.g. a thunk) could not be allocated
+		};
+
+		PatchSet();
+
+		/// Adds a patch that writes @p size bytes of @p data to @p address.
+		void add(void *address, const u8 *data, size_t size);
+
+		/// Same as above, but apply() fails unless the @p size bytes at
+		/// @p address are equal to @p expected before patching.
+		void add(void *address, const u8 *data, size_t size, const u8 *expected);
+
+		/// Adds a relative JMP/CALL to @p target at @p position, followed by
+		/// @p nops NOP instructions. See jmpPatch() and callPatch().
+		void addJmp(const void *target, void *position, unsigned int nops = 0);
+		void addCall(const void *target, void *position, unsigned int nops = 0);
+
+		/// Makes apply() fail unless the @p size bytes at @p address are equal
+		/// to @p expected. The bytes are copied.
+		void expect(const void *address, const u8 *expected, size_t size);
+
+		/// Makes apply() fail with @p error, for a patch that could not be
+		/// created at all.
+		void reject(Error error, const void *address);
+
+		/// Writes all patches. On failure, nothing is written and getError()
+		/// tells why.
+		bool apply(MemoryProtector &protector);
+
+		/// Restores the bytes that apply() overwrote.
+		bool rollback(MemoryProtector &protector);
+
+		/// Removes all patches. Does not roll back an applied PatchSet.
+		void clear();
+
+		size_t getPatchCount() const { return this->patches.size(); }
+		bool isApplied() const { return this->applied; }
+
+		Error getError() const { return this->error; }
+		/// Address of the patch (or expected bytes) that caused the error.
+		const void* getErrorAddress() const { return this->errorAddress; }
+		/// Returns a short description of getError().
+		const char* getErrorString() const;
+
+	private:
+		struct Patch {
+			u8 *address;
+			size_t size;
+			size_t offset;	//Position of the data in this->bytes
+		};
+
+		//Reserves @p size bytes of data for a new patch and returns them
+		u8* addPatch(void *address, size_t size);
+		void addBranch(u8 opcode, const void *target, void *position, unsigned int nops);
+
+		bool fail(Error error, const void *address);
+
+		//Writes @p source[i] to each patch i, changing the protection of each
+		//page once. Fails before writing anything if a page cannot be unprotected.
+		bool write(MemoryProtector &protector, const std::vector<u8> &source);
+
+		std::vector<Patch> patches;
+		std::vector<u8> bytes;			//Data of all patches
+		std::vector<Patch> checks;		//Expected bytes, also in this->bytes
+		std::vector<u8> originalBytes;	//Saved by apply(), same layout as this->bytes
+		bool applied;
+
+		Error rejectedError;			//Set by reject()
+		const void *rejectedAddress;
+
+		Error error;
+		const void *errorAddress;
+	};
+
+} //GPTP
@@ -0,0 +1,258 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "profiler.h"
+
+namespace GPTP {
+
+	namespace {
+
+		//Must be in the same order as GPTP::HookId
+		const char *const hookNames[] = {
+			"nextFrame",
+			"DrawHook",
+			"AI_spellcasterHook",
+			"applyUpgradeFlagsToExistingUnitsHook",
+			"applyUpgradeFlagsToNewUnitHook",
+			"applyUnitUpgradeFlagsToAllFriendlyUnitsHook",
+			"canMakePsiField",
+			"canUseStimPacksHook",
+			"cloakNearbyUnitsHook",
+			"consumeHitHook",
+			"createBunkerAttackThingyHook",
+			"findBestAttackTargetHook",
+			"findBestSpiderMineTargetHook",
+			"findRandomAttackTargetHook",
+			"fireWeaponHook",
+			"getArmorBonusHook",
+			"getAttackPriorityHook",
+			"getCancelMorphRevertTypeHook",
+			"getCloakedTargetVisibility",
+			"getCloakingTech",
+			"getMaxWeaponRangeHook",
+			"getModifiedUnitAccelerationHook",
+			"getModifiedUnitSpeedHook",
+			"getModifiedUnitTurnSpeedHook",
+			"getModifiedWeaponCooldownHook",
+			"getMorphBuildingTypeCountHook",
+			"getSeekRangeHook",
+			"getSightRangeHook",
+			"getSpiderMineBurrowTimeHook",
+			"getTechUseErrorMessageHook",
+			"getUnitMaxEnergyHook",
+			"getUnitMorphEggTypeHook",
+			"getUnitVerticalOffsetOnBirth",
+			"hasSuppliesForUnitHook",
+			"isEggUnitHook",
+			"isMorphedBuildingHook",
+			"isRallyableEggUnitHook",
+			"isReadyToMakePsiField",
+			"orderNewUnitToRally",
+			"orderRechargeShieldsHook",
+			"setRallyPosition",
+			"setRallyUnit",
+			"transferResourceToWorkerHook",
+			"transferUnitTechToPlayerHook",
+			"transferUnitUpgradesToPlayerHook",
+			"unitCanAttackInsideBunkerHook",
+			"unitCanDetectHook",
+			"unitCanMorphHook",
+			"unitCanRechargeShieldsHook",
+			"unitDestructorSpecialHook",
+			"updateStatusEffectsHook",
+			"updateUnitStateHook",
+			"useStimPacksHook",
+			"weaponDamageHook",
+		};
+
+		static_assert(sizeof(hookNames) / sizeof(hookNames[0]) == HookId::COUNT,
+			"The hookNames array does not match GPTP::HookId");
+
+	} //unnamed namespace
+
+	const char* getHookName(HookId::Enum hookId) {
+		return hookNames[hookId];
+	}
+
+} //GPTP
+
+#ifdef GPTP_PROFILING_ENABLED
+
+#include "graphics/graphics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace GPTP {
+
+	HookProfiler hookProfiler;
+
+	namespace {
+
+		int getBucket(u64 cycles) {
+			if (cycles < 16)
+				return (int)cycles;
+
+			int exponent = 4;
+			while (cycles >> (exponent + 1))
+				++exponent;
+
+			const int bucket = 16 + (exponent - 4) * 4 + (int)((cycles >> (exponent - 2)) & 3);
+			return std::min(bucket, HookProfiler::HISTOGRAM_BUCKETS - 1);
+		}
+
+		//Returns the highest value that falls into @p bucket
+		u64 getBucketLimit(int bucket) {
+			if (bucket < 16)
+				return bucket;
+
+			const int exponent = 4 + (bucket - 16) / 4;
+			const int step = (bucket - 16) % 4;
+			return ((u64)(5 + step) << (exponent - 2)) - 1;
+		}
+
+	} //unnamed namespace
+
+	HookProfiler::HookProfiler() {
+		this->startGame();
+	}
+
+	void HookProfiler::startGame() {
+		memset(this->stats, 0, sizeof(this->stats));
+		memset(this->frameCycles, 0, sizeof(this->frameCycles));
+		memset(this->frameCalls, 0, sizeof(this->frameCalls));
+		this->frameCount = 0;
+
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+		this->startTime = time.QuadPart;
+		this->startTick = __rdtsc();
+	}
+
+	void HookProfiler::endFrame() {
+		for (int i = 0; i < HookId::COUNT; ++i) {
+			if (this->frameCalls[i] == 0)
+				continue;
+
+			HookStats &hook = this->stats[i];
+			const u64 cycles = this->frameCycles[i];
+
+			hook.totalCycles += cycles;
+			hook.maxCycles = std::max(hook.maxCycles, cycles);
+			hook.totalCalls += this->frameCalls[i];
+			hook.framesCalled++;
+			hook.histogram[getBucket(cycles)]++;
+
+			this->frameCycles[i] = 0;
+			this->frameCalls[i] = 0;
+		}
+
+		this->frameCount++;
+	}
+
+	u64 HookProfiler::getPercentile(const HookStats &stats, int percent) const {
+		if (stats.framesCalled == 0)
+			return 0;
+
+		const u32 target = (u32)(((u64)stats.framesCalled * percent + 99) / 100);
+		u32 count = 0;
+
+		for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket) {
+			count += stats.histogram[bucket];
+			if (count >= target)
+				return std::min(getBucketLimit(bucket), stats.maxCycles);
+		}
+
+		return stats.maxCycles;
+	}
+
+	double HookProfiler::getCyclesPerMicrosecond() const {
+		LARGE_INTEGER time, frequency;
+		QueryPerformanceCounter(&time);
+		QueryPerformanceFrequency(&frequency);
+
+		const double elapsedMicroseconds = (double)(time.QuadPart - this->startTime) * 1000000.0 / frequency.QuadPart;
+		if (elapsedMicroseconds <= 0)
+			return 1.0;
+
+		return (double)(__rdtsc() - this->startTick) / elapsedMicroseconds;
+	}
+
+	void HookProfiler::drawOverlay() const {
+		using namespace graphics;
+
+		//Find the hooks with the highest total cost
+		int hookIds[HookId::COUNT];
+		for (int i = 0; i < HookId::COUNT; ++i)
+			hookIds[i] = i;
+
+		const int rowCount = std::min((int)OVERLAY_ROWS, (int)HookId::COUNT);
+		std::partial_sort(hookIds, hookIds + rowCount, hookIds + HookId::COUNT,
+			[this](int a, int b) {
+				return this->stats[a].totalCycles > this->stats[b].totalCycles;
+			});
+
+		const double cyclesPerUs = this->getCyclesPerMicrosecond();
+		const double frames = std::max(this->frameCount, 1u);
+		const int x = 10, y = 40;
+
+		drawText(x, y, "Hook", FONT_SMALL);
+		drawText(x + 200, y, "Calls/f", FONT_SMALL);
+		drawText(x + 250, y, "us/f", FONT_SMALL);
+		drawText(x + 300, y, "p50", FONT_SMALL);
+		drawText(x + 350, y, "p99", FONT_SMALL);
+		drawText(x + 400, y, "Max", FONT_SMALL);
+
+		for (int row = 0; row < rowCount; ++row) {
+			const HookStats &hook = this->stats[hookIds[row]];
+			if (hook.totalCycles == 0)
+				break;
+
+			const int rowY = y + 10 * (row + 1);
+			drawText(x, rowY, hookNames[hookIds[row]], FONT_SMALL);
+			drawTextf(x + 200, rowY, FONT_SMALL, ON_SCREEN, "%.1f", hook.totalCalls / frames);
+			drawTextf(x + 250, rowY, FONT_SMALL, ON_SCREEN, "%.1f", hook.totalCycles / frames / cyclesPerUs);
+			drawTextf(x + 300, rowY, FONT_SMALL, ON_SCREEN, "%.1f", this->getPercentile(hook, 50) / cyclesPerUs);
+			drawTextf(x + 350, rowY, FONT_SMALL, ON_SCREEN, "%.1f", this->getPercentile(hook, 99) / cyclesPerUs);
+			drawTextf(x + 400, rowY, FONT_SMALL, ON_SCREEN, "%.1f", hook.maxCycles / cyclesPerUs);
+		}
+	}
+
+	void HookProfiler::endGame() {
+		time_t currentTime;
+		time(&currentTime);
+
+		char fileName[100];
+		strftime(fileName, sizeof(fileName), "Profile %Y-%m-%d %Hh %Mm %Ss.csv",
+			localtime(&currentTime));
+
+		FILE *file = fopen(fileName, "w");
+		if (!file)
+			return;
+
+		const double cyclesPerUs = this->getCyclesPerMicrosecond();
+		const double frames = std::max(this->frameCount, 1u);
+
+		fprintf(file, "hook,calls,frames_called,total_cycles,cycles_per_frame,"
+			"p50_cycles,p99_cycles,max_cycles,us_per_frame,p50_us,p99_us,max_us\n");
+
+		for (int i = 0; i < HookId::COUNT; ++i) {
+			const HookStats &hook = this->stats[i];
+			const u64 p50 = this->getPercentile(hook, 50);
+			const u64 p99 = this->getPercentile(hook, 99);
+
+			fprintf(file, "%s,%u,%u,%llu,%.0f,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f\n",
+				hookNames[i], hook.totalCalls, hook.framesCalled, hook.totalCycles,
+				hook.totalCycles / frames, p50, p99, hook.maxCycles,
+				hook.totalCycles / frames / cyclesPerUs, p50 / cyclesPerUs,
+				p99 / cyclesPerUs, hook.maxCycles / cyclesPerUs);
+		}
+
+		fclose(file);
+	}
+
+} //GPTP
+
+#endif
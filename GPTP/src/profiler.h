@@ -0,0 +1,167 @@
+/// Per-hook profiling for GPTP.
+///
+/// Each hook function starts with GPTP_PROFILE_HOOK(<HookId>), which times
+/// the call with the CPU timestamp counter (inclusive of any hooks it calls).
+/// At the end of every frame, the time spent in each hook is added to a
+/// per-hook histogram. While profiling is enabled, the most expensive hooks
+/// are shown on screen, and a CSV summary is written when the game ends
+/// ("Profile <date>.csv").
+///
+/// Profiling is off by default. When GPTP_PROFILING_ENABLED is not defined,
+/// all GPTP_PROFILE_*() macros compile to nothing. GPTP_PROFILE_HOOK() also
+/// records the hook in the frame timeline trace (see trace_recorder.h).
+
+#pragma once
+#include "types.h"
+#include "trace_recorder.h"
+#include <intrin.h>
+
+//Uncomment this to enable the hook profiler.
+//#define GPTP_PROFILING_ENABLED
+
+namespace GPTP {
+
+	namespace HookId {
+		enum Enum {
+			NextFrame,
+			DrawHook,
+			AI_Spellcaster,
+			ApplyUpgradeFlagsToExistingUnits,
+			ApplyUpgradeFlagsToNewUnit,
+			ApplyUnitUpgradeFlagsToAllFriendlyUnits,
+			CanMakePsiField,
+			CanUseStimPacks,
+			CloakNearbyUnits,
+			ConsumeHit,
+			CreateBunkerAttackThingy,
+			FindBestAttackTarget,
+			FindBestSpiderMineTarget,
+			FindRandomAttackTarget,
+			FireWeapon,
+			GetArmorBonus,
+			GetAttackPriority,
+			GetCancelMorphRevertType,
+			GetCloakedTargetVisibility,
+			GetCloakingTech,
+			GetMaxWeaponRange,
+			GetModifiedUnitAcceleration,
+			GetModifiedUnitSpeed,
+			GetModifiedUnitTurnSpeed,
+			GetModifiedWeaponCooldown,
+			GetMorphBuildingTypeCount,
+			GetSeekRange,
+			GetSightRange,
+			GetSpiderMineBurrowTime,
+			GetTechUseErrorMessage,
+			GetUnitMaxEnergy,
+			GetUnitMorphEggType,
+			GetUnitVerticalOffsetOnBirth,
+			HasSuppliesForUnit,
+			IsEggUnit,
+			IsMorphedBuilding,
+			IsRallyableEggUnit,
+			IsReadyToMakePsiField,
+			OrderNewUnitToRally,
+			OrderRechargeShields,
+			SetRallyPosition,
+			SetRallyUnit,
+			TransferResourceToWorker,
+			TransferUnitTechToPlayer,
+			TransferUnitUpgradesToPlayer,
+			UnitCanAttackInsideBunker,
+			UnitCanDetect,
+			UnitCanMorph,
+			UnitCanRechargeShields,
+			UnitDestructorSpecial,
+			UpdateStatusEffects,
+			UpdateUnitState,
+			UseStimPacks,
+			WeaponDamage,
+			COUNT
+		};
+	}
+
+	/// Returns the name of the hook function that @p hookId refers to.
+	const char* getHookName(HookId::Enum hookId);
+
+	class HookProfiler {
+	public:
+		/// Number of histogram buckets. Values below 16 cycles get one bucket
+		/// each; above that, each power of 2 is split into 4 buckets.
+		static const int HISTOGRAM_BUCKETS = 168;
+		/// Number of hooks shown by drawOverlay().
+		static const int OVERLAY_ROWS = 8;
+
+		HookProfiler();
+
+		/// Clears all statistics. Called when a game starts.
+		void startGame();
+
+		/// Writes the CSV summary of the game.
+		void endGame();
+
+		/// Adds the time spent in each hook during the last frame to the
+		/// histograms. Called once per frame, before hooks::nextFrame().
+		void endFrame();
+
+		/// Draws the hooks with the highest average cost per frame.
+		void drawOverlay() const;
+
+		void addSample(HookId::Enum hookId, u64 cycles) {
+			this->frameCycles[hookId] += cycles;
+			this->frameCalls[hookId]++;
+		}
+
+	private:
+		struct HookStats {
+			u64 totalCycles;
+			u64 maxCycles;			//Highest cost in a single frame
+			u32 totalCalls;
+			u32 framesCalled;
+			u32 histogram[HISTOGRAM_BUCKETS];
+		};
+
+		//Returns the cost (in cycles) below which @p percent of the frames fall
+		u64 getPercentile(const HookStats &stats, int percent) const;
+
+		double getCyclesPerMicrosecond() const;
+
+		HookStats stats[HookId::COUNT];
+		u64 frameCycles[HookId::COUNT];
+		u32 frameCalls[HookId::COUNT];
+		u32 frameCount;
+
+		u64 startTick;
+		s64 startTime;	//QueryPerformanceCounter() value
+	};
+
+	extern HookProfiler hookProfiler;
+
+	/// Adds the time between construction and destruction to a hook.
+	class ScopedHookTimer {
+	public:
+		explicit ScopedHookTimer(HookId::Enum hookId) : hookId(hookId), startTick(__rdtsc()) {}
+		~ScopedHookTimer() { hookProfiler.addSample(this->hookId, __rdtsc() - this->startTick); }
+
+	private:
+		const HookId::Enum hookId;
+		const u64 startTick;
+	};
+
+} //GPTP
+
+#define GPTP_PROFILE_HOOK(hookId) GPTP_PROFILE_HOOK_TIMER(hookId); GPTP_TRACE_HOOK(hookId)
+
+#ifdef GPTP_PROFILING_ENABLED
+#define GPTP_PROFILE_HOOK_TIMER(hookId) GPTP::ScopedHookTimer _hookTimer(GPTP::HookId::hookId)
+#define GPTP_PROFILE_START_GAME() GPTP::hookProfiler.startGame()
+#define GPTP_PROFILE_END_GAME() GPTP::hookProfiler.endGame()
+#define GPTP_PROFILE_END_FRAME() GPTP::hookProfiler.endFrame()
+#define GPTP_PROFILE_DRAW_OVERLAY() GPTP::hookProfiler.drawOverlay()
+#else
+#define GPTP_PROFILE_HOOK_TIMER(hookId) ((void)0)
+#define GPTP_PROFILE_START_GAME() ((void)0)
+#define GPTP_PROFILE_END_GAME() ((void)0)
+#define GPTP_PROFILE_END_FRAME() ((void)0)
+#define GPTP_PROFILE_DRAW_OVERLAY() ((void)0)
+#endif
@@ -0,0 +1,111 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "trace_recorder.h"
+
+#ifdef GPTP_TRACING_ENABLED
+
+#include "profiler.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+//Trace file layout (see also tools/trace_converter.cpp):
+//  "GPTPTRCE", u32 version
+//  u32 name count, then for each name: u8 length, characters (no terminator)
+//  u64 timestamp counter ticks per second
+//  u32 number of events that were overwritten before the file was written
+//  u32 event count, then the events as GPTP::TraceEvent (24 bytes each),
+//  oldest first
+//All values are little-endian.
+
+namespace GPTP {
+
+	TraceRecorder traceRecorder;
+
+	namespace {
+
+		const char TRACE_FILE_MAGIC[8] = { 'G', 'P', 'T', 'P', 'T', 'R', 'C', 'E' };
+		const u32 TRACE_FILE_VERSION = 1;
+
+	} //unnamed namespace
+
+	TraceRecorder::TraceRecorder()
+		: eventCount(0), isRunning(false), startTick(0), startTime(0) {}
+
+	void TraceRecorder::startGame() {
+		this->eventCount = 0;
+
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+		this->startTime = time.QuadPart;
+		this->startTick = __rdtsc();
+
+		this->isRunning = true;
+	}
+
+	void TraceRecorder::endGame() {
+		if (!this->isRunning)
+			return;
+
+		this->writeTrace();
+		this->isRunning = false;
+	}
+
+	bool TraceRecorder::writeTrace() {
+		time_t currentTime;
+		time(&currentTime);
+
+		char fileName[100];
+		strftime(fileName, sizeof(fileName), "Trace %Y-%m-%d %Hh %Mm %Ss.gtrace",
+			localtime(&currentTime));
+
+		FILE *file = fopen(fileName, "wb");
+		if (!file)
+			return false;
+
+		//Stop recording while the buffer is copied to the file
+		const bool wasRunning = this->isRunning;
+		this->isRunning = false;
+
+		fwrite(TRACE_FILE_MAGIC, 1, sizeof(TRACE_FILE_MAGIC), file);
+		fwrite(&TRACE_FILE_VERSION, sizeof(TRACE_FILE_VERSION), 1, file);
+
+		const u32 nameCount = HookId::COUNT;
+		fwrite(&nameCount, sizeof(nameCount), 1, file);
+		for (u32 i = 0; i < nameCount; ++i) {
+			const char *name = getHookName((HookId::Enum)i);
+			const u8 length = (u8)strlen(name);
+			fwrite(&length, 1, 1, file);
+			fwrite(name, 1, length, file);
+		}
+
+		LARGE_INTEGER time, frequency;
+		QueryPerformanceCounter(&time);
+		QueryPerformanceFrequency(&frequency);
+		const double elapsedSeconds = (double)(time.QuadPart - this->startTime) / frequency.QuadPart;
+		const u64 ticksPerSecond = elapsedSeconds > 0
+			? (u64)((__rdtsc() - this->startTick) / elapsedSeconds) : 0;
+		fwrite(&ticksPerSecond, sizeof(ticksPerSecond), 1, file);
+
+		const u32 totalCount = (u32)this->eventCount;
+		const u32 count = totalCount < (u32)BUFFER_SIZE ? totalCount : (u32)BUFFER_SIZE;
+		const u32 overwrittenCount = totalCount - count;
+		fwrite(&overwrittenCount, sizeof(overwrittenCount), 1, file);
+		fwrite(&count, sizeof(count), 1, file);
+
+		//The oldest event is at the write position once the buffer has wrapped
+		const u32 first = (totalCount - count) & (BUFFER_SIZE - 1);
+		const u32 firstPart = count < (u32)BUFFER_SIZE - first ? count : (u32)BUFFER_SIZE - first;
+		fwrite(&this->events[first], sizeof(TraceEvent), firstPart, file);
+		fwrite(&this->events[0], sizeof(TraceEvent), count - firstPart, file);
+
+		fclose(file);
+		this->isRunning = wasRunning;
+		return true;
+	}
+
+} //GPTP
+
+#endif
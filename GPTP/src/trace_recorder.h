@@ -0,0 +1,108 @@
+/// Frame timeline tracing for GPTP.
+///
+/// While tracing is enabled, every GPTP_PROFILE_HOOK() scope (see profiler.h)
+/// also records a begin and an end event, with the CPU timestamp, the thread
+/// ID and the current frame. Events go into a preallocated ring buffer that
+/// keeps the most recent BUFFER_SIZE events, so memory use does not grow in
+/// long games. The buffer is written to "Trace <date>.gtrace" when the game
+/// ends, or whenever writeTrace() is called. Use tools/trace_converter.cpp to
+/// turn it into Chrome trace JSON for Perfetto or chrome://tracing.
+///
+/// Tracing is off by default. When GPTP_TRACING_ENABLED is not defined, all
+/// GPTP_TRACE_*() macros compile to nothing.
+
+#pragma once
+#include "types.h"
+#include <SCBW/scbwdata.h>
+#include <intrin.h>
+
+//Uncomment this to enable the trace recorder.
+//#define GPTP_TRACING_ENABLED
+
+namespace GPTP {
+
+	namespace TracePhase {
+		enum Enum {
+			Begin = 0,
+			End = 1,
+		};
+	}
+
+	struct TraceEvent {
+		u64 tick;			//CPU timestamp counter (__rdtsc())
+		u32 frame;			//*elapsedTimeFrames
+		u32 threadId;
+		u16 nameId;			//GPTP::HookId
+		u16 phase;			//GPTP::TracePhase
+		u32 padding;
+	};
+
+	static_assert(sizeof(TraceEvent) == 24, "The trace file format depends on the size of TraceEvent");
+
+	class TraceRecorder {
+	public:
+		/// Number of events kept in memory (24 bytes each). Must be a power of 2.
+		static const int BUFFER_SIZE = 1 << 19;
+
+		TraceRecorder();
+
+		/// Clears the buffer and starts recording.
+		void startGame();
+
+		/// Stops recording and writes the trace file.
+		void endGame();
+
+		/// Writes the events currently in the buffer to a new trace file.
+		/// Events added by other threads during the call may be lost.
+		bool writeTrace();
+
+		void addEvent(u16 nameId, TracePhase::Enum phase);
+
+	private:
+		TraceEvent events[BUFFER_SIZE];
+		volatile long eventCount;	//Total number of events since startGame()
+		bool isRunning;
+
+		u64 startTick;
+		s64 startTime;	//QueryPerformanceCounter() value
+	};
+
+	extern TraceRecorder traceRecorder;
+
+	/// Records a begin event on construction and an end event on destruction.
+	class ScopedTraceEvent {
+	public:
+		explicit ScopedTraceEvent(u16 nameId) : nameId(nameId) {
+			traceRecorder.addEvent(nameId, TracePhase::Begin);
+		}
+		~ScopedTraceEvent() { traceRecorder.addEvent(this->nameId, TracePhase::End); }
+
+	private:
+		const u16 nameId;
+	};
+
+	inline void TraceRecorder::addEvent(u16 nameId, TracePhase::Enum phase) {
+		if (!this->isRunning)
+			return;
+
+		//Old events are overwritten once the buffer is full
+		const u32 index = (u32)_InterlockedIncrement(&this->eventCount) - 1;
+		TraceEvent &event = this->events[index & (BUFFER_SIZE - 1)];
+		event.tick = __rdtsc();
+		event.frame = *elapsedTimeFrames;
+		event.threadId = __readfsdword(0x24);	//Thread ID from the TEB, same as GetCurrentThreadId()
+		event.nameId = nameId;
+		event.phase = (u16)phase;
+	}
+
+} //GPTP
+
+#ifdef GPTP_TRACING_ENABLED
+#define GPTP_TRACE_HOOK(hookId) GPTP::ScopedTraceEvent _traceEvent(GPTP::HookId::hookId)
+#define GPTP_TRACE_START_GAME() GPTP::traceRecorder.startGame()
+#define GPTP_TRACE_END_GAME() GPTP::traceRecorder.endGame()
+#else
+#define GPTP_TRACE_HOOK(hookId) ((void)0)
+#define GPTP_TRACE_START_GAME() ((void)0)
+#define GPTP_TRACE_END_GAME() ((void)0)
+#endif
@@ -9,6 +9,8 @@
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
+typedef std::uint64_t	u64;
+typedef std::int64_t	s64;
 typedef std::uint32_t	u32;
 typedef std::int32_t	s32;
 typedef std::uint16_t	u16;
@@ -0,0 +1,368 @@
+//Checks hooks::cloakNearbyUnitsHook() on scbw::AuraEngine against the hook
+//it replaced (one UnitFinder search and loop per Arbiter), on random games:
+//
+//  - the same units are cloaked, in the same order: the order of the
+//    burrowed unit list (0x0063FF5C) after each frame must match
+//  - the same units get UnitStatus::CloakingForFree
+//  - whenever the old hook refreshed the console for an Arbiter, the new one
+//    does too, in the same frame
+//  - units created between two Arbiters of a frame are cloaked by the later
+//    Arbiters of that frame
+//  - the engine does not depend on elapsedTimeFrames: the counter is changed
+//    at random points during the frames, and only beginFrame() starts one
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o aura_engine_test
+//    aura_engine_test.cpp ../src/hooks/cloak_nearby_units.cpp ../src/SCBW/AuraEngine.cpp
+//    ../src/SCBW/UnitFinder.cpp
+//
+//Each frame is run twice from the same state, once per hook, and the
+//results are compared. The burrowed unit list is emptied at the end of each
+//frame, so that its order only depends on the Arbiters of one frame.
+
+#include "host_shim/host_units.h"
+#include <SCBW/AuraEngine.h>
+#include <SCBW/UnitFinder.h>
+#include <hooks/cloak_nearby_units.h>
+#include <cstdio>
+#include <vector>
+
+//-------- CUnit / scbw functions used by the hook --------//
+
+//Every unit type has an air weapon of the same ID; the Arbiter's range is
+//set up in main()
+u8 CUnit::getAirWeapon() const {
+	return (u8)(this->id % WEAPON_TYPE_COUNT);
+}
+
+u32 CUnit::getMaxWeaponRange(u8 weaponId) const {
+	return weapons_dat::MaxRange[weaponId];
+}
+
+namespace {
+	int refreshCount = 0;
+} //unnamed namespace
+
+namespace scbw {
+
+	void refreshConsole() {
+		++refreshCount;
+	}
+
+} //scbw
+
+namespace {
+
+	const int FRAME_COUNT = 400;
+	const int UNIT_COUNT = 900, MAP_SIZE = 1024;
+	const int ARBITER_COUNT = 24;
+
+	CUnit** const firstBurrowedUnit = (CUnit**)0x0063FF5C;
+
+	//-------- The hook before the AuraEngine --------//
+
+	void secondaryOrder_CloakOld(CUnit *unit) {
+		if (unit->isCloaked++)
+			return;
+
+		if (unit->status & UnitStatus::RequiresDetection)
+			return;
+
+		if (unit->burrow_link.next)
+			return;
+
+		unit->burrow_link.next = *firstBurrowedUnit;
+		unit->burrow_link.prev = nullptr;
+		if (*firstBurrowedUnit)
+			(*firstBurrowedUnit)->burrow_link.prev = unit;
+		*firstBurrowedUnit = unit;
+	}
+
+	void cloakNearbyUnitsOld(CUnit *cloaker) {
+		u32 cloakRadius = cloaker->getMaxWeaponRange(cloaker->getAirWeapon());
+
+		scbw::UnitFinder unitsToCloak(
+			cloaker->getX() - cloakRadius, cloaker->getY() - cloakRadius,
+			cloaker->getX() + cloakRadius, cloaker->getY() + cloakRadius);
+
+		bool needsRefresh = false;
+
+		for (int i = 0; i < unitsToCloak.getUnitCount(); ++i) {
+			CUnit *unit = unitsToCloak.getUnit(i);
+
+			if (unit->id == UnitId::arbiter
+				|| unit->id == UnitId::danimoth
+				|| unit->id == UnitId::nuclear_missile)
+				continue;
+
+			if (units_dat::BaseProperty[unit->id] & (UnitProperty::Building | UnitProperty::NeutralAccessories))
+				continue;
+
+			if (unit->status & UnitStatus::IsHallucination)
+				continue;
+
+			if (unit->mainOrderId == OrderId::Warpin)
+				continue;
+
+			if (cloaker->playerId != unit->playerId)
+				continue;
+
+			if (cloaker->getDistanceToTarget(unit) <= cloakRadius) {
+				secondaryOrder_CloakOld(unit);
+				if (!(unit->status & UnitStatus::CloakingForFree)) {
+					unit->status |= UnitStatus::CloakingForFree;
+					needsRefresh = true;
+				}
+			}
+		}
+
+		if (needsRefresh)
+			scbw::refreshConsole();
+	}
+
+	//-------- Game state --------//
+
+	struct GameState {
+		std::vector<CUnit> units;
+		std::vector<CSprite> sprites;
+		CUnit *firstBurrowedUnit;
+	};
+
+	void saveState(GameState &state) {
+		state.units.assign(host::units, host::units + UNIT_ARRAY_LENGTH);
+		state.sprites.assign(host::sprites, host::sprites + UNIT_ARRAY_LENGTH);
+		state.firstBurrowedUnit = *firstBurrowedUnit;
+	}
+
+	void loadState(const GameState &state) {
+		std::copy(state.units.begin(), state.units.end(), host::units);
+		std::copy(state.sprites.begin(), state.sprites.end(), host::sprites);
+		*firstBurrowedUnit = state.firstBurrowedUnit;
+		host::buildUnitOrdering();
+	}
+
+	//A unit placed between two Arbiters of a frame
+	struct Creation {
+		int afterArbiter;
+		u16 index, unitId;
+		int x, y;
+		u8 playerId;
+	};
+
+	std::vector<CUnit*> arbiters;
+	std::vector<Creation> creations;
+
+	CUnit* createUnit(u16 index, u16 unitId, int x, int y, u8 playerId) {
+		CUnit *unit = host::setUnit(index, unitId, x, y);
+		unit->playerId = playerId;
+		if (host::random(10) == 0)
+			unit->status |= UnitStatus::IsHallucination;
+		if (host::random(10) == 0)
+			unit->status |= UnitStatus::RequiresDetection;
+		if (host::random(20) == 0)
+			unit->mainOrderId = OrderId::Warpin;
+		return unit;
+	}
+
+	//Removes the unit from the burrowed unit list and the game
+	void killUnit(CUnit *unit) {
+		if (unit->burrow_link.prev)
+			unit->burrow_link.prev->burrow_link.next = unit->burrow_link.next;
+		else if (*firstBurrowedUnit == unit)
+			*firstBurrowedUnit = unit->burrow_link.next;
+		if (unit->burrow_link.next)
+			unit->burrow_link.next->burrow_link.prev = unit->burrow_link.prev;
+
+		std::memset(unit, 0, sizeof(CUnit));
+	}
+
+	//Returns a random unused unit slot that no other planned unit takes
+	u16 getFreeIndex() {
+		for (;;) {
+			const u16 index = (u16)(ARBITER_COUNT + 1 + host::random(UNIT_ARRAY_LENGTH - ARBITER_COUNT));
+			bool isPlanned = false;
+			for (size_t c = 0; c < creations.size(); ++c)
+				isPlanned = isPlanned || creations[c].index == index;
+			if (!host::units[index - 1].sprite && !isPlanned)
+				return index;
+		}
+	}
+
+	//Moves units around, kills some and plans the units created during the
+	//next frame
+	void prepareFrame() {
+		for (int i = 0; i < UNIT_ARRAY_LENGTH; ++i) {
+			CUnit *unit = &host::units[i];
+			if (unit->sprite && host::random(4) == 0) {
+				unit->sprite->position.x = (u16)std::min(std::max(unit->getX() + host::random(33) - 16, 0), MAP_SIZE - 1);
+				unit->sprite->position.y = (u16)std::min(std::max(unit->getY() + host::random(33) - 16, 0), MAP_SIZE - 1);
+			}
+		}
+
+		for (int i = 0; i < 6; ++i) {
+			CUnit *unit = &host::units[ARBITER_COUNT + host::random(UNIT_ARRAY_LENGTH - ARBITER_COUNT)];
+			if (unit->sprite)
+				killUnit(unit);
+		}
+
+		creations.clear();
+		for (int i = 0; i < 6; ++i) {
+			Creation creation;
+			creation.afterArbiter = host::random(ARBITER_COUNT);
+			creation.index = getFreeIndex();
+			creation.unitId = (u16)host::random(UNIT_TYPE_COUNT);
+			//Next to a later Arbiter, so that it can be cloaked in this frame
+			const CUnit *arbiter = arbiters[std::min(creation.afterArbiter + 1, ARBITER_COUNT - 1)];
+			creation.x = std::min(std::max(arbiter->getX() + host::random(129) - 64, 0), MAP_SIZE - 1);
+			creation.y = std::min(std::max(arbiter->getY() + host::random(129) - 64, 0), MAP_SIZE - 1);
+			creation.playerId = arbiter->playerId;
+			creations.push_back(creation);
+		}
+
+		host::buildUnitOrdering();
+	}
+
+	//Updates the Arbiters like StarCraft, creating the planned units between
+	//them. Returns the Arbiters for which the console was refreshed.
+	std::vector<bool> runFrame(void (*cloakNearbyUnits)(CUnit*), bool changesFrameCounter) {
+		std::vector<bool> refreshes;
+
+		for (int i = 0; i < ARBITER_COUNT; ++i) {
+			const int oldRefreshCount = refreshCount;
+			cloakNearbyUnits(arbiters[i]);
+			refreshes.push_back(refreshCount != oldRefreshCount);
+
+			if (changesFrameCounter && host::random(8) == 0)
+				*(u32*)elapsedTimeFrames += 1;
+
+			bool isCreated = false;
+			for (size_t c = 0; c < creations.size(); ++c) {
+				const Creation &creation = creations[c];
+				if (creation.afterArbiter == i) {
+					std::srand(creation.index);		//Same flags in both runs
+					createUnit(creation.index, creation.unitId, creation.x, creation.y, creation.playerId);
+					isCreated = true;
+				}
+			}
+			if (isCreated)
+				host::buildUnitOrdering();
+		}
+
+		return refreshes;
+	}
+
+	//Empties the burrowed unit list at the end of a frame, so that the list
+	//of the next frame only holds the units cloaked during that frame
+	void updateCloakedUnits() {
+		CUnit *unit = *firstBurrowedUnit;
+		while (unit) {
+			CUnit *next = unit->burrow_link.next;
+			if (!unit->isCloaked)
+				unit->status &= ~UnitStatus::CloakingForFree;
+			unit->isCloaked = false;
+			unit->burrow_link.next = unit->burrow_link.prev = nullptr;
+			unit = next;
+		}
+		*firstBurrowedUnit = nullptr;
+	}
+
+	struct Result {
+		std::vector<u16> burrowedUnits;
+		std::vector<u16> cloakedForFree;
+		std::vector<bool> refreshes;
+	};
+
+	void getResult(Result &result) {
+		result.burrowedUnits.clear();
+		for (CUnit *unit = *firstBurrowedUnit; unit; unit = unit->burrow_link.next)
+			result.burrowedUnits.push_back(unit->getIndex());
+
+		result.cloakedForFree.clear();
+		for (int i = 0; i < UNIT_ARRAY_LENGTH; ++i) {
+			if (host::units[i].sprite && host::units[i].status & UnitStatus::CloakingForFree)
+				result.cloakedForFree.push_back((u16)(i + 1));
+		}
+	}
+
+	long checkCount = 0, mismatches = 0;
+
+	void check(bool isEqual, int frame, const char *what) {
+		++checkCount;
+		if (!isEqual) {
+			if (mismatches < 5)
+				std::printf("Frame %d: %s differs\n", frame, what);
+			++mismatches;
+		}
+	}
+
+} //unnamed namespace
+
+int main() {
+	std::srand(21);
+
+	for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+		units_dat::UnitBounds[unitId].left = units_dat::UnitBounds[unitId].right = (s16)(4 + host::random(20));
+		units_dat::UnitBounds[unitId].top = units_dat::UnitBounds[unitId].bottom = (s16)(4 + host::random(20));
+		units_dat::BaseProperty[unitId] = host::random(8) == 0 ? UnitProperty::Building : 0;
+	}
+	units_dat::BaseProperty[UnitId::arbiter] = 0;
+	for (int weaponId = 0; weaponId < WEAPON_TYPE_COUNT; ++weaponId)
+		weapons_dat::MaxRange[weaponId] = 64 + host::random(128);
+
+	host::clearUnits();
+	((MapSize*)mapTileSize)->width = ((MapSize*)mapTileSize)->height = MAP_SIZE / 32;
+	*firstBurrowedUnit = nullptr;
+
+	for (int i = 1; i <= UNIT_COUNT; ++i) {
+		const bool isArbiter = i <= ARBITER_COUNT;
+		CUnit *unit = createUnit((u16)i, isArbiter ? UnitId::arbiter : (u16)host::random(UNIT_TYPE_COUNT),
+			host::random(MAP_SIZE), host::random(MAP_SIZE), (u8)host::random(3));
+		if (isArbiter)
+			arbiters.push_back(unit);
+	}
+
+	scbw::auraEngine.reset();
+	int cloakedUnitCount = 0, createdUnitCount = 0;
+	GameState start;
+
+	for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+		prepareFrame();
+		saveState(start);
+		const int randomSeed = std::rand();
+
+		//The old hook
+		Result oldResult;
+		std::srand(randomSeed);
+		oldResult.refreshes = runFrame(cloakNearbyUnitsOld, false);
+		getResult(oldResult);
+
+		//The AuraEngine, started like in hooks::nextFrame()
+		loadState(start);
+		Result newResult;
+		std::srand(randomSeed);
+		scbw::auraEngine.beginFrame();
+		newResult.refreshes = runFrame(hooks::cloakNearbyUnitsHook, true);
+		getResult(newResult);
+
+		check(newResult.burrowedUnits == oldResult.burrowedUnits, frame, "Burrowed unit list");
+		check(newResult.cloakedForFree == oldResult.cloakedForFree, frame, "CloakingForFree units");
+		for (int i = 0; i < ARBITER_COUNT; ++i)
+			check(newResult.refreshes[i] || !oldResult.refreshes[i], frame, "Console refresh");
+
+		for (size_t c = 0; c < creations.size(); ++c) {
+			if (host::units[creations[c].index - 1].burrow_link.next || *firstBurrowedUnit == &host::units[creations[c].index - 1])
+				++createdUnitCount;
+		}
+		cloakedUnitCount += newResult.burrowedUnits.size();
+
+		updateCloakedUnits();
+		std::srand(randomSeed + 1);
+	}
+
+	std::printf("%d frames, %d units cloaked, %d of them created during the frame\n",
+		FRAME_COUNT, cloakedUnitCount, createdUnitCount);
+	std::printf("%ld checks\n", checkCount);
+	std::printf("%ld mismatches\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,303 @@
+//Decoder for the binary log files written by GPTP::BinaryLogger
+//(see src/binary_logger.h and src/binary_logger.cpp).
+//
+//Build (Linux):
+//  g++ -O2 -o binary_log_decoder binary_log_decoder.cpp
+//
+//Usage:
+//  binary_log_decoder [--csv] "Game 2015-01-01 12h 00m 00s.blog" > game.txt
+//
+//Text output prints one line per record:
+//  <frame> <time in ms since the first record> [<category>] <message>
+//CSV output has the columns:
+//  frame,tick,time_ms,category,format_id,arg0,arg1,arg2,arg3,message
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+typedef unsigned char u8;
+typedef unsigned int u32;
+typedef int s32;
+typedef unsigned long long u64;
+typedef long long s64;
+
+namespace {
+
+	const char LOG_FILE_MAGIC[8] = { 'G', 'P', 'T', 'P', 'B', 'L', 'O', 'G' };
+	const u8 LOG_FILE_VERSION = 1;
+
+	enum ChunkType {
+		CHUNK_FORMAT = 1,
+		CHUNK_RECORDS = 2,
+		CHUNK_DROPPED = 3,
+		CHUNK_CLOCK = 4,
+	};
+
+	//Must match GPTP::LogCategory
+	const char *const CATEGORY_NAMES[] = { "General", "Hooks", "AI", "Units", "Graphics" };
+
+	struct Record {
+		u64 tick;
+		u32 frame;
+		u32 category;
+		u32 formatId;
+		int argCount;
+		s32 args[4];
+	};
+
+	class Reader {
+	public:
+		Reader(const u8 *data, size_t size) : data(data), size(size), pos(0), failed(false) {}
+
+		bool atEnd() const { return this->pos >= this->size; }
+		bool hasFailed() const { return this->failed; }
+
+		u8 getByte() {
+			if (this->pos >= this->size) {
+				this->failed = true;
+				return 0;
+			}
+			return this->data[this->pos++];
+		}
+
+		u64 getVarint() {
+			u64 value = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				const u8 byte = this->getByte();
+				value |= (u64)(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return value;
+			}
+			this->failed = true;
+			return value;
+		}
+
+		s64 getSignedVarint() {
+			const u64 value = this->getVarint();
+			return (s64)(value >> 1) ^ -(s64)(value & 1);
+		}
+
+		const u8* getBytes(size_t count) {
+			if (this->size - this->pos < count) {
+				this->failed = true;
+				this->pos = this->size;
+				return NULL;
+			}
+			const u8 *bytes = this->data + this->pos;
+			this->pos += count;
+			return bytes;
+		}
+
+	private:
+		const u8 *data;
+		size_t size, pos;
+		bool failed;
+	};
+
+	//printf() for formats that only use integer conversions. Anything else is
+	//copied verbatim, so that a bad format string cannot crash the decoder.
+	std::string formatMessage(const std::string &format, const Record &record) {
+		std::string result;
+		int nextArg = 0;
+
+		for (size_t i = 0; i < format.size(); ++i) {
+			if (format[i] != '%') {
+				result += format[i];
+				continue;
+			}
+
+			size_t end = i + 1;
+			while (end < format.size() && strchr("-+ #0123456789.hl", format[end]))
+				++end;
+
+			if (end >= format.size()) {
+				result += format.substr(i);
+				break;
+			}
+
+			const char conversion = format[end];
+			if (conversion == '%' && end == i + 1)
+				result += '%';
+			else if (strchr("diuxXc", conversion) && nextArg < record.argCount) {
+				//Drop length modifiers; all arguments are 32-bit
+				std::string spec;
+				for (size_t k = i; k < end; ++k) {
+					if (format[k] != 'h' && format[k] != 'l')
+						spec += format[k];
+				}
+				spec += conversion;
+
+				char buffer[64];
+				snprintf(buffer, sizeof(buffer), spec.c_str(), record.args[nextArg++]);
+				result += buffer;
+			}
+			else
+				result += format.substr(i, end - i + 1);
+
+			i = end;
+		}
+
+		return result;
+	}
+
+	std::string escapeCsv(const std::string &text) {
+		std::string result = "\"";
+		for (size_t i = 0; i < text.size(); ++i) {
+			if (text[i] == '"')
+				result += '"';
+			result += text[i];
+		}
+		return result + "\"";
+	}
+
+	bool readFile(const char *path, std::vector<u8> &data) {
+		FILE *file = fopen(path, "rb");
+		if (!file)
+			return false;
+
+		u8 buffer[65536];
+		size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			data.insert(data.end(), buffer, buffer + count);
+
+		fclose(file);
+		return true;
+	}
+
+} //unnamed namespace
+
+int main(int argc, char **argv) {
+	bool isCsv = false;
+	const char *path = NULL;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--csv") == 0)
+			isCsv = true;
+		else
+			path = argv[i];
+	}
+
+	if (!path) {
+		fprintf(stderr, "Usage: %s [--csv] <log file>\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<u8> data;
+	if (!readFile(path, data)) {
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 1;
+	}
+
+	if (data.size() < sizeof(LOG_FILE_MAGIC) + 1
+		|| memcmp(&data[0], LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC)) != 0) {
+		fprintf(stderr, "%s is not a GPTP binary log\n", path);
+		return 1;
+	}
+
+	if (data[sizeof(LOG_FILE_MAGIC)] != LOG_FILE_VERSION) {
+		fprintf(stderr, "Unsupported log version %d\n", data[sizeof(LOG_FILE_MAGIC)]);
+		return 1;
+	}
+
+	//Read all chunks first, since the clock rate is stored at the end
+	std::vector<std::string> formats;
+	std::vector<Record> records;
+	u64 ticksPerSecond = 0, droppedCount = 0;
+	bool isTruncated = false;
+
+	Reader file(&data[0], data.size());
+	file.getBytes(sizeof(LOG_FILE_MAGIC) + 1);
+
+	while (!file.atEnd()) {
+		const u8 type = file.getByte();
+		const u64 payloadSize = file.getVarint();
+		const u8 *payloadData = file.getBytes((size_t)payloadSize);
+		if (file.hasFailed()) {
+			isTruncated = true;
+			break;
+		}
+
+		Reader payload(payloadData, (size_t)payloadSize);
+
+		switch (type) {
+		case CHUNK_FORMAT: {
+			const u32 id = (u32)payload.getVarint();
+			const size_t length = (size_t)payload.getVarint();
+			const u8 *text = payload.getBytes(length);
+			if (payload.hasFailed())
+				break;
+			if (formats.size() <= id)
+				formats.resize(id + 1);
+			formats[id].assign((const char*)text, length);
+			break;
+		}
+		case CHUNK_RECORDS: {
+			const u64 count = payload.getVarint();
+			Record record = {};
+			for (u64 i = 0; i < count && !payload.hasFailed(); ++i) {
+				record.tick += (u64)payload.getSignedVarint();
+				record.frame = (u32)((s64)record.frame + payload.getSignedVarint());
+				record.category = (u32)payload.getVarint();
+				record.formatId = (u32)payload.getVarint();
+				record.argCount = payload.getByte();
+				if (record.argCount > 4)
+					record.argCount = 4;
+				for (int a = 0; a < record.argCount; ++a)
+					record.args[a] = (s32)payload.getSignedVarint();
+				records.push_back(record);
+			}
+			break;
+		}
+		case CHUNK_DROPPED:
+			droppedCount = payload.getVarint();
+			break;
+		case CHUNK_CLOCK:
+			ticksPerSecond = payload.getVarint();
+			break;
+		default:
+			break;	//Unknown chunk types are skipped
+		}
+	}
+
+	if (isCsv)
+		printf("frame,tick,time_ms,category,format_id,arg0,arg1,arg2,arg3,message\n");
+
+	const u64 firstTick = records.empty() ? 0 : records[0].tick;
+
+	for (size_t i = 0; i < records.size(); ++i) {
+		const Record &record = records[i];
+		const double timeMs = ticksPerSecond
+			? (double)(s64)(record.tick - firstTick) * 1000.0 / ticksPerSecond : 0.0;
+
+		const std::string format = record.formatId < formats.size()
+			? formats[record.formatId] : std::string("<unknown format>");
+		const std::string message = formatMessage(format, record);
+
+		if (isCsv) {
+			printf("%u,%llu,%.3f,%u,%u", record.frame, record.tick, timeMs,
+				record.category, record.formatId);
+			for (int a = 0; a < 4; ++a) {
+				if (a < record.argCount)
+					printf(",%d", record.args[a]);
+				else
+					printf(",");
+			}
+			printf(",%s\n", escapeCsv(message).c_str());
+		}
+		else {
+			const char *category = record.category < sizeof(CATEGORY_NAMES) / sizeof(CATEGORY_NAMES[0])
+				? CATEGORY_NAMES[record.category] : "?";
+			printf("%8u %12.3f [%s] %s\n", record.frame, timeMs, category, message.c_str());
+		}
+	}
+
+	if (droppedCount)
+		fprintf(stderr, "Warning: %llu records were dropped while logging\n", droppedCount);
+	if (isTruncated)
+		fprintf(stderr, "Warning: the log file is truncated\n");
+
+	return 0;
+}
@@ -0,0 +1,273 @@
+//Checks graphics::Bitmap's dot, line, box and circle drawing pixel for pixel
+//against the per-pixel implementation it replaced, on random (also clipped)
+//shapes, and times each primitive with both implementations.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -DNDEBUG -include host_shim/host_shim.h -Ihost_shim -I../src -o bitmap_test
+//    bitmap_test.cpp ../src/graphics/Bitmap.cpp ../src/graphics/Font.cpp
+//    ../src/graphics/FontCache.cpp
+
+#include "host_shim/host_gdi.h"
+#include <graphics/Bitmap.h>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double elapsedMs(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	int random(int n) {
+		return std::rand() % n;
+	}
+
+	//Same layout as graphics::Bitmap
+#pragma pack(1)
+	struct BitmapData {
+		u16 width, height;
+		u8 *data;
+	};
+#pragma pack()
+
+	//The drawing functions of graphics::Bitmap before they were rewritten
+	//with span tables and unsafe fills; every pixel goes through drawDot().
+	class ReferenceBitmap {
+	public:
+		ReferenceBitmap(int width, int height, u8 *data)
+			: width(width), height(height), data(data) {}
+
+		void drawDot(int x, int y, u8 color) {
+			if (x < 0 || x >= width) return;
+			if (y < 0 || y >= height) return;
+			data[y * width + x] = color;
+		}
+
+		void drawLine(int x1, int y1, int x2, int y2, u8 color) {
+			if (y1 == y2)
+				drawHorizontalLine(x1, x2, y1, color);
+			else if (x1 == x2)
+				drawVerticalLine(x1, y1, y2, color);
+
+			if (isLineTriviallyIgnorable(x1, y1, x2, y2))
+				return;
+
+			const int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+			const int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+			int err = dx + dy;
+
+			int x = x1, y = y1;
+			drawDot(x, y, color);
+			while (x != x2 || y != y2) {
+				const int e2 = err * 2;
+				if (e2 >= dy) { err += dy; x += sx; }
+				if (e2 <= dx) { err += dx; y += sy; }
+				drawDot(x, y, color);
+			}
+		}
+
+		void drawBox(int left, int top, int right, int bottom, u8 color) {
+			if (left > right) std::swap(left, right);
+			if (right < 0 || left >= width) return;
+			if (top > bottom) std::swap(top, bottom);
+			if (bottom < 0 || top >= height) return;
+
+			const int xMin = std::max(left, 0), xMax = std::min(right, width - 1);
+			if (top >= 0)
+				fillSpan(xMin, xMax, top, color);
+			if (bottom < height)
+				fillSpan(xMin, xMax, bottom, color);
+
+			const int yMin = std::max(top, 0), yMax = std::min(bottom, height - 1);
+			for (int y = yMin; y <= yMax; ++y) {
+				if (left >= 0)
+					drawDot(left, y, color);
+				if (right < width)
+					drawDot(right, y, color);
+			}
+		}
+
+		void drawFilledBox(int left, int top, int right, int bottom, u8 color) {
+			if (left > right) std::swap(left, right);
+			if (right < 0 || left >= width) return;
+			if (top > bottom) std::swap(top, bottom);
+			if (bottom < 0 || top >= height) return;
+
+			for (int y = std::max(top, 0); y <= std::min(bottom, height - 1); ++y)
+				fillSpan(std::max(left, 0), std::min(right, width - 1), y, color);
+		}
+
+		void drawCircle(int x, int y, int radius, u8 color) {
+			if (radius <= 0) return;
+
+			int px = -radius, py = 0, err = 2 - 2 * radius;
+			do {
+				drawDot(x - px, y + py, color);
+				drawDot(x - py, y - px, color);
+				drawDot(x + px, y - py, color);
+				drawDot(x + py, y + px, color);
+				const int r = err;
+				if (r <= py) err += ++py * 2 + 1;
+				if (r > px || err > py) err += ++px * 2 + 1;
+			} while (px < 0);
+		}
+
+		void drawFilledCircle(int x, int y, int radius, u8 color) {
+			if (radius <= 0) return;
+
+			int px = -radius, py = 0, err = 2 - 2 * radius;
+			do {
+				drawHorizontalLine(x + px, x - px, y + py, color);
+				drawHorizontalLine(x + px, x - px, y - py, color);
+				const int r = err;
+				if (r <= py) err += ++py * 2 + 1;
+				if (r > px || err > py) err += ++px * 2 + 1;
+			} while (px < 0);
+		}
+
+	private:
+		int width, height;
+		u8 *data;
+
+		void fillSpan(int x1, int x2, int y, u8 color) {
+			memset(&data[y * width + x1], color, x2 - x1 + 1);
+		}
+
+		void drawHorizontalLine(int x1, int x2, int y, u8 color) {
+			if (y < 0 || y >= height) return;
+			if (x1 > x2) std::swap(x1, x2);
+			if (x2 < 0 || x1 >= width) return;
+			fillSpan(std::max(x1, 0), std::min(x2, width - 1), y, color);
+		}
+
+		void drawVerticalLine(int x, int y1, int y2, u8 color) {
+			if (x < 0 || x >= width) return;
+			if (y1 > y2) std::swap(y1, y2);
+			if (y2 < 0 || y1 >= height) return;
+			for (int y = std::max(y1, 0); y <= std::min(y2, height - 1); ++y)
+				drawDot(x, y, color);
+		}
+
+		int computeOutcode(int x, int y) const {
+			return (x < 0 ? 1 : 0) | (x >= width ? 2 : 0) | (y < 0 ? 4 : 0) | (y >= height ? 8 : 0);
+		}
+
+		bool isLineTriviallyIgnorable(int x1, int y1, int x2, int y2) const {
+			return (computeOutcode(x1, y1) & computeOutcode(x2, y2)) != 0;
+		}
+	};
+
+	enum Primitive { DOT, LINE, BOX, FILLED_BOX, CIRCLE, FILLED_CIRCLE, PRIMITIVE_COUNT };
+	const char *const primitiveNames[] = { "dot", "line", "box", "filled box", "circle", "filled circle" };
+
+	struct Shape {
+		int primitive;
+		int a, b, c, d;		//x1, y1, x2, y2 or x, y, radius
+		u8 color;
+	};
+
+	//Random shape, often partly or entirely outside the bitmap. Lines and boxes
+	//are made horizontal / vertical / degenerate now and then.
+	Shape makeRandomShape(int primitive, int width, int height) {
+		Shape s;
+		s.primitive = primitive;
+		s.a = random(width + 260) - 130;
+		s.b = random(height + 220) - 110;
+		if (primitive == CIRCLE || primitive == FILLED_CIRCLE) {
+			s.c = random(random(10) == 0 ? 600 : 120);
+			s.d = 0;
+		}
+		else {
+			s.c = random(width + 260) - 130;
+			s.d = random(height + 220) - 110;
+			if (random(7) == 0) s.d = s.b;
+			if (random(11) == 0) s.c = s.a;
+		}
+		s.color = (u8)random(256);
+		return s;
+	}
+
+	//Random shape that lies mostly inside the bitmap, as most HUD shapes do
+	Shape makeTypicalShape(int primitive, int width, int height) {
+		Shape s;
+		s.primitive = primitive;
+		s.a = 70 + random(width - 140);
+		s.b = 70 + random(height - 140);
+		if (primitive == CIRCLE || primitive == FILLED_CIRCLE) {
+			s.c = 1 + random(60);
+			s.d = 0;
+		}
+		else {
+			s.c = s.a + random(60);
+			s.d = s.b + random(60);
+		}
+		s.color = 7;
+		return s;
+	}
+
+	template <class BitmapType>
+	void draw(BitmapType *bitmap, const Shape &s) {
+		switch (s.primitive) {
+		case DOT: bitmap->drawDot(s.a, s.b, s.color); break;
+		case LINE: bitmap->drawLine(s.a, s.b, s.c, s.d, s.color); break;
+		case BOX: bitmap->drawBox(s.a, s.b, s.c, s.d, s.color); break;
+		case FILLED_BOX: bitmap->drawFilledBox(s.a, s.b, s.c, s.d, s.color); break;
+		case CIRCLE: bitmap->drawCircle(s.a, s.b, s.c, s.color); break;
+		case FILLED_CIRCLE: bitmap->drawFilledCircle(s.a, s.b, s.c, s.color); break;
+		}
+	}
+
+} //unnamed namespace
+
+int main() {
+	const int WIDTH = 640, HEIGHT = 480;
+	std::vector<u8> expectedPixels(WIDTH * HEIGHT), actualPixels(WIDTH * HEIGHT);
+
+	ReferenceBitmap reference(WIDTH, HEIGHT, expectedPixels.data());
+	BitmapData bitmapData = { WIDTH, HEIGHT, actualPixels.data() };
+	graphics::Bitmap *bitmap = reinterpret_cast<graphics::Bitmap*>(&bitmapData);
+
+	std::srand(1);
+	long mismatches = 0;
+
+	for (int i = 0; i < 300000; ++i) {
+		const Shape s = makeRandomShape(random(PRIMITIVE_COUNT), WIDTH, HEIGHT);
+		draw(&reference, s);
+		draw(bitmap, s);
+
+		if (expectedPixels != actualPixels) {
+			if (mismatches < 5)
+				std::printf("mismatch: %s (%d, %d, %d, %d)\n",
+					primitiveNames[s.primitive], s.a, s.b, s.c, s.d);
+			++mismatches;
+			actualPixels = expectedPixels;
+		}
+	}
+
+	std::printf("300000 random shapes, %ld mismatches\n", mismatches);
+
+	//Benchmark
+	for (int primitive = 0; primitive < PRIMITIVE_COUNT; ++primitive) {
+		std::vector<Shape> shapes;
+		for (int i = 0; i < 300000; ++i)
+			shapes.push_back(makeTypicalShape(primitive, WIDTH, HEIGHT));
+
+		Clock::time_point start = Clock::now();
+		for (unsigned int i = 0; i < shapes.size(); ++i)
+			draw(&reference, shapes[i]);
+		const double referenceMs = elapsedMs(start);
+
+		start = Clock::now();
+		for (unsigned int i = 0; i < shapes.size(); ++i)
+			draw(bitmap, shapes[i]);
+		const double bitmapMs = elapsedMs(start);
+
+		std::printf("%-14s previous %7.1f ms, Bitmap %7.1f ms (300000 shapes)\n",
+			primitiveNames[primitive], referenceMs, bitmapMs);
+	}
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+//Compares hooks::getDetectorVisibility() (detector_util.cpp) with the
+//per-pair check that getCloakedTargetVisibility() used before the detection
+//map, on 300 random unit layouts. For every target, the flags OR-ed over all
+//detectors must be the same.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o detection_map_test
+//    detection_map_test.cpp ../src/hooks/detector_util.cpp
+//
+//Each layout has up to 400 units with random unit bounds, owners, sprite
+//visibility, shared vision and Parasite flags. A third of the units are
+//detectors, a third of them buildings (224 pixel range); the others use a
+//random sight range. Layouts range from a few tiles to a whole map, so that
+//both crowded and sparse detection maps are tested.
+
+#include "host_shim/host_units.h"
+#include <hooks/detector.h>
+#include <cstdio>
+
+namespace {
+
+	const int LAYOUT_COUNT = 300;
+
+	bool canDetect[UNIT_ARRAY_LENGTH + 1];
+	u32 sightRange[UNIT_ARRAY_LENGTH + 1];
+
+	//getCloakedTargetVisibility() before the detection map
+	u32 getCloakedTargetVisibilityOld(const CUnit *unit, const CUnit* target) {
+		if (target->status & UnitStatus::IsHallucination)
+			return 0;
+
+		if (hooks::unitCanDetectHook(unit) && unit != target) {
+			if (target->sprite->isVisibleTo(unit->playerId)) {
+				u32 detectionRange;
+
+				if (unit->status & UnitStatus::GroundedBuilding)
+					detectionRange = 224;
+				else
+					detectionRange = 32 * unit->getSightRange();
+
+				if (unit->getDistanceToTarget(target) <= detectionRange)
+					return ((1 << unit->playerId) | playerVision->flags[unit->playerId] | unit->parasiteFlags);
+			}
+		}
+
+		return 0;
+	}
+
+	u32 getCloakedTargetVisibilityNew(const CUnit *unit, const CUnit* target) {
+		if (target->status & UnitStatus::IsHallucination)
+			return 0;
+		return hooks::getDetectorVisibility(unit, target);
+	}
+
+	void makeRandomUnitBounds() {
+		Box16 *bounds = (Box16*)units_dat::UnitBounds;
+		for (int i = 0; i < UNIT_TYPE_COUNT; ++i) {
+			bounds[i].left = (u16)host::random(64);
+			bounds[i].right = (u16)host::random(64);
+			bounds[i].top = (u16)host::random(64);
+			bounds[i].bottom = (u16)host::random(64);
+		}
+	}
+
+	//Places @p unitCount random units in a square of @p areaSize pixels
+	void makeRandomLayout(int unitCount, int areaSize) {
+		host::clearUnits();
+
+		for (int player = 0; player < 8; ++player) {
+			u32 &flags = ((u32*)playerVision->flags)[player];
+			flags = host::random(4) == 0 ? host::random(256) : 0;
+		}
+
+		for (int i = 1; i <= unitCount; ++i) {
+			CUnit *unit = host::setUnit((u16)i, (u16)host::random(UNIT_TYPE_COUNT),
+				host::random(areaSize), host::random(areaSize));
+			unit->playerId = (u8)host::random(8);
+			unit->sprite->visibilityFlags = (u8)host::random(256);
+			unit->status = host::random(3) == 0 ? UnitStatus::GroundedBuilding : 0;
+			if (host::random(20) == 0)
+				unit->status |= UnitStatus::IsHallucination;
+			unit->parasiteFlags = host::random(10) == 0 ? (u8)host::random(256) : 0;
+
+			canDetect[i] = host::random(3) == 0;
+			sightRange[i] = (u32)host::random(13);
+		}
+
+		host::linkVisibleUnits();
+	}
+
+	long checkCount = 0, visibleCount = 0, mismatches = 0;
+
+	void compareLayout(int layout, int unitCount) {
+		for (int t = 1; t <= unitCount; ++t) {
+			const CUnit *target = CUnit::getFromIndex((u16)t);
+			u32 expected = 0, actual = 0;
+
+			//Like StarCraft, ask every detector about the target
+			for (int d = 1; d <= unitCount; ++d) {
+				const CUnit *detector = CUnit::getFromIndex((u16)d);
+				expected |= getCloakedTargetVisibilityOld(detector, target);
+				actual |= getCloakedTargetVisibilityNew(detector, target);
+			}
+
+			++checkCount;
+			if (expected)
+				++visibleCount;
+			if (expected != actual) {
+				if (mismatches < 5)
+					std::printf("Layout %d, target %d: expected 0x%X, got 0x%X\n", layout, t, expected, actual);
+				++mismatches;
+			}
+		}
+	}
+
+} //unnamed namespace
+
+//-------- Hooks normally defined in detector.cpp / CUnit.cpp --------//
+
+namespace hooks {
+
+	bool unitCanDetectHook(const CUnit *unit) {
+		return canDetect[unit->getIndex()];
+	}
+
+	u32 getDetectionRange(const CUnit *unit) {
+		if (unit->status & UnitStatus::GroundedBuilding)
+			return 224;
+		else
+			return 32 * unit->getSightRange();
+	}
+
+} //hooks
+
+u32 CUnit::getSightRange(bool) const {
+	return sightRange[this->getIndex()];
+}
+
+int main() {
+	std::srand(1234);
+	makeRandomUnitBounds();
+	hooks::resetDetectionMap();
+
+	for (int layout = 0; layout < LAYOUT_COUNT; ++layout) {
+		//The detection map is rebuilt on the first query of each frame
+		*(u32*)elapsedTimeFrames = layout;
+
+		const int unitCount = 1 + host::random(400);
+		makeRandomLayout(unitCount, 256 + host::random(4000));
+		compareLayout(layout, unitCount);
+	}
+
+	std::printf("%d layouts, %ld targets (%ld detected)\n", LAYOUT_COUNT, checkCount, visibleCount);
+	std::printf("%ld mismatches\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,415 @@
+//Checks the distance kernels of scbw::UnitSnapshot against the scalar
+//functions they replace, and times both:
+//
+//  - getDistancesFast() against scbw::getDistanceFast(), for every (dx, dy)
+//    in [-2048, 2048) x [-2048, 2048), and for random points over the whole
+//    s16 range
+//  - getBoxDistances() against the edge distance of CUnit::getDistanceToTarget(),
+//    for random boxes (including inverted ones)
+//  - UnitFinder::getNearestTarget() against the scalar search it replaced, on
+//    random unit layouts: same result, and match() called for the same units
+//    in the same order
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o distance_kernels_test
+//    distance_kernels_test.cpp ../src/SCBW/UnitSnapshot.cpp ../src/SCBW/UnitFinder.cpp
+//
+//Every count from 1 to 20 is used, so that the 8-wide, 4-wide and scalar
+//parts of the kernels are all tested.
+
+#include "host_shim/host_units.h"
+#include <SCBW/UnitFinder.h>
+#include <SCBW/UnitSnapshot.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+	using scbw::UnitSnapshot;
+
+	double elapsedMs(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	inline s16 randomS16() {
+		return (s16)(std::rand() & 0xFFFF);
+	}
+
+	//Edge distance, as in CUnit::getDistanceToTarget()
+	u32 getBoxDistanceScalar(s32 left, s32 top, s32 right, s32 bottom,
+		s32 targetLeft, s32 targetTop, s32 targetRight, s32 targetBottom)
+	{
+		s32 dx = left - targetRight - 1;
+		if (dx < 0) {
+			dx = targetLeft - right - 1;
+			if (dx < 0)
+				dx = 0;
+		}
+
+		s32 dy = top - targetBottom - 1;
+		if (dy < 0) {
+			dy = targetTop - bottom - 1;
+			if (dy < 0)
+				dy = 0;
+		}
+
+		return scbw::getDistanceFast(0, 0, dx, dy);
+	}
+
+	const int MAX_TARGETS = 4096;
+	s16 targetX[MAX_TARGETS], targetY[MAX_TARGETS];
+	s16 targetLeft[MAX_TARGETS], targetTop[MAX_TARGETS], targetRight[MAX_TARGETS], targetBottom[MAX_TARGETS];
+	u32 distances[MAX_TARGETS];
+
+	long checkCount = 0, mismatches = 0;
+
+	void checkDistancesFast() {
+		//Every offset in a 4096 x 4096 square, one row at a time
+		for (int dy = -2048; dy < 2048; ++dy) {
+			for (int i = 0; i < 4096; ++i) {
+				targetX[i] = (s16)(i - 2048);
+				targetY[i] = (s16)dy;
+			}
+			UnitSnapshot::getDistancesFast(0, 0, targetX, targetY, 4096, distances);
+
+			for (int i = 0; i < 4096; ++i, ++checkCount) {
+				if (distances[i] != scbw::getDistanceFast(0, 0, targetX[i], targetY[i]))
+					++mismatches;
+			}
+		}
+
+		//Random sources and targets over the whole s16 range
+		for (int trial = 0; trial < 200000; ++trial) {
+			const int count = 1 + trial % 20;
+			const s32 x = randomS16(), y = randomS16();
+			for (int i = 0; i < count; ++i) {
+				targetX[i] = randomS16();
+				targetY[i] = randomS16();
+			}
+			UnitSnapshot::getDistancesFast(x, y, targetX, targetY, count, distances);
+
+			for (int i = 0; i < count; ++i, ++checkCount) {
+				if (distances[i] != scbw::getDistanceFast(x, y, targetX[i], targetY[i]))
+					++mismatches;
+			}
+		}
+	}
+
+	void checkBoxDistances() {
+		for (int trial = 0; trial < 200000; ++trial) {
+			const int count = 1 + trial % 20;
+			const int span = trial & 1 ? 65536 : 600;
+			const int inverted = trial % 7 == 0 ? 60 : 0;
+			auto randomPosition = [span]() { return (s16)(std::rand() % span - span / 2); };
+
+			const s32 left = randomPosition(), top = randomPosition();
+			const s32 right = left + std::rand() % 130 - inverted, bottom = top + std::rand() % 130;
+			for (int i = 0; i < count; ++i) {
+				targetLeft[i] = randomPosition();
+				targetTop[i] = randomPosition();
+				targetRight[i] = (s16)(targetLeft[i] + std::rand() % 130 - inverted);
+				targetBottom[i] = (s16)(targetTop[i] + std::rand() % 130);
+			}
+			UnitSnapshot::getBoxDistances(left, top, right, bottom,
+				targetLeft, targetTop, targetRight, targetBottom, count, distances);
+
+			for (int i = 0; i < count; ++i, ++checkCount) {
+				if (distances[i] != getBoxDistanceScalar(left, top, right, bottom,
+					targetLeft[i], targetTop[i], targetRight[i], targetBottom[i]))
+					++mismatches;
+			}
+		}
+	}
+
+	//-------- getNearestTarget() --------//
+
+	//Not inlined or optimized across calls, like the UnitFinder functions
+	//defined in UnitFinder.cpp (the old search called them on every step)
+	__attribute__((noipa)) UnitFinderData* getStartX() { return unitOrderingX; }
+	__attribute__((noipa)) UnitFinderData* getStartY() { return unitOrderingY; }
+	__attribute__((noipa)) UnitFinderData* getEndX() { return unitOrderingX + *unitOrderingCount; }
+	__attribute__((noipa)) UnitFinderData* getEndY() { return unitOrderingY + *unitOrderingCount; }
+
+	//UnitFinder::getNearest() before it used UnitSnapshot::getDistancesFast()
+	template <class Callback>
+	CUnit* getNearestScalar(int x, int y,
+		int boundsLeft, int boundsTop, int boundsRight, int boundsBottom,
+		UnitFinderData* left, UnitFinderData* top,
+		UnitFinderData* right, UnitFinderData* bottom,
+		Callback &match, const CUnit *sourceUnit)
+	{
+		using scbw::getDistanceFast;
+
+		int bestDistance = getDistanceFast(0, 0,
+			std::max(x - boundsLeft, boundsRight - x),
+			std::max(y - boundsTop, boundsBottom - y));
+
+		CUnit *bestUnit = nullptr;
+		bool canContinueSearch, hasFoundBestUnit;
+
+		do {
+			canContinueSearch = false;
+			hasFoundBestUnit = false;
+
+			//Search to the left
+			if (getStartX() <= left) {
+				CUnit *unit = CUnit::getFromIndex(left->unitIndex);
+
+				if (boundsLeft <= unit->getX()) {
+					if (boundsTop <= unit->getY() && unit->getY() < boundsBottom) {
+						if (unit != sourceUnit && match(unit)) {
+							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
+							if (distance < bestDistance) {
+								bestDistance = distance;
+								bestUnit = unit;
+								hasFoundBestUnit = true;
+							}
+						}
+					}
+				}
+				else
+					left = getStartX() - 1;
+
+				canContinueSearch = true;
+				--left;
+			}
+
+			//Search to the right
+			if (right < getEndX()) {
+				CUnit *unit = CUnit::getFromIndex(right->unitIndex);
+
+				if (unit->getX() < boundsRight) {
+					if (boundsTop <= unit->getY() && unit->getY() < boundsBottom) {
+						if (unit != sourceUnit && match(unit)) {
+							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
+							if (distance < bestDistance) {
+								bestDistance = distance;
+								bestUnit = unit;
+								hasFoundBestUnit = true;
+							}
+						}
+					}
+				}
+				else
+					right = getEndX();
+
+				canContinueSearch = true;
+				++right;
+			}
+
+			//Search upwards
+			if (getStartY() <= top) {
+				CUnit *unit = CUnit::getFromIndex(top->unitIndex);
+
+				if (boundsTop <= unit->getY()) {
+					if (boundsLeft <= unit->getX() && unit->getX() < boundsRight) {
+						if (unit != sourceUnit && match(unit)) {
+							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
+							if (distance < bestDistance) {
+								bestDistance = distance;
+								bestUnit = unit;
+								hasFoundBestUnit = true;
+							}
+						}
+					}
+				}
+				else
+					top = getStartY() - 1;
+
+				canContinueSearch = true;
+				--top;
+			}
+
+			//Search downwards
+			if (bottom < getEndY()) {
+				CUnit *unit = CUnit::getFromIndex(bottom->unitIndex);
+
+				if (unit->getY() < boundsBottom) {
+					if (boundsLeft <= unit->getX() && unit->getX() < boundsRight) {
+						if (unit != sourceUnit && match(unit)) {
+							int distance = getDistanceFast(x, y, unit->getX(), unit->getY());
+							if (distance < bestDistance) {
+								bestDistance = distance;
+								bestUnit = unit;
+								hasFoundBestUnit = true;
+							}
+						}
+					}
+				}
+				else
+					bottom = getEndY();
+
+				canContinueSearch = true;
+				++bottom;
+			}
+
+			//Reduce the search bounds
+			if (hasFoundBestUnit) {
+				boundsLeft = std::max(boundsLeft, x - bestDistance);
+				boundsRight = std::min(boundsRight, x + bestDistance);
+				boundsTop = std::max(boundsTop, y - bestDistance);
+				boundsBottom = std::max(boundsBottom, y + bestDistance);
+			}
+		} while (canContinueSearch);
+
+		return bestUnit;
+	}
+
+	//UnitFinder::getNearestTarget() for a source with a hidden sprite, with
+	//getNearestScalar()
+	template <class Callback>
+	CUnit* getNearestTargetScalar(int left, int top, int right, int bottom,
+		const CUnit* sourceUnit, Callback& match)
+	{
+		UnitFinderData temp;
+		temp.position = sourceUnit->getX();
+		UnitFinderData *searchRight = std::lower_bound(getStartX(), getEndX(), temp);
+		temp.position = sourceUnit->getY();
+		UnitFinderData *searchBottom = std::lower_bound(getStartY(), getEndY(), temp);
+
+		return getNearestScalar(sourceUnit->getX(), sourceUnit->getY(),
+			left, top, right, bottom,
+			searchRight - 1, searchBottom - 1, searchRight, searchBottom,
+			match, sourceUnit);
+	}
+
+	bool isMatching[UNIT_ARRAY_LENGTH + 1];
+	std::vector<u16> matchCalls;
+
+	void makeRandomLayout(int unitCount, int areaSize) {
+		host::clearUnits();
+		for (int i = 1; i <= unitCount; ++i) {
+			CUnit *unit = host::setUnit((u16)i, (u16)host::random(UNIT_TYPE_COUNT),
+				host::random(areaSize), host::random(areaSize));
+			unit->sprite->flags = 0x20;		//Hidden, so that finderIndex is not used
+			isMatching[i] = host::random(4) != 0;
+		}
+		host::buildUnitOrdering();
+	}
+
+	void checkNearestTarget(int layoutCount) {
+		auto match = [](CUnit *unit) {
+			matchCalls.push_back(unit->getIndex());
+			return isMatching[unit->getIndex()];
+		};
+
+		for (int layout = 0; layout < layoutCount; ++layout) {
+			const int unitCount = 1 + host::random(1000);
+			const int areaSize = 64 + host::random(4096);
+			makeRandomLayout(unitCount, areaSize);
+
+			for (int q = 0; q < 20; ++q) {
+				const CUnit *source = CUnit::getFromIndex((u16)(1 + host::random(unitCount)));
+				const int left = host::random(areaSize), top = host::random(areaSize);
+				const int right = left + host::random(areaSize), bottom = top + host::random(areaSize);
+
+				matchCalls.clear();
+				const CUnit *expected = getNearestTargetScalar(left, top, right, bottom, source, match);
+				const std::vector<u16> expectedCalls = matchCalls;
+
+				matchCalls.clear();
+				const CUnit *actual = scbw::UnitFinder::getNearestTarget(left, top, right, bottom, source, match);
+
+				++checkCount;
+				if (expected != actual || expectedCalls != matchCalls)
+					++mismatches;
+			}
+		}
+	}
+
+	//-------- Benchmarks --------//
+
+	volatile u32 sink;
+
+	void benchmarkKernels() {
+		const int TARGETS = UNIT_ARRAY_LENGTH, ROUNDS = 20000;
+		for (int i = 0; i < TARGETS; ++i) {
+			targetX[i] = (s16)host::random(8192);
+			targetY[i] = (s16)host::random(8192);
+			targetLeft[i] = targetX[i] - 16;
+			targetRight[i] = targetX[i] + 16;
+			targetTop[i] = targetY[i] - 16;
+			targetBottom[i] = targetY[i] + 16;
+		}
+
+		Clock::time_point start = Clock::now();
+		for (int r = 0; r < ROUNDS; ++r) {
+			for (int i = 0; i < TARGETS; ++i)
+				distances[i] = scbw::getDistanceFast(r & 4095, 100, targetX[i], targetY[i]);
+			sink += distances[r % TARGETS];
+		}
+		const double scalarPointMs = elapsedMs(start);
+
+		start = Clock::now();
+		for (int r = 0; r < ROUNDS; ++r) {
+			UnitSnapshot::getDistancesFast(r & 4095, 100, targetX, targetY, TARGETS, distances);
+			sink += distances[r % TARGETS];
+		}
+		const double simdPointMs = elapsedMs(start);
+
+		start = Clock::now();
+		for (int r = 0; r < ROUNDS; ++r) {
+			for (int i = 0; i < TARGETS; ++i)
+				distances[i] = getBoxDistanceScalar(r & 4095, 100, (r & 4095) + 32, 132,
+					targetLeft[i], targetTop[i], targetRight[i], targetBottom[i]);
+			sink += distances[r % TARGETS];
+		}
+		const double scalarBoxMs = elapsedMs(start);
+
+		start = Clock::now();
+		for (int r = 0; r < ROUNDS; ++r) {
+			UnitSnapshot::getBoxDistances(r & 4095, 100, (r & 4095) + 32, 132,
+				targetLeft, targetTop, targetRight, targetBottom, TARGETS, distances);
+			sink += distances[r % TARGETS];
+		}
+		const double simdBoxMs = elapsedMs(start);
+
+		const double perTarget = 1e6 / ((double)ROUNDS * TARGETS);
+		std::printf("Point distances: scalar %.3f ns, SSE2 %.3f ns per target\n",
+			scalarPointMs * perTarget, simdPointMs * perTarget);
+		std::printf("Box distances:   scalar %.3f ns, SSE2 %.3f ns per target\n",
+			scalarBoxMs * perTarget, simdBoxMs * perTarget);
+	}
+
+	void benchmarkNearestTarget() {
+		const int QUERIES = 200000;
+		makeRandomLayout(UNIT_ARRAY_LENGTH, 2048);
+
+		auto match = [](CUnit *unit) { return isMatching[unit->getIndex()] && unit->getX() & 1; };
+		std::vector<CUnit*> sources;
+		for (int q = 0; q < QUERIES; ++q)
+			sources.push_back(CUnit::getFromIndex((u16)(1 + host::random(UNIT_ARRAY_LENGTH))));
+
+		Clock::time_point start = Clock::now();
+		for (int q = 0; q < QUERIES; ++q)
+			sink += (u32)(size_t)getNearestTargetScalar(0, 0, 2048, 2048, sources[q], match);
+		const double oldMs = elapsedMs(start);
+
+		start = Clock::now();
+		for (int q = 0; q < QUERIES; ++q)
+			sink += (u32)(size_t)scbw::UnitFinder::getNearestTarget(0, 0, 2048, 2048, sources[q], match);
+		const double newMs = elapsedMs(start);
+
+		std::printf("getNearestTarget() (%d units): old %.3f us, new %.3f us per query\n",
+			UNIT_ARRAY_LENGTH, oldMs * 1000 / QUERIES, newMs * 1000 / QUERIES);
+	}
+
+} //unnamed namespace
+
+int main() {
+	std::srand(23);
+
+	checkDistancesFast();
+	checkBoxDistances();
+	checkNearestTarget(500);
+	std::printf("%ld checks\n", checkCount);
+
+	benchmarkKernels();
+	benchmarkNearestTarget();
+
+	std::printf("%ld mismatches\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
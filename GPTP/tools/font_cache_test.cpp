@@ -0,0 +1,302 @@
+//Checks graphics::Bitmap::blitString(), which draws through the glyph and
+//layout caches in FontCache.cpp, pixel for pixel against the per-pixel
+//implementation it replaced, on random fonts and strings (with color,
+//alignment and Korean characters), and times both on a typical HUD string.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -DNDEBUG -include host_shim/host_shim.h -Ihost_shim -I../src -o font_cache_test
+//    font_cache_test.cpp ../src/graphics/Bitmap.cpp ../src/graphics/Font.cpp
+//    ../src/graphics/FontCache.cpp
+//
+//Run with "korean" as the argument to check Korean characters as well. The
+//text layout cache reads the system language once, so the two modes need
+//separate runs.
+
+#include "host_shim/host_gdi.h"
+#include <graphics/Bitmap.h>
+#include <graphics/Font.h>
+#include <graphics/FontCache.h>
+#include <SCBW/scbwdata.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double elapsedMs(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	int random(int n) {
+		return std::rand() % n;
+	}
+
+	//Same layout as graphics::Bitmap
+#pragma pack(1)
+	struct BitmapData {
+		u16 width, height;
+		u8 *data;
+	};
+#pragma pack()
+
+	using graphics::Font;
+	using graphics::FontChar;
+	using graphics::gbColorTable;
+	using graphics::gbFontColors;
+
+	//Bitmap::blitString() and Bitmap::blitKoreanChar() before the caches were
+	//added; every glyph is decoded and every string measured on each call.
+	class ReferenceBitmap {
+	public:
+		ReferenceBitmap(int width, int height, u8 *data)
+			: width(width), height(height), data(data) {}
+
+		bool blitString(const char *pszStr, int x, int y, u8 size) {
+			if (size > 3 || !pszStr)
+				return false;
+
+			Font *fnt = fontBase[size];
+			if (!fnt)
+				return false;
+
+			if (x + fnt->getTextWidth(pszStr) < 0 ||
+				y + fnt->getTextHeight(pszStr) < 0 ||
+				x >= width || y >= height)
+				return false;
+
+			const u8 *pbChars = (u8*)pszStr;
+
+			u8 lastColor = 0, color = 0;
+			int Xoffset = x, Yoffset = y;
+
+			for (int c = 0; pbChars[c]; ++c) {
+				if (pbChars[c] <= ' ') {
+					switch (pbChars[c]) {
+					case 1:
+						color = lastColor;
+						continue;
+					case '\t':
+						Xoffset += fnt->getCharWidth(pbChars[c]);
+						continue;
+					case '\n':
+						Xoffset = x;
+						Yoffset += fnt->maxHeight();
+						continue;
+					case 11:
+					case 20:
+						color = (u8)~0;
+						continue;
+					case '\f':
+						break;
+					case '\r':
+					case 26:
+						continue;
+					case 18:
+						Xoffset += width - fnt->getTextWidth(pszStr) - x;
+						continue;
+					case 19:
+						Xoffset += (width - fnt->getTextWidth(pszStr)) / 2 - x;
+						continue;
+					case ' ':
+						Xoffset += fnt->maxWidth() / 2;
+						continue;
+					default:
+						lastColor = color;
+						color = gbColorTable[pbChars[c]];
+						continue;
+					}
+				}
+
+				if (GetUserDefaultLangID() == MAKELANGID(LANG_KOREAN, SUBLANG_KOREAN)
+					&& IsDBCSLeadByte(pbChars[c])
+					&& !(pbChars[c] == 169 || pbChars[c] == 153)) {
+					blitKoreanChar((char*)&pbChars[c], Xoffset, Yoffset, color);
+					if (pbChars[++c])
+						continue;
+					break;
+				}
+
+				FontChar *fntChr = fnt->getChar(pbChars[c]);
+				if (!fntChr)
+					continue;
+
+				if (color != ~0) {
+					for (int i = 0, pos = 0; pos < fntChr->getHeight() * fntChr->getWidth(); ++i, ++pos) {
+						pos += fntChr->pixelOffset(i);
+
+						int newX = Xoffset + (fntChr->getX() + pos % fntChr->getWidth());
+						if (newX >= width) break;
+						if (newX < 0) continue;
+
+						int newY = Yoffset + (fntChr->getY() + pos / fntChr->getWidth());
+						if (newY >= height) break;
+						if (newY < 0) continue;
+
+						int offset = newY * width + newX;
+						if (offset >= width * height) break;
+						if (offset < 0) continue;
+
+						data[offset] = gbFontColors[color][fntChr->colorMask(i)];
+					}
+				}
+
+				Xoffset += fntChr->getWidth();
+			}
+			return true;
+		}
+
+	private:
+		int width, height;
+		u8 *data;
+
+		void drawDot(int x, int y, u8 color) {
+			if (x < 0 || x >= width) return;
+			if (y < 0 || y >= height) return;
+			data[y * width + x] = color;
+		}
+
+		//Only the parts that depend on the fake GDI in host_gdi.h
+		void blitKoreanChar(const char *ch, int &x, int &y, u8 color) {
+			char koreanChars[3] = { ch[0], ch[1], '\0' };
+
+			RECT chRect = {};
+			DrawText(0, koreanChars, strlen(koreanChars), &chRect, DT_CALCRECT);
+			DrawText(0, koreanChars, strlen(koreanChars), &chRect, 0);
+
+			static u8 bitmapBuffer[32 * 32];
+			GetBitmapBits(0, 32 * chRect.bottom, bitmapBuffer);
+
+			for (int yOff = 0; yOff < chRect.bottom; ++yOff) {
+				for (int xOff = 0; xOff < chRect.right; ++xOff) {
+					if (bitmapBuffer[xOff + 32 * yOff]) {
+						drawDot(x + xOff + 1, y + yOff + 3, gbFontColors[color][0]);
+						drawDot(x + xOff, y + yOff + 2, gbFontColors[color][1]);
+					}
+				}
+			}
+
+			x += chRect.right;
+		}
+	};
+
+	//Builds a font with characters 1-255. Some characters are missing (they
+	//point back at the font header, as in StarCraft's fonts), and the glyph
+	//data has random pixel offsets and color masks.
+	Font* makeRandomFont() {
+		const int low = 1, high = 255, charCount = high - low + 1;
+		u8 *font = (u8*)calloc(8 + sizeof(void*) * charCount, 1);
+		*(u32*)font = 0x544E4F46;	//"FONT"
+		font[4] = low;
+		font[5] = high;
+		font[6] = (u8)(6 + random(10));	//Max width
+		font[7] = (u8)(8 + random(10));	//Max height
+
+		for (int i = 0; i < charCount; ++i) {
+			void *fontChar = font;
+			if (random(9) != 0) {
+				const int width = 1 + random(12), height = 1 + random(14);
+				u8 *chr = (u8*)malloc(4 + width * height + 8);
+				chr[0] = (u8)width;
+				chr[1] = (u8)height;
+				chr[2] = (u8)random(3);
+				chr[3] = (u8)random(4);
+				for (int k = 0; k < width * height + 4; ++k) {
+					const int skip = random(4) == 0 ? random(32) : 0;
+					chr[4 + k] = (u8)((skip << 3) | random(8));
+				}
+				fontChar = chr;
+			}
+			memcpy(font + 8 + sizeof(void*) * i, &fontChar, sizeof(void*));
+		}
+
+		return (Font*)font;
+	}
+
+	std::string makeRandomString() {
+		static const char codes[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 13, 14, 15, 16,
+			17, 18, 19, 21, 22, 26, 27, 31, ' ' };
+
+		std::string str;
+		const int length = random(30);
+		for (int i = 0; i < length; ++i) {
+			const int r = random(10);
+			if (r < 6)
+				str += (char)(33 + random(90));
+			else if (r < 8)
+				str += codes[random(sizeof(codes))];
+			else
+				str += (char)(128 + random(128));
+		}
+		return str;
+	}
+
+	//Draws random strings at random positions (often clipped) with both
+	//implementations; returns the number of mismatches.
+	long compare(const std::vector<std::string> &strings, int width, int height) {
+		std::vector<u8> expectedPixels(width * height), actualPixels(width * height);
+		ReferenceBitmap reference(width, height, expectedPixels.data());
+		BitmapData bitmapData = { (u16)width, (u16)height, actualPixels.data() };
+		graphics::Bitmap *bitmap = reinterpret_cast<graphics::Bitmap*>(&bitmapData);
+
+		long mismatches = 0;
+		for (int i = 0; i < 60000; ++i) {
+			const std::string &str = strings[random(strings.size())];
+			const int x = random(width + 200) - 150, y = random(height + 60) - 40;
+			const u8 size = (u8)random(5);
+
+			const bool expected = reference.blitString(str.c_str(), x, y, size);
+			const bool actual = bitmap->blitString(str.c_str(), x, y, size);
+			if (expected != actual || expectedPixels != actualPixels) {
+				if (mismatches < 5)
+					std::printf("mismatch: %d x %d, string %d at (%d, %d), size %d\n",
+						width, height, (int)(&str - &strings[0]), x, y, size);
+				++mismatches;
+				actualPixels = expectedPixels;
+			}
+		}
+		return mismatches;
+	}
+
+} //unnamed namespace
+
+int main(int argc, char **argv) {
+	host::isKoreanSystem = argc > 1 && strcmp(argv[1], "korean") == 0;
+	std::srand(5);
+	for (int size = 0; size < 4; ++size)
+		fontBase[size] = makeRandomFont();
+
+	std::vector<std::string> strings;
+	for (int i = 0; i < 300; ++i)
+		strings.push_back(makeRandomString());
+	strings.push_back("\x12Right aligned");
+	strings.push_back("\x13" "Center\nline two\x13 centered");
+
+	const long mismatches = compare(strings, 640, 480) + compare(strings, 97, 41);
+	std::printf("%s: 120000 strings drawn, %ld mismatches\n",
+		host::isKoreanSystem ? "Korean system" : "other system", mismatches);
+
+	//Benchmark
+	const char *const hudString = "\x04Minerals: 1234  \x03Gas: 567";
+	std::vector<u8> pixels(640 * 480);
+	ReferenceBitmap reference(640, 480, pixels.data());
+	BitmapData bitmapData = { 640, 480, pixels.data() };
+	graphics::Bitmap *bitmap = reinterpret_cast<graphics::Bitmap*>(&bitmapData);
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < 200000; ++i)
+		reference.blitString(hudString, 10 + i % 300, 20 + i % 200, 1);
+	const double referenceMs = elapsedMs(start);
+
+	start = Clock::now();
+	for (int i = 0; i < 200000; ++i)
+		bitmap->blitString(hudString, 10 + i % 300, 20 + i % 200, 1);
+	const double bitmapMs = elapsedMs(start);
+
+	std::printf("HUD string x 200000: previous %.1f ms, cached %.1f ms\n", referenceMs, bitmapMs);
+
+	return mismatches == 0 ? 0 : 1;
+}
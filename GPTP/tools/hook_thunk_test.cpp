@@ -0,0 +1,466 @@
+//Checks the x86 code that GPTP::ThunkSignature::emit() generates for the
+//kinds of signatures the hooks use: register and stack arguments (near and
+//far), 1/2/4-byte and void results, and RETN with and without popping the
+//stack.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o hook_thunk_test
+//    hook_thunk_test.cpp ../src/hook_thunk.cpp
+//
+//Built with -m32 as well, the thunks are also run: each one is called with
+//known register values and stack arguments, and the test checks the
+//arguments the hook receives, the result, the registers the thunk must
+//preserve and the stack pointer after returning. This is done for the test
+//signatures above and for the 20 signatures the *_inject.cpp files use: like
+//the PUSHAD/POPAD wrappers they replace, the thunks must leave every register
+//except the result in EAX unchanged (EAX too for void hooks). Without the
+//32-bit multilib packages, link with host_shim/runtime32.cpp (see the build
+//line there):
+//  g++ -m32 ... -static -nostdlib -o hook_thunk_test32
+//    hook_thunk_test.cpp ../src/hook_thunk.cpp host_shim/runtime32.cpp
+
+#include <hook_thunk.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+
+namespace {
+
+	int failedChecks = 0;
+
+	void check(bool condition, const char *description) {
+		if (!condition) {
+			std::printf("FAILED: %s\n", description);
+			++failedChecks;
+		}
+	}
+
+	using GPTP::ThunkSignature;
+	namespace Register = GPTP::Register;
+
+	const int CALL_REL32 = -1;	//Placeholder for the 4 bytes after CALL
+
+	struct ThunkTest {
+		const char *name;
+		ThunkSignature signature;
+		std::vector<int> expectedCode;
+	};
+
+	std::vector<ThunkTest> makeThunkTests() {
+		std::vector<ThunkTest> tests(6);
+
+		//u32 hook(EDX, EAX), e.g. getModifiedUnitSpeedHook()
+		tests[0].name = "2 registers, 4-byte result";
+		tests[0].signature.arg(Register::EDX).arg(Register::EAX).returns(4);
+		const int code0[] = {
+			0x51, 0x52,					//PUSH ECX, PUSH EDX
+			0x50, 0x52,					//PUSH EAX, PUSH EDX
+			0xE8, CALL_REL32,
+			0x83, 0xC4, 0x08,			//ADD ESP, 8
+			0x5A, 0x59,					//POP EDX, POP ECX
+			0xC3,						//RETN
+		};
+		tests[0].expectedCode.assign(code0, code0 + sizeof(code0) / sizeof(int));
+
+		//void hook(EAX, EDI, [0], [3], [4], [2], [1]), RETN 20, e.g. weaponDamageHook()
+		tests[1].name = "registers and stack arguments, RETN 20";
+		tests[1].signature.arg(Register::EAX).arg(Register::EDI)
+			.stackArg(0).stackArg(3).stackArg(4).stackArg(2).stackArg(1).popStack(20);
+		const int code1[] = {
+			0x50, 0x51, 0x52,			//PUSH EAX, PUSH ECX, PUSH EDX
+			0xFF, 0x74, 0x24, 0x14,		//PUSH [ESP + 0x14]  (stack argument 1)
+			0xFF, 0x74, 0x24, 0x1C,		//PUSH [ESP + 0x1C]  (stack argument 2)
+			0xFF, 0x74, 0x24, 0x28,		//PUSH [ESP + 0x28]  (stack argument 4)
+			0xFF, 0x74, 0x24, 0x28,		//PUSH [ESP + 0x28]  (stack argument 3)
+			0xFF, 0x74, 0x24, 0x20,		//PUSH [ESP + 0x20]  (stack argument 0)
+			0x57, 0x50,					//PUSH EDI, PUSH EAX
+			0xE8, CALL_REL32,
+			0x83, 0xC4, 0x1C,			//ADD ESP, 28
+			0x5A, 0x59, 0x58,			//POP EDX, POP ECX, POP EAX
+			0xC2, 0x14, 0x00,			//RETN 20
+		};
+		tests[1].expectedCode.assign(code1, code1 + sizeof(code1) / sizeof(int));
+
+		tests[2].name = "1-byte result";
+		tests[2].signature.arg(Register::EAX).returns(1);
+		const int code2[] = {
+			0x51, 0x52, 0x50,
+			0xE8, CALL_REL32,
+			0x83, 0xC4, 0x04,
+			0x0F, 0xB6, 0xC0,			//MOVZX EAX, AL
+			0x5A, 0x59, 0xC3,
+		};
+		tests[2].expectedCode.assign(code2, code2 + sizeof(code2) / sizeof(int));
+
+		tests[3].name = "2-byte result";
+		tests[3].signature.arg(Register::EAX).returns(2);
+		const int code3[] = {
+			0x51, 0x52, 0x50,
+			0xE8, CALL_REL32,
+			0x83, 0xC4, 0x04,
+			0x0F, 0xB7, 0xC0,			//MOVZX EAX, AX
+			0x5A, 0x59, 0xC3,
+		};
+		tests[3].expectedCode.assign(code3, code3 + sizeof(code3) / sizeof(int));
+
+		tests[4].name = "far stack argument, RETN 164";
+		tests[4].signature.stackArg(40).arg(Register::ESI).returns(4).popStack(164);
+		const int code4[] = {
+			0x51, 0x52,
+			0x56,									//PUSH ESI
+			0xFF, 0xB4, 0x24, 0xB0, 0x00, 0x00, 0x00,	//PUSH [ESP + 0xB0]  (stack argument 40)
+			0xE8, CALL_REL32,
+			0x83, 0xC4, 0x08,
+			0x5A, 0x59,
+			0xC2, 0xA4, 0x00,						//RETN 164
+		};
+		tests[4].expectedCode.assign(code4, code4 + sizeof(code4) / sizeof(int));
+
+		tests[5].name = "no arguments, void";
+		const int code5[] = {
+			0x50, 0x51, 0x52,
+			0xE8, CALL_REL32,
+			0x5A, 0x59, 0x58,
+			0xC3,
+		};
+		tests[5].expectedCode.assign(code5, code5 + sizeof(code5) / sizeof(int));
+
+		return tests;
+	}
+
+	//Compares the emitted bytes with the expected code, and checks that the
+	//CALL goes to @p hook
+	void checkCode(const ThunkTest &test, const u8 *code, size_t size, const void *hook) {
+		bool isMatch = true;
+		size_t pos = 0;
+
+		for (size_t i = 0; i < test.expectedCode.size() && isMatch; ++i) {
+			if (test.expectedCode[i] == CALL_REL32) {
+				s32 offset;
+				memcpy(&offset, &code[pos], sizeof(offset));
+				pos += sizeof(offset);
+				isMatch = code + pos + offset == (const u8*)hook;
+			}
+			else
+				isMatch = pos < size && code[pos++] == test.expectedCode[i];
+		}
+
+		if (!isMatch || pos != size) {
+			std::printf("%s:", test.name);
+			for (size_t i = 0; i < size; ++i)
+				std::printf(" %02X", code[i]);
+			std::printf("\n");
+		}
+		check(isMatch && pos == size, test.name);
+		check(size <= (size_t)ThunkSignature::MAX_THUNK_SIZE, "thunk fits in MAX_THUNK_SIZE");
+	}
+
+} //unnamed namespace
+
+#ifdef __i386__
+
+//-------- Running the thunks (32-bit builds only) --------//
+
+struct Registers {
+	u32 eax, ecx, edx, ebx, esi, edi, ebp;
+};
+
+//Used by runThunk() below, hence the C names
+extern "C" {
+	//Read by runThunk()
+	Registers registersIn;
+	const void *thunkToRun;
+	const u32 *stackArgs;
+	u32 stackArgCount;
+
+	//Written by runThunk()
+	Registers registersOut;
+	u32 savedEsp, espAfterThunk;
+
+	u8 byteHook();
+	u16 wordHook();
+	void runThunk();
+}
+
+//byteHook() and wordHook() leave garbage in the upper bits of EAX
+__asm__(
+	".globl byteHook\n"
+	"byteHook:\n"
+	"	movl $0x123456AB, %eax\n"
+	"	movl $0xDEAD, %ecx\n"
+	"	movl $0xBEEF, %edx\n"
+	"	ret\n"
+	".globl wordHook\n"
+	"wordHook:\n"
+	"	movl $0x1234BEEF, %eax\n"
+	"	ret\n"
+
+	//Pushes stackArgs, loads registersIn, calls thunkToRun and saves the
+	//registers and ESP that the thunk returns with
+	".globl runThunk\n"
+	"runThunk:\n"
+	"	push %ebp; push %ebx; push %esi; push %edi\n"
+	"	movl %esp, savedEsp\n"
+	"	movl stackArgs, %eax\n"
+	"	movl stackArgCount, %ecx\n"
+	"1:	testl %ecx, %ecx\n"
+	"	jz 2f\n"
+	"	pushl -4(%eax, %ecx, 4)\n"
+	"	decl %ecx\n"
+	"	jmp 1b\n"
+	"2:	movl $registersIn, %eax\n"
+	"	movl 4(%eax), %ecx; movl 8(%eax), %edx; movl 12(%eax), %ebx\n"
+	"	movl 16(%eax), %esi; movl 20(%eax), %edi; movl 24(%eax), %ebp\n"
+	"	movl 0(%eax), %eax\n"
+	"	call *thunkToRun\n"
+	"	movl %eax, registersOut\n"
+	"	movl %ecx, registersOut + 4\n"
+	"	movl %edx, registersOut + 8\n"
+	"	movl %ebx, registersOut + 12\n"
+	"	movl %esi, registersOut + 16\n"
+	"	movl %edi, registersOut + 20\n"
+	"	movl %ebp, registersOut + 24\n"
+	"	movl %esp, espAfterThunk\n"
+	"	movl savedEsp, %esp\n"
+	"	pop %edi; pop %esi; pop %ebx; pop %ebp\n"
+	"	ret\n"
+);
+
+namespace {
+
+	//A __cdecl function may change ECX and EDX; the thunk must restore them
+#define CLOBBER_SCRATCH_REGISTERS() \
+	__asm__ volatile("movl $0xDEAD, %%ecx; movl $0xBEEF, %%edx" ::: "ecx", "edx")
+
+	u32 speedHook(u32 unit, u32 baseSpeed) {
+		CLOBBER_SCRATCH_REGISTERS();
+		return unit * 1000 + baseSpeed;
+	}
+
+	s32 damageArgs[7];
+
+	void damageHook(s32 damage, u32 target, u8 weaponId, u32 attacker, u8 playerId, s8 direction, u8 divisor) {
+		CLOBBER_SCRATCH_REGISTERS();
+		damageArgs[0] = damage;
+		damageArgs[1] = target;
+		damageArgs[2] = weaponId;
+		damageArgs[3] = attacker;
+		damageArgs[4] = playerId;
+		damageArgs[5] = direction;
+		damageArgs[6] = divisor;
+	}
+
+	u32 farHook(u32 a, u32 b) {
+		CLOBBER_SCRATCH_REGISTERS();
+		return a * 10 + b;
+	}
+
+	void voidHook() {
+		__asm__ volatile("movl $0x1111, %%eax; movl $0xDEAD, %%ecx; movl $0xBEEF, %%edx"
+			::: "eax", "ecx", "edx");
+	}
+
+	void run(const void *thunk, u32 eax, u32 ecx, u32 edx, u32 ebx, u32 esi, u32 edi,
+		const u32 *args = NULL, u32 argCount = 0)
+	{
+		const Registers in = { eax, ecx, edx, ebx, esi, edi, 0xB0B0 };
+		registersIn = in;
+		thunkToRun = thunk;
+		stackArgs = args;
+		stackArgCount = argCount;
+		runThunk();
+	}
+
+	//Checks that all registers except EAX (unless @p checkEax) are unchanged
+	bool arePreserved(bool checkEax) {
+		const Registers &in = registersIn, &out = registersOut;
+		return (!checkEax || out.eax == in.eax)
+			&& out.ecx == in.ecx && out.edx == in.edx && out.ebx == in.ebx
+			&& out.esi == in.esi && out.edi == in.edi && out.ebp == in.ebp;
+	}
+
+	void runThunks(const std::vector<u8*> &thunks) {
+		run(thunks[0], 7, 0x11, 5, 0x33, 0x66, 0x77);
+		check(registersOut.eax == 5007, "2 registers: result");
+		check(arePreserved(false), "2 registers: registers preserved");
+		check(espAfterThunk == savedEsp, "2 registers: stack pointer");
+
+		const u32 damageStackArgs[5] = { 0x1F2, 0x103, 0xFFFFFFFE, 0xCAFE, 0x205 };
+		run(thunks[1], (u32)-40, 0x11, 0x22, 0x33, 0x66, 0x1234, damageStackArgs, 5);
+		check(damageArgs[0] == -40 && damageArgs[1] == 0x1234 && damageArgs[2] == 0xF2
+			&& damageArgs[3] == 0xCAFE && damageArgs[4] == 5 && damageArgs[5] == -2 && damageArgs[6] == 3,
+			"stack arguments: hook arguments");
+		check(arePreserved(true), "stack arguments: registers preserved");
+		check(espAfterThunk == savedEsp, "stack arguments: stack pointer after RETN 20");
+
+		run(thunks[2], 1, 2, 3, 4, 5, 6);
+		check(registersOut.eax == 0xAB, "1-byte result is zero-extended");
+		check(arePreserved(false), "1-byte result: registers preserved");
+
+		run(thunks[3], 1, 2, 3, 4, 5, 6);
+		check(registersOut.eax == 0xBEEF, "2-byte result is zero-extended");
+		check(arePreserved(false), "2-byte result: registers preserved");
+
+		u32 farStackArgs[41];
+		for (int i = 0; i < 41; ++i)
+			farStackArgs[i] = 100 + i;
+		run(thunks[4], 1, 2, 3, 4, 9, 6, farStackArgs, 41);
+		check(registersOut.eax == 140 * 10 + 9, "far stack argument: result");
+		check(arePreserved(false), "far stack argument: registers preserved");
+		check(espAfterThunk == savedEsp, "far stack argument: stack pointer after RETN 164");
+
+		run(thunks[5], 0xAAAA, 2, 3, 4, 5, 6);
+		check(arePreserved(true), "void hook: registers preserved");
+	}
+
+	const void *const hooks[6] = {
+		(void*)speedHook, (void*)damageHook, (void*)byteHook, (void*)wordHook, (void*)farHook, (void*)voidHook
+	};
+
+	//-------- The signatures of the hooks --------//
+
+	const int END = -1;
+	const int STACK = 100;		//STACK + i is stack argument i
+
+	struct HookSignature {
+		const char *name;
+		int args[8];			//Register::Enum or STACK + index, then END
+		int returnSize;
+		int popBytes;
+	};
+
+	//Copied from the createThunk() calls in the *_inject.cpp files
+	const HookSignature hookSignatures[] = {
+		{ "findBestSpiderMineTargetHook", { Register::ESI, END }, 4, 0 },
+		{ "getModifiedUnitSpeedHook", { Register::EDX, Register::EAX, END }, 4, 0 },
+		{ "getModifiedUnitAccelerationHook", { Register::ECX, END }, 4, 0 },
+		{ "getModifiedUnitTurnSpeedHook", { Register::ECX, END }, 4, 0 },
+		{ "unitCanRechargeShieldsHook", { Register::EAX, Register::EDI, END }, 1, 0 },
+		{ "orderRechargeShieldsHook", { Register::EDI, END }, 0, 0 },
+		{ "getModifiedWeaponCooldownHook", { Register::ESI, Register::EAX, END }, 4, 0 },
+		{ "updateStatusEffectsHook", { Register::EAX, END }, 0, 0 },
+		{ "getAttackPriorityHook", { Register::EDI, Register::EBX, END }, 4, 0 },
+		{ "findBestAttackTargetHook", { Register::EAX, END }, 4, 0 },
+		{ "findRandomAttackTargetHook", { Register::ESI, END }, 4, 0 },
+		{ "getArmorBonusHook", { Register::EAX, END }, 1, 0 },
+		{ "getSeekRangeHook", { Register::EDX, END }, 1, 0 },
+		{ "getMaxWeaponRangeHook", { Register::EAX, Register::EBX, END }, 4, 0 },
+		{ "getUnitMaxEnergyHook", { Register::EAX, END }, 2, 0 },
+		{ "consumeHitHook", { Register::EAX, Register::ESI, END }, 0, 0 },
+		{ "weaponDamageHook", { Register::EAX, Register::EDI, STACK + 0, STACK + 3, STACK + 4, STACK + 2, STACK + 1, END }, 0, 20 },
+		{ "fireWeaponHook", { Register::ESI, STACK + 0, END }, 0, 4 },
+		{ "updateUnitStateHook", { Register::EAX, END }, 0, 0 },
+		{ "unitCanDetectHook", { Register::EAX, END }, 1, 0 },
+	};
+
+	u32 recordedArgs[8];
+	const u32 RECORDING_HOOK_RESULT = 0x9ABCDEF1;
+
+	//Stands in for any hook: records up to 8 arguments (the caller pushed
+	//fewer; the others are whatever is above them on the stack)
+	u32 recordingHook(u32 a0, u32 a1, u32 a2, u32 a3, u32 a4, u32 a5, u32 a6, u32 a7) {
+		CLOBBER_SCRATCH_REGISTERS();
+		const u32 args[8] = { a0, a1, a2, a3, a4, a5, a6, a7 };
+		memcpy(recordedArgs, args, sizeof(args));
+		return RECORDING_HOOK_RESULT;
+	}
+
+	void runHookSignatures(u8 *memory) {
+		const u32 stackArgs[5] = { 0x70000000, 0x70000001, 0x70000002, 0x70000003, 0x70000004 };
+		const u32 registerValues[8] = {
+			0x1000000A, 0x2000000C, 0x3000000D, 0x4000000B, 0, 0xB0B0, 0x5000000E, 0x6000000F
+		};
+
+		for (size_t i = 0; i < sizeof(hookSignatures) / sizeof(hookSignatures[0]); ++i) {
+			const HookSignature &hook = hookSignatures[i];
+
+			ThunkSignature signature;
+			int argCount = 0;
+			for (; hook.args[argCount] != END; ++argCount) {
+				if (hook.args[argCount] >= STACK)
+					signature.stackArg(hook.args[argCount] - STACK);
+				else
+					signature.arg((Register::Enum)hook.args[argCount]);
+			}
+			if (hook.returnSize)
+				signature.returns(hook.returnSize);
+			if (hook.popBytes)
+				signature.popStack(hook.popBytes);
+
+			u8 *thunk = memory + 1024 + 128 * i;
+			signature.emit(thunk, (const void*)recordingHook);
+
+			//The caller pushes as many stack arguments as the function pops
+			const u32 stackArgCount = hook.popBytes / 4;
+			run(thunk, registerValues[Register::EAX], registerValues[Register::ECX],
+				registerValues[Register::EDX], registerValues[Register::EBX],
+				registerValues[Register::ESI], registerValues[Register::EDI], stackArgs, stackArgCount);
+
+			bool areArgsPassed = true;
+			for (int a = 0; a < argCount; ++a) {
+				const int source = hook.args[a];
+				const u32 expected = source >= STACK ? stackArgs[source - STACK] : registerValues[source];
+				areArgsPassed = areArgsPassed && recordedArgs[a] == expected;
+			}
+
+			u32 expectedEax = registersIn.eax;
+			if (hook.returnSize == 1)
+				expectedEax = RECORDING_HOOK_RESULT & 0xFF;
+			else if (hook.returnSize == 2)
+				expectedEax = RECORDING_HOOK_RESULT & 0xFFFF;
+			else if (hook.returnSize == 4)
+				expectedEax = RECORDING_HOOK_RESULT;
+
+			const bool isOk = areArgsPassed && registersOut.eax == expectedEax
+				&& arePreserved(false) && espAfterThunk == savedEsp;
+			if (!isOk)
+				std::printf("%s: args %s, EAX 0x%08X (expected 0x%08X), ESP %s\n", hook.name,
+					areArgsPassed ? "ok" : "wrong", registersOut.eax, expectedEax,
+					espAfterThunk == savedEsp ? "ok" : "wrong");
+			check(isOk, hook.name);
+		}
+	}
+
+} //unnamed namespace
+
+#endif
+
+int main() {
+	const std::vector<ThunkTest> tests = makeThunkTests();
+
+	//Executable memory, as createThunk() uses
+	u8 *memory = (u8*)mmap(NULL, 4096, PROT_READ | PROT_WRITE | PROT_EXEC,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		std::perror("mmap");
+		return 1;
+	}
+
+	std::vector<u8*> thunks;
+	for (size_t i = 0; i < tests.size(); ++i) {
+#ifdef __i386__
+		const void *hook = hooks[i];
+#else
+		//The code is only checked, so any address within reach of a CALL will do
+		const void *hook = memory + 2048 + i;
+#endif
+		u8 *thunk = memory + 128 * i;
+		const size_t size = tests[i].signature.emit(thunk, hook);
+		checkCode(tests[i], thunk, size, hook);
+		thunks.push_back(thunk);
+	}
+
+#ifdef __i386__
+	runThunks(thunks);
+	runHookSignatures(memory);
+	std::printf("Ran %u test thunks and %u hook thunks\n", (u32)thunks.size(),
+		(u32)(sizeof(hookSignatures) / sizeof(hookSignatures[0])));
+#else
+	std::printf("Not a 32-bit build, the thunks were not run\n");
+#endif
+
+	std::printf("%d checks failed\n", failedChecks);
+	return failedChecks == 0 ? 0 : 1;
+}
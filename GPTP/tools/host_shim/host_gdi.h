@@ -0,0 +1,57 @@
+//Fake GDI for host programs in GPTP/tools that link the graphics sources
+//(see host_shim.h). Include this in exactly one translation unit.
+//
+//Fonts are not rendered: DrawText() measures every glyph as 8 to 14 pixels
+//wide and 12 pixels high, depending on the character, and GetBitmapBits()
+//returns a fixed pattern derived from the last character drawn. This is
+//enough to check that cached and uncached glyph paths give the same pixels.
+
+#pragma once
+#include <windows.h>
+
+namespace host {
+
+	//Set to true to make GetUserDefaultLangID() report a Korean system
+	bool isKoreanSystem = false;
+
+	int lastDrawnChar = 0;
+
+} //host
+
+HDC GetDC(HWND) { return 0; }
+int ReleaseDC(HWND, HDC) { return 0; }
+int MulDiv(int, int, int) { return 0; }
+int GetDeviceCaps(HDC, int) { return 0; }
+HFONT CreateFontIndirect(const LOGFONT*) { return (HFONT)1; }
+HDC CreateCompatibleDC(HDC) { return 0; }
+int SetBkMode(HDC, int) { return 0; }
+COLORREF SetTextColor(HDC, COLORREF) { return 0; }
+COLORREF SetBkColor(HDC, COLORREF) { return 0; }
+HGDIOBJ SelectObject(HDC, HGDIOBJ) { return 0; }
+HGDIOBJ GetStockObject(int) { return 0; }
+HBITMAP CreateCompatibleBitmap(HDC, int, int) { return (HBITMAP)1; }
+BOOL Rectangle(HDC, int, int, int, int) { return 0; }
+
+int DrawText(HDC, const char *text, int, RECT *rect, UINT format) {
+	host::lastDrawnChar = (unsigned char)text[1];
+	if (format == DT_CALCRECT) {
+		rect->left = rect->top = 0;
+		rect->right = 8 + host::lastDrawnChar % 7;
+		rect->bottom = 12;
+	}
+	return 0;
+}
+
+LONG GetBitmapBits(HBITMAP, LONG size, void *bits) {
+	for (int i = 0; i < size; ++i)
+		((unsigned char*)bits)[i] = (i * 7 + host::lastDrawnChar) % 5 == 0;
+	return size;
+}
+
+WORD GetUserDefaultLangID() {
+	return host::isKoreanSystem ? MAKELANGID(LANG_KOREAN, SUBLANG_KOREAN) : 0;
+}
+
+BOOL IsDBCSLeadByte(BYTE b) {
+	return b >= 0xB0 && b < 0xC8;
+}
@@ -0,0 +1,56 @@
+//Forced include for building GPTP sources as Linux host programs (tests and
+//benchmarks in GPTP/tools). Pass it with "-include host_shim/host_shim.h",
+//together with "-Ihost_shim" so that <windows.h> and <intrin.h> resolve to
+//the stubs in this directory.
+//
+//StarCraft's memory (0x00400000 - 0x00800000) is replaced by an anonymous
+//mapping at the same address, so that the SCBW_DATA constants in
+//scbwdata.h point to writable memory. Host programs fill in the parts they
+//use (unit ordering arrays, DAT tables, ...). Structures are not laid out
+//as in StarCraft on 64-bit hosts, so static_assert() is disabled; only
+//GPTP's own code can be tested this way.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <emmintrin.h>
+#include <cassert>
+#include <cstdarg>
+#include <functional>
+#include <map>
+#include <sys/mman.h>
+
+#define static_assert(...)
+#define __stdcall
+#define __fastcall
+#define __cdecl
+#define _vscprintf(f,a) vsnprintf(0,0,f,a)
+#define _vsnprintf vsnprintf
+
+//Every translation unit calls this at startup; only the first call maps
+inline void mapFakeStarCraftMemory() {
+	static bool isMapped = false;
+	if (isMapped)
+		return;
+
+	void *p = mmap((void*)0x00400000, 0x00400000, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if (p != (void*)0x00400000) {
+		perror("mmap");
+		exit(1);
+	}
+	isMapped = true;
+}
+
+__attribute__((constructor(101))) static void initFakeStarCraftMemory() {
+	mapFakeStarCraftMemory();
+}
@@ -0,0 +1,180 @@
+//Fake unit table for host programs in GPTP/tools (see host_shim.h).
+//Include this in exactly one translation unit: it defines the CUnit and
+//scbw functions that are normally compiled from CUnit.cpp and api.cpp (which
+//contain inline assembly), using the same formulas.
+//
+//  host::setUnit(index, unitId, x, y) places a unit; host::buildUnitOrdering()
+//  then fills StarCraft's unit ordering arrays from all units with a sprite,
+//  like StarCraft does, so that UnitFinder and SpatialGrid work.
+
+#pragma once
+#include <SCBW/scbwdata.h>
+#include <SCBW/api.h>
+#include <SCBW/enumerations.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace host {
+
+	CUnit units[UNIT_ARRAY_LENGTH];
+	CSprite sprites[UNIT_ARRAY_LENGTH];
+
+	//Gives every DAT array its own 4 KB page above StarCraft's data, before
+	//the SCBW_DATA constants are initialized
+	__attribute__((constructor(102))) void setupDatTables() {
+		DatLoad *const tables[] = {
+			(DatLoad*)units_dat::unitsDat, (DatLoad*)weapons_dat::weaponsDat,
+			(DatLoad*)flingy_dat::flingyDat, (DatLoad*)upgrades_dat::upgradesDat,
+		};
+		const int arrayCounts[] = { 53, 22, 7, 11 };
+
+		u32 address = 0x00700000;
+		for (int t = 0; t < 4; ++t) {
+			for (int i = 0; i < arrayCounts[t]; ++i) {
+				tables[t][i].address = address;
+				address += 0x1000;
+			}
+		}
+	}
+
+	//Clears all units and the ordering arrays
+	void clearUnits() {
+		std::memset(units, 0, sizeof(units));
+		std::memset(sprites, 0, sizeof(sprites));
+		*(u32*)unitOrderingCount = 0;
+	}
+
+	//Creates a unit in slot @p index (CUnit::getIndex()), owned by player 0
+	CUnit* setUnit(u16 index, u16 unitId, int x, int y) {
+		CUnit *unit = &units[index - 1];
+		CSprite *sprite = &sprites[index - 1];
+		std::memset(unit, 0, sizeof(CUnit));
+		unit->id = unitId;
+		unit->sprite = sprite;
+		unit->hitPoints = 256;
+		sprite->position.x = (u16)x;
+		sprite->position.y = (u16)y;
+		sprite->visibilityFlags = 0xFF;
+		return unit;
+	}
+
+	//Sorts the edges of all units with a sprite into unitOrderingX / Y, and
+	//sets MAX_UNIT_WIDTH / HEIGHT to the largest unit size
+	void buildUnitOrdering() {
+		UnitFinderData *const xs = (UnitFinderData*)unitOrderingX;
+		UnitFinderData *const ys = (UnitFinderData*)unitOrderingY;
+		int count = 0, maxWidth = 0, maxHeight = 0;
+
+		for (int i = 0; i < UNIT_ARRAY_LENGTH; ++i) {
+			const CUnit *unit = &units[i];
+			if (!unit->sprite)
+				continue;
+
+			xs[count].unitIndex = ys[count].unitIndex = i + 1;
+			xs[count].position = unit->getLeft();
+			ys[count].position = unit->getTop();
+			++count;
+			xs[count].unitIndex = ys[count].unitIndex = i + 1;
+			xs[count].position = unit->getRight();
+			ys[count].position = unit->getBottom();
+			++count;
+
+			maxWidth = std::max(maxWidth, unit->getRight() - unit->getLeft() + 1);
+			maxHeight = std::max(maxHeight, unit->getBottom() - unit->getTop() + 1);
+		}
+
+		std::stable_sort(xs, xs + count);
+		std::stable_sort(ys, ys + count);
+		*(u32*)unitOrderingCount = count;
+		*(s32*)MAX_UNIT_WIDTH = maxWidth;
+		*(s32*)MAX_UNIT_HEIGHT = maxHeight;
+	}
+
+	//Links all units with a sprite into the visible unit list, in index order
+	void linkVisibleUnits() {
+		CUnit *previous = nullptr;
+		*firstVisibleUnit = nullptr;
+
+		for (int i = 0; i < UNIT_ARRAY_LENGTH; ++i) {
+			CUnit *unit = &units[i];
+			if (!unit->sprite)
+				continue;
+
+			unit->link.prev = previous;
+			unit->link.next = nullptr;
+			if (previous)
+				previous->link.next = unit;
+			else
+				*firstVisibleUnit = unit;
+			previous = unit;
+		}
+	}
+
+	//Random number in [0, n)
+	inline int random(int n) {
+		return std::rand() % n;
+	}
+
+} //host
+
+//-------- CUnit / scbw functions used by the tested code --------//
+
+CUnit* CUnit::getFromIndex(u16 index) {
+	if (1 <= index && index <= UNIT_ARRAY_LENGTH)
+		return &host::units[index - 1];
+	return nullptr;
+}
+
+u16 CUnit::getIndex() const { return (u16)(this - host::units + 1); }
+u16 CUnit::getX() const { return this->sprite->position.x; }
+u16 CUnit::getY() const { return this->sprite->position.y; }
+s16 CUnit::getLeft() const { return this->getX() - units_dat::UnitBounds[this->id].left; }
+s16 CUnit::getRight() const { return this->getX() + units_dat::UnitBounds[this->id].right; }
+s16 CUnit::getTop() const { return this->getY() - units_dat::UnitBounds[this->id].top; }
+s16 CUnit::getBottom() const { return this->getY() + units_dat::UnitBounds[this->id].bottom; }
+
+bool CUnit::isSubunit() const {
+	return (this && units_dat::BaseProperty[this->id] & UnitProperty::Subunit);
+}
+
+u32 CUnit::getDistanceToTarget(const CUnit *target) const {
+	const CUnit *unit = this;
+	if (this->isSubunit())
+		unit = this->subunit;
+
+	s32 dx = unit->getLeft() - target->getRight() - 1;
+	if (dx < 0) {
+		dx = target->getLeft() - unit->getRight() - 1;
+		if (dx < 0)
+			dx = 0;
+	}
+
+	s32 dy = unit->getTop() - target->getBottom() - 1;
+	if (dy < 0) {
+		dy = target->getTop() - unit->getBottom() - 1;
+		if (dy < 0)
+			dy = 0;
+	}
+
+	return scbw::getDistanceFast(0, 0, dx, dy);
+}
+
+bool CSprite::isVisibleTo(u8 playerId) const {
+	return (this->visibilityFlags & (1 << playerId)) != 0;
+}
+
+namespace scbw {
+
+	u32 getDistanceFast(s32 x1, s32 y1, s32 x2, s32 y2) {
+		int dMax = std::abs(x1 - x2), dMin = std::abs(y1 - y2);
+		if (dMax < dMin)
+			std::swap(dMax, dMin);
+
+		if (dMin <= (dMax >> 2))
+			return dMax;
+
+		return (dMin * 3 >> 3) + (dMin * 3 >> 8) + dMax - (dMax >> 4) - (dMax >> 6);
+	}
+
+} //scbw
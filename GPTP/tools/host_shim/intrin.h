@@ -0,0 +1,8 @@
+//Win32 intrinsics used by GPTP, for host builds (see host_shim.h).
+#pragma once
+#include <x86intrin.h>
+#define _ReadWriteBarrier() __asm__ __volatile__("" ::: "memory")
+#include <unistd.h>
+#include <sys/syscall.h>
+static inline long _InterlockedIncrement(volatile long *p) { return __sync_add_and_fetch(p, 1); }
+static inline unsigned long __readfsdword(unsigned long) { return (unsigned long)syscall(SYS_gettid); }
@@ -0,0 +1,329 @@
+//Minimal C/C++ runtime for running host programs as 32-bit x86 code when the
+//32-bit multilib packages (libc6-dev-i386, lib32stdc++) are not installed.
+//It provides the few library functions that hook_thunk_test uses, on top of
+//Linux's int 0x80 system calls, so that the thunks GPTP emits can be run in
+//the same mode as in StarCraft.
+//
+//Build, from GPTP/tools (the 64-bit headers work for i386 once the multiarch
+//directories are on the include path; stubs-32.h may be an empty file):
+//  mkdir -p /tmp/inc32/gnu && touch /tmp/inc32/gnu/stubs-32.h
+//  g++ -m32 -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-exceptions -fno-rtti
+//    -fno-pic -fno-stack-protector -fno-asynchronous-unwind-tables -static -nostdlib
+//    -I/tmp/inc32 -I/usr/include/x86_64-linux-gnu/c++/12 -I/usr/include/x86_64-linux-gnu
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o hook_thunk_test32
+//    hook_thunk_test.cpp ../src/hook_thunk.cpp host_shim/runtime32.cpp -lgcc
+//
+//Only what the tests need is supported: printf() knows %d, %u, %x, %X, %s,
+//%c and %p with flags '0' and '-', a width and the 'l' length; memory from
+//operator new is never freed.
+
+#ifndef __i386__
+#error runtime32.cpp is only for -m32 builds
+#endif
+
+#include <cstdarg>
+#include <cstddef>
+#include <sys/mman.h>
+
+namespace {
+
+	long systemCall(long number, long a = 0, long b = 0, long c = 0, long d = 0, long e = 0, long f = 0) {
+		long result;
+		__asm__ volatile(
+			"push %%ebp\n"
+			"movl %7, %%ebp\n"
+			"int $0x80\n"
+			"pop %%ebp"
+			: "=a"(result)
+			: "a"(number), "b"(a), "c"(b), "d"(c), "S"(d), "D"(e), "m"(f)
+			: "memory");
+		return result;
+	}
+
+	const long SYS_EXIT_GROUP = 252, SYS_WRITE = 4, SYS_MMAP2 = 192;
+
+	void writeAll(const char *text, size_t length) {
+		while (length > 0) {
+			const long written = systemCall(SYS_WRITE, 1, (long)text, (long)length);
+			if (written <= 0)
+				return;
+			text += written;
+			length -= written;
+		}
+	}
+
+	//Output of printf(), flushed when full and at exit()
+	char outputBuffer[4096];
+	size_t outputLength = 0;
+
+	void flushOutput() {
+		writeAll(outputBuffer, outputLength);
+		outputLength = 0;
+	}
+
+	void putOutput(char c) {
+		if (outputLength == sizeof(outputBuffer))
+			flushOutput();
+		outputBuffer[outputLength++] = c;
+	}
+
+	void putPadded(const char *text, size_t length, int width, bool isLeftAligned, char pad) {
+		if (!isLeftAligned) {
+			for (int i = (int)length; i < width; ++i)
+				putOutput(pad);
+		}
+		for (size_t i = 0; i < length; ++i)
+			putOutput(text[i]);
+		if (isLeftAligned) {
+			for (int i = (int)length; i < width; ++i)
+				putOutput(' ');
+		}
+	}
+
+	size_t formatNumber(char *buffer, unsigned long value, unsigned int base, bool isUpperCase) {
+		const char *digits = isUpperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+		char reversed[16];
+		size_t length = 0;
+		do {
+			reversed[length++] = digits[value % base];
+			value /= base;
+		} while (value != 0);
+
+		for (size_t i = 0; i < length; ++i)
+			buffer[i] = reversed[length - 1 - i];
+		return length;
+	}
+
+	//Memory for operator new
+	char heap[64 << 20];
+	size_t heapUsed = 0;
+
+} //unnamed namespace
+
+extern "C" {
+
+	int main();
+
+	void *__dso_handle = 0;
+
+	void exit(int status) {
+		flushOutput();
+		systemCall(SYS_EXIT_GROUP, status);
+		for (;;) {}
+	}
+
+	void abort() {
+		exit(134);
+	}
+
+	//Runs the static constructors (host_shim.h maps StarCraft's memory in
+	//one), then main()
+	extern void (*__init_array_start[])();
+	extern void (*__init_array_end[])();
+
+	void startProgram() {
+		for (void (**init)() = __init_array_start; init != __init_array_end; ++init)
+			(*init)();
+		exit(main());
+	}
+
+	int __cxa_atexit(void (*)(void*), void*, void*) {
+		return 0;
+	}
+
+	void* memcpy(void *destination, const void *source, size_t size) {
+		char *d = (char*)destination;
+		const char *s = (const char*)source;
+		for (size_t i = 0; i < size; ++i)
+			d[i] = s[i];
+		return destination;
+	}
+
+	void* memmove(void *destination, const void *source, size_t size) {
+		char *d = (char*)destination;
+		const char *s = (const char*)source;
+		if (d < s) {
+			for (size_t i = 0; i < size; ++i)
+				d[i] = s[i];
+		}
+		else {
+			for (size_t i = size; i > 0; --i)
+				d[i - 1] = s[i - 1];
+		}
+		return destination;
+	}
+
+	void* memset(void *destination, int value, size_t size) {
+		char *d = (char*)destination;
+		for (size_t i = 0; i < size; ++i)
+			d[i] = (char)value;
+		return destination;
+	}
+
+	int memcmp(const void *first, const void *second, size_t size) {
+		const unsigned char *a = (const unsigned char*)first, *b = (const unsigned char*)second;
+		for (size_t i = 0; i < size; ++i) {
+			if (a[i] != b[i])
+				return a[i] < b[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+	size_t strlen(const char *text) {
+		size_t length = 0;
+		while (text[length])
+			++length;
+		return length;
+	}
+
+	void* mmap(void *address, size_t length, int protection, int flags, int fd, long offset) {
+		const long result = systemCall(SYS_MMAP2, (long)address, (long)length, protection, flags, fd, offset / 4096);
+		return (unsigned long)result >= (unsigned long)-4095 ? MAP_FAILED : (void*)result;
+	}
+
+	int vprintf(const char *format, va_list args) {
+		for (const char *p = format; *p; ++p) {
+			if (*p != '%') {
+				putOutput(*p);
+				continue;
+			}
+
+			bool isLeftAligned = false;
+			char pad = ' ';
+			for (++p; *p == '-' || *p == '0'; ++p) {
+				if (*p == '-')
+					isLeftAligned = true;
+				else
+					pad = '0';
+			}
+
+			int width = 0;
+			for (; '0' <= *p && *p <= '9'; ++p)
+				width = width * 10 + (*p - '0');
+			while (*p == 'l')
+				++p;
+
+			char number[16];
+			switch (*p) {
+			case 'd': {
+				const long value = va_arg(args, long);
+				const unsigned long magnitude = value < 0 ? 0 - (unsigned long)value : (unsigned long)value;
+				number[0] = '-';
+				const size_t length = formatNumber(number + 1, magnitude, 10, false);
+				putPadded(value < 0 ? number : number + 1, length + (value < 0), width, isLeftAligned, pad);
+				break;
+			}
+			case 'u':
+				putPadded(number, formatNumber(number, va_arg(args, unsigned long), 10, false), width, isLeftAligned, pad);
+				break;
+			case 'x':
+			case 'X':
+				putPadded(number, formatNumber(number, va_arg(args, unsigned long), 16, *p == 'X'), width, isLeftAligned, pad);
+				break;
+			case 'p':
+				putOutput('0');
+				putOutput('x');
+				putPadded(number, formatNumber(number, (unsigned long)va_arg(args, void*), 16, false), width, isLeftAligned, pad);
+				break;
+			case 's': {
+				const char *text = va_arg(args, const char*);
+				putPadded(text, strlen(text), width, isLeftAligned, ' ');
+				break;
+			}
+			case 'c': {
+				const char c = (char)va_arg(args, int);
+				putPadded(&c, 1, width, isLeftAligned, ' ');
+				break;
+			}
+			case '%':
+				putOutput('%');
+				break;
+			default:
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	int printf(const char *format, ...) {
+		va_list args;
+		va_start(args, format);
+		const int result = vprintf(format, args);
+		va_end(args);
+		return result;
+	}
+
+	int putchar(int c) {
+		putOutput((char)c);
+		return c;
+	}
+
+	int puts(const char *text) {
+		printf("%s\n", text);
+		return 0;
+	}
+
+	void perror(const char *text) {
+		printf("%s: error\n", text);
+	}
+
+	void __assert_fail(const char *assertion, const char *file, unsigned int line, const char *) {
+		printf("%s:%u: assertion failed: %s\n", file, line, assertion);
+		abort();
+	}
+
+	//std::ios_base::Init::Init() and ~Init(), for the <iostream> included by
+	//host_shim.h; the tests print with printf()
+	void _ZNSt8ios_base4InitC1Ev(void*) {}
+	void _ZNSt8ios_base4InitD1Ev(void*) {}
+
+} //extern "C"
+
+//The entry point: aligns the stack like the C runtime does
+__asm__(
+	".globl _start\n"
+	"_start:\n"
+	"	xorl %ebp, %ebp\n"
+	"	andl $-16, %esp\n"
+	"	call startProgram\n"
+	"	hlt\n"
+);
+
+void* operator new(size_t size) {
+	size = (size + 15) & ~(size_t)15;
+	if (heapUsed + size > sizeof(heap)) {
+		printf("operator new: out of memory\n");
+		abort();
+	}
+	void *memory = heap + heapUsed;
+	heapUsed += size;
+	return memory;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void*) {}
+void operator delete[](void*) {}
+void operator delete(void*, size_t) {}
+void operator delete[](void*, size_t) {}
+
+namespace std {
+
+	void __throw_length_error(const char *message) {
+		printf("length_error: %s\n", message);
+		abort();
+	}
+
+	void __throw_bad_alloc() {
+		printf("bad_alloc\n");
+		abort();
+	}
+
+	void __throw_bad_array_new_length() {
+		printf("bad_array_new_length\n");
+		abort();
+	}
+
+} //std
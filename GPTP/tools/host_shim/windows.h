@@ -0,0 +1,74 @@
+//Declarations of the Win32 API used by GPTP, for host builds (see host_shim.h).
+//Host programs that call these functions must define them.
+#pragma once
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef void* HANDLE;
+typedef void* LPVOID;
+typedef unsigned int UINT;
+typedef long LONG;
+typedef void* HINSTANCE;
+typedef void* HWND;
+typedef const char* LPCSTR;
+typedef char* LPSTR;
+typedef unsigned short WORD;
+typedef unsigned long long ULONGLONG;
+typedef long long LONGLONG;
+typedef void* HMODULE;
+typedef unsigned long SIZE_T;
+#define WINAPI
+#define TRUE 1
+#define FALSE 0
+#define PAGE_EXECUTE_READWRITE 0x40
+BOOL VirtualProtect(LPVOID, SIZE_T, DWORD, DWORD*);
+DWORD GetTickCount();
+BOOL FlushInstructionCache(HANDLE, const void*, SIZE_T);
+HANDLE GetCurrentProcess();
+typedef union { struct { DWORD LowPart; LONG HighPart; }; LONGLONG QuadPart; } LARGE_INTEGER;
+BOOL QueryPerformanceCounter(LARGE_INTEGER*);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER*);
+DWORD GetCurrentThreadId();
+HANDLE CreateThread(void*, SIZE_T, DWORD (*)(LPVOID), LPVOID, DWORD, DWORD*);
+DWORD WaitForSingleObject(HANDLE, DWORD);
+BOOL CloseHandle(HANDLE);
+void Sleep(DWORD);
+HANDLE CreateEvent(void*, BOOL, BOOL, LPCSTR);
+BOOL SetEvent(HANDLE);
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+typedef void* HFONT;
+typedef void* HDC;
+typedef void* HBITMAP;
+typedef void* HGDIOBJ;
+typedef unsigned long COLORREF;
+struct LOGFONT { LONG lfHeight, lfWidth, lfEscapement, lfOrientation, lfWeight; BYTE lfItalic, lfUnderline, lfStrikeOut, lfCharSet, a,b,c,d; char lfFaceName[32]; };
+struct RECT { LONG left, top, right, bottom; };
+#define HANGUL_CHARSET 129
+#define LOGPIXELSY 90
+#define FW_BOLD 700
+#define OPAQUE 2
+#define BLACK_BRUSH 4
+#define DT_CALCRECT 0x400
+#define RGB(r,g,b) ((COLORREF)((r)|((g)<<8)|((b)<<16)))
+#define MAKELANGID(p,s) ((((WORD)(s))<<10)|(WORD)(p))
+#define LANG_KOREAN 0x12
+#define SUBLANG_KOREAN 1
+HDC GetDC(HWND);
+int ReleaseDC(HWND, HDC);
+int MulDiv(int,int,int);
+int GetDeviceCaps(HDC,int);
+HFONT CreateFontIndirect(const LOGFONT*);
+HDC CreateCompatibleDC(HDC);
+int SetBkMode(HDC,int);
+COLORREF SetTextColor(HDC,COLORREF);
+COLORREF SetBkColor(HDC,COLORREF);
+HGDIOBJ SelectObject(HDC,HGDIOBJ);
+HGDIOBJ GetStockObject(int);
+HBITMAP CreateCompatibleBitmap(HDC,int,int);
+int DrawText(HDC,const char*,int,RECT*,UINT);
+BOOL Rectangle(HDC,int,int,int,int);
+LONG GetBitmapBits(HBITMAP,LONG,void*);
+WORD GetUserDefaultLangID();
+BOOL IsDBCSLeadByte(BYTE);
+#define WAIT_TIMEOUT 258
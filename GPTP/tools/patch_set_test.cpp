@@ -0,0 +1,216 @@
+//Checks GPTP::PatchSet on read-only pages of an anonymous mapping, with a
+//MemoryProtector built on mprotect(): patches, JMP/CALL encoding, patches
+//that cross a page boundary, overlap and expected-byte checks, protection
+//failures part way through, rejected patch sets and rollback().
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o patch_set_test
+//    patch_set_test.cpp ../src/patch_set.cpp
+
+#include <patch_set.h>
+#include <csetjmp>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+	int failedChecks = 0;
+
+	void check(bool condition, const char *description) {
+		if (!condition) {
+			std::printf("FAILED: %s\n", description);
+			++failedChecks;
+		}
+	}
+
+	//The pages are read-only between tests; writing to them must fault
+	sigjmp_buf faultJump;
+
+	void onFault(int) {
+		siglongjmp(faultJump, 1);
+	}
+
+	bool isWritable(u8 *address) {
+		if (sigsetjmp(faultJump, 1))
+			return false;
+
+		const u8 value = *(volatile u8*)address;
+		*(volatile u8*)address = value;
+		return true;
+	}
+
+	class MprotectProtector : public GPTP::MemoryProtector {
+	public:
+		MprotectProtector() : unprotectCount(0), restoreCount(0), flushCount(0) {}
+
+		size_t getPageSize() const {
+			return (size_t)sysconf(_SC_PAGESIZE);
+		}
+
+		bool unprotect(void *page, u32 &oldProtection) {
+			if (this->failingPages.count(page))
+				return false;
+
+			//Each page must be unprotected only once per apply() / rollback()
+			check(this->unprotectedPages.insert(page).second, "page unprotected twice");
+			++this->unprotectCount;
+			oldProtection = PROT_READ;
+			return mprotect(page, this->getPageSize(), PROT_READ | PROT_WRITE) == 0;
+		}
+
+		bool restore(void *page, u32 oldProtection) {
+			check(this->unprotectedPages.erase(page) == 1, "restoring a page that was not unprotected");
+			++this->restoreCount;
+			return mprotect(page, this->getPageSize(), oldProtection) == 0;
+		}
+
+		void flushInstructionCache(void * /*page*/) {
+			++this->flushCount;
+		}
+
+		std::set<void*> failingPages;
+		std::set<void*> unprotectedPages;
+		int unprotectCount, restoreCount, flushCount;
+	};
+
+} //unnamed namespace
+
+int main() {
+	using GPTP::PatchSet;
+
+	signal(SIGSEGV, onFault);
+	signal(SIGBUS, onFault);
+
+	const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	const size_t memorySize = pageSize * 4;
+	u8 *memory = (u8*)mmap(NULL, memorySize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		std::perror("mmap");
+		return 1;
+	}
+
+	for (size_t i = 0; i < memorySize; ++i)
+		memory[i] = (u8)(i * 13);
+	mprotect(memory, memorySize, PROT_READ);
+
+	std::vector<u8> originalMemory(memory, memory + memorySize);
+	const u8 zeros[8] = {};
+	MprotectProtector protector;
+
+	check(!isWritable(memory), "pages are read-only before patching");
+
+	//Many patches on 4 pages, one of them crossing a page boundary
+	{
+		PatchSet patchSet;
+		const u8 data[3] = { 1, 2, 3 };
+		for (int i = 0; i < 200; ++i)
+			patchSet.add(memory + i * 8, data, sizeof(data));
+		patchSet.addJmp(memory + pageSize + 10, memory + pageSize * 2 - 2, 2);
+		patchSet.addCall(memory + 16, memory + pageSize + 100);
+
+		u8 expected[4];
+		memcpy(expected, memory + pageSize * 3, sizeof(expected));
+		const u8 data4[4] = { 9, 9, 9, 9 };
+		patchSet.add(memory + pageSize * 3, data4, sizeof(data4), expected);
+
+		check(patchSet.apply(protector), "apply()");
+		check(protector.unprotectCount == 4 && protector.restoreCount == 4,
+			"each page is unprotected and restored once");
+		check(protector.flushCount == 4, "the instruction cache is flushed for each page");
+		check(protector.unprotectedPages.empty(), "no page is left writable");
+		check(!isWritable(memory) && !isWritable(memory + pageSize * 2),
+			"pages are read-only after apply()");
+
+		check(memory[8] == 1 && memory[9] == 2 && memory[10] == 3 && memory[pageSize * 3] == 9,
+			"patched bytes");
+
+		s32 offset;
+		memcpy(&offset, memory + pageSize * 2 - 1, sizeof(offset));
+		check(memory[pageSize * 2 - 2] == 0xE9
+			&& memory + pageSize * 2 - 2 + 5 + offset == memory + pageSize + 10,
+			"JMP across a page boundary");
+		check(memory[pageSize * 2 + 3] == 0x90 && memory[pageSize * 2 + 4] == 0x90, "NOPs after JMP");
+
+		memcpy(&offset, memory + pageSize + 101, sizeof(offset));
+		check(memory[pageSize + 100] == 0xE8 && memory + pageSize + 100 + 5 + offset == memory + 16,
+			"CALL to a lower address");
+
+		check(!patchSet.apply(protector) && patchSet.getError() == PatchSet::ERROR_ALREADY_APPLIED,
+			"apply() twice");
+
+		check(patchSet.rollback(protector), "rollback()");
+		check(memcmp(memory, &originalMemory[0], memorySize) == 0, "rollback() restores all bytes");
+		check(!isWritable(memory), "pages are read-only after rollback()");
+
+		check(!patchSet.rollback(protector) && patchSet.getError() == PatchSet::ERROR_NOT_APPLIED,
+			"rollback() twice");
+	}
+
+	//Overlapping patches are rejected, adjacent ones are not
+	{
+		PatchSet overlapping;
+		overlapping.add(memory + 100, zeros, 4);
+		overlapping.add(memory + 50, zeros, 4);
+		overlapping.add(memory + 102, zeros, 4);
+		check(!overlapping.apply(protector) && overlapping.getError() == PatchSet::ERROR_OVERLAP
+			&& overlapping.getErrorAddress() == memory + 102, "overlapping patches");
+
+		PatchSet adjacent;
+		adjacent.add(memory + 100, zeros, 4);
+		adjacent.add(memory + 104, zeros, 4);
+		check(adjacent.apply(protector) && adjacent.rollback(protector), "adjacent patches");
+	}
+
+	//Unexpected original bytes
+	{
+		PatchSet patchSet;
+		const u8 wrongBytes[2] = { (u8)~memory[20], memory[21] };
+		patchSet.add(memory + 10, zeros, 4);
+		patchSet.expect(memory + 20, wrongBytes, sizeof(wrongBytes));
+		check(!patchSet.apply(protector) && patchSet.getError() == PatchSet::ERROR_UNEXPECTED_BYTES
+			&& patchSet.getErrorAddress() == memory + 20, "unexpected original bytes");
+	}
+
+	//The second page cannot be unprotected: the first one is restored and
+	//nothing is written
+	{
+		PatchSet patchSet;
+		patchSet.add(memory + 10, zeros, 4);
+		patchSet.add(memory + pageSize + 10, zeros, 4);
+		protector.failingPages.insert(memory + pageSize);
+
+		const int restoreCount = protector.restoreCount;
+		check(!patchSet.apply(protector) && patchSet.getError() == PatchSet::ERROR_PROTECTION
+			&& patchSet.getErrorAddress() == memory + pageSize, "protection failure");
+		check(protector.restoreCount == restoreCount + 1 && protector.unprotectedPages.empty(),
+			"pages unprotected before the failure are restored");
+		check(!isWritable(memory), "pages are read-only after a protection failure");
+
+		protector.failingPages.clear();
+	}
+
+	//A patch that could not be created (e.g. no memory for its thunk)
+	{
+		PatchSet patchSet;
+		patchSet.add(memory + 10, zeros, 4);
+		patchSet.reject(PatchSet::ERROR_OUT_OF_MEMORY, memory + 30);
+		patchSet.reject(PatchSet::ERROR_OVERLAP, memory + 40);
+		check(!patchSet.apply(protector) && patchSet.getError() == PatchSet::ERROR_OUT_OF_MEMORY
+			&& patchSet.getErrorAddress() == memory + 30, "rejected patch set");
+
+		patchSet.clear();
+		patchSet.add(memory + 10, zeros, 4);
+		check(patchSet.apply(protector) && patchSet.rollback(protector), "clear() forgets reject()");
+	}
+
+	check(memcmp(memory, &originalMemory[0], memorySize) == 0, "failed patch sets write nothing");
+
+	std::printf("%d checks failed\n", failedChecks);
+	return failedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+//Checks that graphics::markShapeRefreshRegions() marks every screen cell
+//that a shape is drawn over in the current or the previous frame, and
+//counts how many of StarCraft's 1200 refresh cells it marks per frame.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -DNDEBUG -include host_shim/host_shim.h -Ihost_shim -I../src -o refresh_regions_test
+//    refresh_regions_test.cpp ../src/graphics/graphics.cpp ../src/graphics/Shape.cpp
+//    ../src/graphics/graphics_errors.cpp ../src/graphics/Bitmap.cpp
+//    ../src/graphics/Font.cpp ../src/graphics/FontCache.cpp
+
+#include "host_shim/host_gdi.h"
+#include <graphics/graphics.h>
+#include <graphics/graphics_misc.h>
+#include <SCBW/scbwdata.h>
+#include <cstdio>
+
+//Copied from SCBW/api.cpp, which cannot be compiled on a host
+namespace scbw {
+	void refreshScreen(int left, int top, int right, int bottom) {
+		left >>= 4; right = (right + 15) >> 4;
+		top >>= 4; bottom = (bottom + 15) >> 4;
+
+		if (left > right) std::swap(left, right);
+		if (top > bottom) std::swap(top, bottom);
+
+		//Rect out of bounds
+		if (left >= 40 || right < 0 || top >= 30 || bottom < 0) return;
+
+		left = std::max(left, 0); right = std::min(right, 40 - 1);
+		top = std::max(top, 0); bottom = std::min(bottom, 30 - 1);
+
+		for (int y = top; y <= bottom; ++y)
+			memset(&refreshRegions[40 * y + left], 1, right - left + 1);
+	}
+} //scbw
+
+namespace {
+
+	const int GRID_WIDTH = 40, GRID_HEIGHT = 30;
+	const int CELL_COUNT = GRID_WIDTH * GRID_HEIGHT;
+
+	int random(int n) {
+		return std::rand() % n;
+	}
+
+	//Marks the cells that contain a pixel of the (inclusive) box on the 640 x 480 screen
+	void markNeededCells(u8 *cells, int left, int top, int right, int bottom) {
+		left = std::max(left, 0);
+		top = std::max(top, 0);
+		right = std::min(right, GRID_WIDTH * 16 - 1);
+		bottom = std::min(bottom, GRID_HEIGHT * 16 - 1);
+
+		for (int y = top >> 4; y <= bottom >> 4 && top <= bottom; ++y) {
+			for (int x = left >> 4; x <= right >> 4 && left <= right; ++x)
+				cells[y * GRID_WIDTH + x] = 1;
+		}
+	}
+
+	//Draws a random shape and marks the cells it covers
+	void drawRandomShape(u8 *cells) {
+		const int x1 = random(840) - 100, y1 = random(680) - 100;
+		const int x2 = x1 + random(201) - 100, y2 = y1 + random(201) - 100;
+		const int radius = random(60);
+
+		switch (random(5)) {
+		case 0:
+			graphics::drawDot(x1, y1, graphics::RED);
+			markNeededCells(cells, x1, y1, x1, y1);
+			break;
+		case 1:
+			graphics::drawLine(x1, y1, x2, y2, graphics::RED);
+			markNeededCells(cells, std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2));
+			break;
+		case 2:
+			graphics::drawBox(x1, y1, x2, y2, graphics::RED);
+			markNeededCells(cells, std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2));
+			break;
+		case 3:
+			graphics::drawFilledBox(x1, y1, x2, y2, graphics::RED);
+			markNeededCells(cells, std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2));
+			break;
+		default:
+			graphics::drawCircle(x1, y1, radius, graphics::RED);
+			if (radius > 0)
+				markNeededCells(cells, x1 - radius, y1 - radius, x1 + radius, y1 + radius);
+			break;
+		}
+	}
+
+} //unnamed namespace
+
+int main() {
+	std::srand(1);
+
+	u8 previousCells[CELL_COUNT] = {};
+	long frames = 0, neededCells = 0, refreshedCells = 0, missingCells = 0;
+
+	for (int frame = 0; frame < 20000; ++frame) {
+		u8 currentCells[CELL_COUNT] = {};
+
+		graphics::resetAllGraphics();
+		const int shapeCount = frame % 100 == 0 ? 0 : random(frame % 3 == 0 ? 200 : 8);
+		for (int i = 0; i < shapeCount; ++i)
+			drawRandomShape(currentCells);
+
+		memset(refreshRegions, 0, CELL_COUNT);
+		graphics::markShapeRefreshRegions();
+
+		++frames;
+		for (int i = 0; i < CELL_COUNT; ++i) {
+			const bool isNeeded = currentCells[i] || previousCells[i];
+			neededCells += isNeeded;
+			refreshedCells += refreshRegions[i] != 0;
+
+			if (isNeeded && !refreshRegions[i]) {
+				if (missingCells < 5)
+					std::printf("frame %d: cell (%d, %d) is drawn over but not refreshed\n",
+						frame, i % GRID_WIDTH, i / GRID_WIDTH);
+				++missingCells;
+			}
+		}
+
+		memcpy(previousCells, currentCells, CELL_COUNT);
+	}
+
+	std::printf("%ld frames: %.1f cells drawn over, %.1f cells refreshed per frame (of %d)\n",
+		frames, (double)neededCells / frames, (double)refreshedCells / frames, CELL_COUNT);
+	std::printf("%ld cells not refreshed\n", missingCells);
+
+	return missingCells == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+//Checks scbw::SpatialGrid against scbw::UnitFinder on random unit layouts,
+//and compares the time both take for the same box queries.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o spatial_grid_test
+//    spatial_grid_test.cpp ../src/SCBW/SpatialGrid.cpp ../src/SCBW/UnitFinder.cpp
+//
+//The grid must find the same set of units as UnitFinder::search() for every
+//box (the order differs: the grid visits units cell by cell).
+
+#include "host_shim/host_units.h"
+#include <SCBW/SpatialGrid.h>
+#include <SCBW/UnitFinder.h>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double elapsedNs(Clock::time_point start) {
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+
+	void setupLayout(int unitCount, int mapTiles) {
+		host::clearUnits();
+		((MapSize*)mapTileSize)->width = ((MapSize*)mapTileSize)->height = (u16)mapTiles;
+
+		for (int i = 1; i <= unitCount; ++i)
+			host::setUnit(i, host::random(UNIT_TYPE_COUNT), host::random(mapTiles * 32), host::random(mapTiles * 32));
+
+		host::buildUnitOrdering();
+		*(u32*)elapsedTimeFrames += 1;
+		scbw::spatialGrid.build();
+	}
+
+} //unnamed namespace
+
+int main() {
+	std::srand(1);
+
+	Box16 *bounds = units_dat::UnitBounds;
+	for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+		bounds[unitId].left = host::random(48);
+		bounds[unitId].top = host::random(48);
+		bounds[unitId].right = host::random(48);
+		bounds[unitId].bottom = host::random(48);
+	}
+
+	long queries = 0, found = 0, mismatches = 0;
+
+	for (int layout = 0; layout < 200; ++layout) {
+		setupLayout(1 + host::random(UNIT_ARRAY_LENGTH), 64 + host::random(193));
+
+		for (int q = 0; q < 200; ++q) {
+			const int left = host::random(mapTileSize->width * 32), top = host::random(mapTileSize->height * 32);
+			const int right = left + 1 + host::random(640), bottom = top + 1 + host::random(640);
+
+			std::vector<CUnit*> expected, actual;
+			scbw::UnitFinder unitFinder(left, top, right, bottom);
+			for (int i = 0; i < unitFinder.getUnitCount(); ++i)
+				expected.push_back(unitFinder.getUnit(i));
+			scbw::spatialGrid.forEach(left, top, right, bottom, [&actual](CUnit *unit) {
+				actual.push_back(unit);
+			});
+
+			std::sort(expected.begin(), expected.end());
+			std::sort(actual.begin(), actual.end());
+			++queries;
+			found += expected.size();
+			if (expected != actual) {
+				if (mismatches < 5)
+					std::printf("mismatch: layout %d box (%d, %d, %d, %d): %d vs %d units\n",
+						layout, left, top, right, bottom, (int)expected.size(), (int)actual.size());
+				++mismatches;
+			}
+		}
+	}
+
+	std::printf("box queries: %ld, units found: %ld, mismatches: %ld\n", queries, found, mismatches);
+
+	//Benchmark: 1600 units on a 128x128 map, 320x320 boxes (e.g. Irradiate)
+	setupLayout(1600, 128);
+	const int QUERY_COUNT = 200000;
+	std::vector<int> xs(QUERY_COUNT), ys(QUERY_COUNT);
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		xs[i] = host::random(128 * 32);
+		ys[i] = host::random(128 * 32);
+	}
+
+	volatile int sink = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		scbw::UnitFinder unitFinder(xs[i] - 160, ys[i] - 160, xs[i] + 160, ys[i] + 160);
+		sink += unitFinder.getUnitCount();
+	}
+	const double finderNs = elapsedNs(start) / QUERY_COUNT;
+
+	start = Clock::now();
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		int count = 0;
+		scbw::spatialGrid.forEach(xs[i] - 160, ys[i] - 160, xs[i] + 160, ys[i] + 160, [&count](CUnit*) { ++count; });
+		sink += count;
+	}
+	const double gridNs = elapsedNs(start) / QUERY_COUNT;
+
+	start = Clock::now();
+	for (int i = 0; i < 1000; ++i)
+		scbw::spatialGrid.build();
+	const double buildNs = elapsedNs(start) / 1000;
+
+	std::printf("UnitFinder: %.0f ns/query, SpatialGrid: %.0f ns/query, SpatialGrid::build(): %.0f ns\n",
+		finderNs, gridNs, buildNs);
+
+	return mismatches == 0 ? 0 : 1;
+}
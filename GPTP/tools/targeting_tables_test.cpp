@@ -0,0 +1,195 @@
+//Compares every lookup of scbw::TargetingTables with the per-call checks it
+//replaced, across random DAT contents:
+//
+//  - canTargetType() against the TargetFlags / BaseProperty checks that
+//    scbw::canWeaponTargetUnit() made, for every weapon, unit type and
+//    ground / air
+//  - isOwnUnitsOnly() against TargetFlag::playerOwned
+//  - getPriorityClass() against the unit ID list and Worker test of
+//    hooks::getAttackPriorityHook()
+//  - canWeaponTargetUnit() against scbw::canWeaponTargetUnit() (api.cpp),
+//    for random targets and attackers
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o targeting_tables_test
+//    targeting_tables_test.cpp ../src/SCBW/TargetingTables.cpp ../src/SCBW/TypeInfoCache.cpp
+//
+//The tables are built like in hooks::gameOn(), and the type info cache is
+//rebuilt at the start of each frame like in hooks::nextFrame(). The DAT
+//arrays are changed as a plugin might do mid-game:
+//
+//  - at the end of every third frame: the lookups of the next frame must see
+//    the change, and build() must report a change on those frames only
+//  - in the middle of every fifth frame, followed by invalidate(): the
+//    lookups right after it, in the same frame, must see the change
+
+#include "host_shim/host_units.h"
+#include <SCBW/TargetingTables.h>
+#include <SCBW/TypeInfoCache.h>
+#include <cstdio>
+
+namespace {
+
+	const int FRAME_COUNT = 200;
+
+	//The type-level part of scbw::canWeaponTargetUnit() before the tables
+	bool canTargetTypeOld(u8 weaponId, u16 unitId, bool isInAir) {
+		const TargetFlag tf = weapons_dat::TargetFlags[weaponId];
+		const u32 targetProps = units_dat::BaseProperty[unitId];
+
+		if (isInAir ? !tf.air : !tf.ground)
+			return false;
+
+		if (tf.mechanical && !(targetProps & UnitProperty::Mechanical))
+			return false;
+
+		if (tf.organic && !(targetProps & UnitProperty::Organic))
+			return false;
+
+		if (tf.nonBuilding && (targetProps & UnitProperty::Building))
+			return false;
+
+		if (tf.nonRobotic && (targetProps & UnitProperty::RoboticUnit))
+			return false;
+
+		if (tf.orgOrMech && !(targetProps & (UnitProperty::Organic | UnitProperty::Mechanical)))
+			return false;
+
+		return true;
+	}
+
+	//scbw::canWeaponTargetUnit(), identical to function @ 0x00475CE0
+	bool canWeaponTargetUnitOld(u8 weaponId, const CUnit *target, const CUnit *attacker) {
+		if (weaponId >= WEAPON_TYPE_COUNT)
+			return false;
+
+		if (!target)
+			return weapons_dat::TargetFlags[weaponId].terrain;
+
+		if (target->status & UnitStatus::Invincible)
+			return false;
+
+		if (!canTargetTypeOld(weaponId, target->id, (target->status & UnitStatus::InAir) != 0))
+			return false;
+
+		if (weapons_dat::TargetFlags[weaponId].playerOwned && target->playerId != attacker->playerId)
+			return false;
+
+		return true;
+	}
+
+	//The type-level part of hooks::getAttackPriorityHook() before the tables
+	u8 getPriorityClassOld(u16 unitId) {
+		if (unitId == UnitId::larva
+			|| unitId == UnitId::egg
+			|| unitId == UnitId::cocoon
+			|| unitId == UnitId::lurker_egg)
+			return scbw::AttackPriorityClass::Unimportant;
+
+		if (units_dat::BaseProperty[unitId] & UnitProperty::Worker)
+			return scbw::AttackPriorityClass::Worker;
+
+		return scbw::AttackPriorityClass::Normal;
+	}
+
+	//Fills TargetFlags and BaseProperty with random bits
+	void randomizeDatArrays() {
+		for (int weaponId = 0; weaponId < WEAPON_TYPE_COUNT; ++weaponId) {
+			const u16 flags = (u16)host::random(0x10000);
+			std::memcpy((TargetFlag*)weapons_dat::TargetFlags + weaponId, &flags, sizeof(TargetFlag));
+		}
+
+		u32 *const baseProperty = (u32*)units_dat::BaseProperty;
+		for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId)
+			baseProperty[unitId] = (u32)host::random(0x10000) | (u32)host::random(0x10000) << 16;
+	}
+
+	long lookupCount = 0, mismatches = 0;
+
+	void compare(bool isEqual, int frame, const char *lookup, int weaponId, int unitId) {
+		++lookupCount;
+		if (!isEqual) {
+			if (mismatches < 5)
+				std::printf("Frame %d: %s(weapon %d, unit %d) differs\n", frame, lookup, weaponId, unitId);
+			++mismatches;
+		}
+	}
+
+	void compareFrame(int frame) {
+		scbw::TargetingTables &tables = scbw::targetingTables;
+
+		for (int weaponId = 0; weaponId < WEAPON_TYPE_COUNT; ++weaponId) {
+			for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+				compare(tables.canTargetType(weaponId, unitId, false) == canTargetTypeOld(weaponId, unitId, false),
+					frame, "canTargetType", weaponId, unitId);
+				compare(tables.canTargetType(weaponId, unitId, true) == canTargetTypeOld(weaponId, unitId, true),
+					frame, "canTargetType", weaponId, unitId);
+			}
+
+			compare(tables.isOwnUnitsOnly(weaponId) == (weapons_dat::TargetFlags[weaponId].playerOwned != 0),
+				frame, "isOwnUnitsOnly", weaponId, -1);
+		}
+
+		for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId) {
+			compare(tables.getPriorityClass(unitId) == getPriorityClassOld(unitId),
+				frame, "getPriorityClass", -1, unitId);
+		}
+
+		for (int i = 0; i < 1000; ++i) {
+			const u8 weaponId = (u8)host::random(WEAPON_TYPE_COUNT + 2);
+			CUnit *target = host::setUnit(1, (u16)host::random(UNIT_TYPE_COUNT), 0, 0);
+			CUnit *attacker = host::setUnit(2, (u16)host::random(UNIT_TYPE_COUNT), 0, 0);
+			target->status = (host::random(2) ? UnitStatus::InAir : 0) | (host::random(8) ? 0 : UnitStatus::Invincible);
+			target->playerId = (u8)host::random(2);
+			attacker->playerId = (u8)host::random(2);
+			if (host::random(20) == 0)
+				target = nullptr;
+
+			compare(tables.canWeaponTargetUnit(weaponId, target, attacker) == canWeaponTargetUnitOld(weaponId, target, attacker),
+				frame, "canWeaponTargetUnit", weaponId, target ? target->id : -1);
+		}
+	}
+
+} //unnamed namespace
+
+int main() {
+	std::srand(24);
+
+	randomizeDatArrays();
+	scbw::typeInfoCache.build();
+	scbw::targetingTables.build();
+
+	int changeCount = 0;
+	bool hasChanged = false;
+	const u32 firstVersion = scbw::typeInfoCache.getVersion();
+
+	for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+		*(u32*)elapsedTimeFrames = frame;
+
+		//Like hooks::nextFrame()
+		compare(scbw::typeInfoCache.build() == hasChanged, frame, "typeInfoCache.build", -1, -1);
+
+		compareFrame(frame);
+
+		//A plugin changes the DAT arrays in the middle of the frame
+		if (frame % 5 == 4) {
+			randomizeDatArrays();
+			scbw::targetingTables.invalidate();
+			++changeCount;
+			compareFrame(frame);
+		}
+
+		//...or at its end, after the last lookup
+		hasChanged = frame % 3 == 2;
+		if (hasChanged) {
+			randomizeDatArrays();
+			++changeCount;
+		}
+	}
+
+	std::printf("%d frames, %ld lookups, %u cache versions for %d changes\n",
+		FRAME_COUNT, lookupCount, scbw::typeInfoCache.getVersion() - firstVersion, changeCount);
+	std::printf("%ld mismatches\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+//Converts the trace files written by GPTP::TraceRecorder
+//(see src/trace_recorder.h and src/trace_recorder.cpp) to the Chrome trace
+//event format, which can be opened in https://ui.perfetto.dev or
+//chrome://tracing.
+//
+//Build (Linux):
+//  g++ -O2 -o trace_converter trace_converter.cpp
+//
+//Usage:
+//  trace_converter "Trace 2015-01-01 12h 00m 00s.gtrace" > trace.json
+//
+//Each hook call becomes a slice on the thread that called it, with the
+//frame number as an argument. An instant event marks the start of every
+//frame. End events whose begin event was overwritten in the ring buffer are
+//skipped, and calls that were still running when the trace was written are
+//closed at the last timestamp.
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef unsigned char u8;
+typedef unsigned short u16;
+typedef unsigned int u32;
+typedef unsigned long long u64;
+typedef long long s64;
+
+namespace {
+
+	const char TRACE_FILE_MAGIC[8] = { 'G', 'P', 'T', 'P', 'T', 'R', 'C', 'E' };
+	const u32 TRACE_FILE_VERSION = 1;
+	const size_t EVENT_SIZE = 24;
+
+	//Must match GPTP::TracePhase
+	enum TracePhase {
+		PHASE_BEGIN = 0,
+		PHASE_END = 1,
+	};
+
+	struct Event {
+		u64 tick;
+		u32 frame;
+		u32 threadId;
+		u16 nameId;
+		u16 phase;
+	};
+
+	u64 readLittleEndian(const u8 *bytes, size_t size) {
+		u64 value = 0;
+		for (size_t i = size; i > 0; --i)
+			value = (value << 8) | bytes[i - 1];
+		return value;
+	}
+
+	class Reader {
+	public:
+		explicit Reader(FILE *file) : file(file), failed(false) {}
+
+		bool hasFailed() const { return this->failed; }
+
+		void read(void *buffer, size_t size) {
+			if (fread(buffer, 1, size, this->file) != size)
+				this->failed = true;
+		}
+
+		u64 getValue(size_t size) {
+			u8 bytes[8] = {};
+			this->read(bytes, size);
+			return readLittleEndian(bytes, size);
+		}
+
+	private:
+		FILE *file;
+		bool failed;
+	};
+
+	std::string escapeJson(const std::string &text) {
+		std::string result;
+		for (size_t i = 0; i < text.size(); ++i) {
+			const char c = text[i];
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			}
+			else if ((u8)c < 0x20) {
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				result += buffer;
+			}
+			else
+				result += c;
+		}
+		return result;
+	}
+
+	class JsonWriter {
+	public:
+		JsonWriter() : isFirst(true) {
+			printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		}
+
+		~JsonWriter() {
+			printf("\n]}\n");
+		}
+
+		void writeSlice(char phase, const std::string &name, double timeUs, u32 threadId, u32 frame) {
+			this->separate();
+			printf("{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"frame\":%u}}",
+				escapeJson(name).c_str(), phase, timeUs, threadId, frame);
+		}
+
+		void writeFrameMarker(double timeUs, u32 threadId, u32 frame) {
+			this->separate();
+			printf("{\"name\":\"Frame %u\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+				frame, timeUs, threadId);
+		}
+
+		void writeThreadName(u32 threadId, const std::string &name) {
+			this->separate();
+			printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+				threadId, escapeJson(name).c_str());
+		}
+
+	private:
+		void separate() {
+			if (!this->isFirst)
+				printf(",\n");
+			this->isFirst = false;
+		}
+
+		bool isFirst;
+	};
+
+} //unnamed namespace
+
+int main(int argc, char **argv) {
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s <trace file>\n", argv[0]);
+		return 1;
+	}
+
+	const char *path = argv[1];
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 1;
+	}
+
+	Reader reader(file);
+
+	char magic[sizeof(TRACE_FILE_MAGIC)];
+	reader.read(magic, sizeof(magic));
+	if (reader.hasFailed() || memcmp(magic, TRACE_FILE_MAGIC, sizeof(magic)) != 0) {
+		fprintf(stderr, "%s is not a GPTP trace file\n", path);
+		fclose(file);
+		return 1;
+	}
+
+	const u32 version = (u32)reader.getValue(4);
+	if (version != TRACE_FILE_VERSION) {
+		fprintf(stderr, "Unsupported trace version %u\n", version);
+		fclose(file);
+		return 1;
+	}
+
+	std::vector<std::string> names((size_t)reader.getValue(4));
+	for (size_t i = 0; i < names.size() && !reader.hasFailed(); ++i) {
+		char buffer[256];
+		const size_t length = (size_t)reader.getValue(1);
+		reader.read(buffer, length);
+		names[i].assign(buffer, length);
+	}
+
+	u64 ticksPerSecond = reader.getValue(8);
+	const u32 overwrittenCount = (u32)reader.getValue(4);
+	const u32 eventCount = (u32)reader.getValue(4);
+
+	//Events are stored as GPTP::TraceEvent (little-endian)
+	std::vector<Event> events;
+	events.reserve(eventCount);
+	for (u32 i = 0; i < eventCount; ++i) {
+		u8 bytes[EVENT_SIZE];
+		reader.read(bytes, sizeof(bytes));
+		if (reader.hasFailed())
+			break;
+
+		Event event;
+		event.tick = readLittleEndian(bytes, 8);
+		event.frame = (u32)readLittleEndian(bytes + 8, 4);
+		event.threadId = (u32)readLittleEndian(bytes + 12, 4);
+		event.nameId = (u16)readLittleEndian(bytes + 16, 2);
+		event.phase = (u16)readLittleEndian(bytes + 18, 2);
+		events.push_back(event);
+	}
+
+	fclose(file);
+
+	if (reader.hasFailed())
+		fprintf(stderr, "Warning: the trace file is truncated\n");
+	if (overwrittenCount)
+		fprintf(stderr, "Warning: %u older events were overwritten; only the last %u are shown\n",
+			overwrittenCount, eventCount);
+	if (!ticksPerSecond) {
+		fprintf(stderr, "Warning: the trace file has no clock rate; assuming 1 GHz\n");
+		ticksPerSecond = 1000000000;
+	}
+
+	//Events from different threads may be slightly out of order
+	const u64 firstTick = events.empty() ? 0 : events[0].tick;
+	u64 lastTick = firstTick;
+	for (size_t i = 0; i < events.size(); ++i) {
+		if ((s64)(events[i].tick - lastTick) > 0)
+			lastTick = events[i].tick;
+	}
+
+	JsonWriter json;
+	std::map<u32, std::vector<const Event*> > openEvents;	//Per thread
+	std::map<u32, u32> lastFrames;							//Per thread
+
+	for (size_t i = 0; i < events.size(); ++i) {
+		const Event &event = events[i];
+		const double timeUs = (double)(s64)(event.tick - firstTick) * 1000000.0 / ticksPerSecond;
+		const std::string name = event.nameId < names.size()
+			? names[event.nameId] : std::string("<unknown hook>");
+
+		std::vector<const Event*> &stack = openEvents[event.threadId];
+
+		if (lastFrames.find(event.threadId) == lastFrames.end()) {
+			char threadName[32];
+			snprintf(threadName, sizeof(threadName), "Thread %u", event.threadId);
+			json.writeThreadName(event.threadId, threadName);
+		}
+
+		if (lastFrames.find(event.threadId) == lastFrames.end()
+			|| lastFrames[event.threadId] != event.frame)
+		{
+			json.writeFrameMarker(timeUs, event.threadId, event.frame);
+			lastFrames[event.threadId] = event.frame;
+		}
+
+		if (event.phase == PHASE_BEGIN) {
+			stack.push_back(&event);
+			json.writeSlice('B', name, timeUs, event.threadId, event.frame);
+		}
+		else if (event.phase == PHASE_END && !stack.empty()) {
+			stack.pop_back();
+			json.writeSlice('E', name, timeUs, event.threadId, event.frame);
+		}
+		//End events without a begin event were cut off by the ring buffer
+	}
+
+	const double lastTimeUs = (double)(s64)(lastTick - firstTick) * 1000000.0 / ticksPerSecond;
+	for (std::map<u32, std::vector<const Event*> >::iterator thread = openEvents.begin();
+		thread != openEvents.end(); ++thread)
+	{
+		std::vector<const Event*> &stack = thread->second;
+		while (!stack.empty()) {
+			const Event &event = *stack.back();
+			const std::string name = event.nameId < names.size()
+				? names[event.nameId] : std::string("<unknown hook>");
+			json.writeSlice('E', name, lastTimeUs, thread->first, event.frame);
+			stack.pop_back();
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,226 @@
+//Checks scbw::TypeInfoCache against the DAT arrays it copies, and compares
+//the time a hook predicate takes to read its fields through the DAT arrays
+//and through the cache:
+//
+//  - every field of every unit and weapon type matches the DAT arrays, for
+//    random DAT contents
+//  - build() reports a change when any byte of any cached field changes, and
+//    no change when the arrays are the same
+//  - after invalidate(), the next lookup sees the changed arrays
+//  - cold reads (caches flushed before each lookup) and the time of build()
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o type_info_cache_test
+//    type_info_cache_test.cpp ../src/SCBW/TypeInfoCache.cpp
+//
+//host_units.h gives every DAT array its own 4 KB page, like the scattered
+//arrays in StarCraft's memory.
+
+#include "host_shim/host_units.h"
+#include <SCBW/TypeInfoCache.h>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	const u32 UNITS_DAT_PAGES = 0x00700000, WEAPONS_DAT_PAGES = 0x00700000 + 53 * 0x1000;
+	const u32 DAT_PAGES_END = WEAPONS_DAT_PAGES + 22 * 0x1000;
+
+	long checkCount = 0, mismatches = 0;
+
+	void check(bool isEqual, const char *field, int id) {
+		++checkCount;
+		if (!isEqual) {
+			if (mismatches < 5)
+				std::printf("%s of type %d differs\n", field, id);
+			++mismatches;
+		}
+	}
+
+	void compareUnitType(u16 unitId) {
+		using namespace units_dat;
+		const scbw::UnitTypeInfo &info = scbw::typeInfoCache.getUnit(unitId);
+
+		check(info.baseProperty == BaseProperty[unitId], "BaseProperty", unitId);
+		check(info.maxHitPoints == MaxHitPoints[unitId], "MaxHitPoints", unitId);
+		check(info.maxShieldPoints == MaxShieldPoints[unitId], "MaxShieldPoints", unitId);
+		check(info.groundWeapon == GroundWeapon[unitId], "GroundWeapon", unitId);
+		check(info.airWeapon == AirWeapon[unitId], "AirWeapon", unitId);
+		check(info.seekRange == SeekRange[unitId], "SeekRange", unitId);
+		check(info.sightRange == SightRange[unitId], "SightRange", unitId);
+		check(info.sizeType == SizeType[unitId], "SizeType", unitId);
+		check(info.movementFlags == MovementFlags[unitId], "MovementFlags", unitId);
+		check(std::memcmp(&info.groupFlags, &GroupFlags[unitId], sizeof(GroupFlag)) == 0, "GroupFlags", unitId);
+		check(info.shieldsEnabled == ShieldsEnabled[unitId], "ShieldsEnabled", unitId);
+		check(info.maxGroundHits == MaxGroundHits[unitId], "MaxGroundHits", unitId);
+		check(info.maxAirHits == MaxAirHits[unitId], "MaxAirHits", unitId);
+		check(std::memcmp(&info.bounds, &UnitBounds[unitId], sizeof(Box16)) == 0, "UnitBounds", unitId);
+		check(info.armorAmount == ArmorAmount[unitId], "ArmorAmount", unitId);
+		check(info.armorUpgrade == ArmorUpgrade[unitId], "ArmorUpgrade", unitId);
+	}
+
+	void compareWeaponType(u8 weaponId) {
+		using namespace weapons_dat;
+		const scbw::WeaponTypeInfo &info = scbw::typeInfoCache.getWeapon(weaponId);
+
+		check(info.minRange == MinRange[weaponId], "MinRange", weaponId);
+		check(info.maxRange == MaxRange[weaponId], "MaxRange", weaponId);
+		check(std::memcmp(&info.targetFlags, &TargetFlags[weaponId], sizeof(TargetFlag)) == 0, "TargetFlags", weaponId);
+		check(info.damageAmount == DamageAmount[weaponId], "DamageAmount", weaponId);
+		check(info.damageBonus == DamageBonus[weaponId], "DamageBonus", weaponId);
+		check(info.innerSplashRadius == InnerSplashRadius[weaponId], "InnerSplashRadius", weaponId);
+		check(info.mediumSplashRadius == MediumSplashRadius[weaponId], "MediumSplashRadius", weaponId);
+		check(info.outerSplashRadius == OuterSplashRadius[weaponId], "OuterSplashRadius", weaponId);
+		check(info.damageType == weapons_dat::DamageType[weaponId], "DamageType", weaponId);
+		check(info.damageFactor == DamageFactor[weaponId], "DamageFactor", weaponId);
+		check(info.damageUpgrade == DamageUpgrade[weaponId], "DamageUpgrade", weaponId);
+		check(info.cooldown == Cooldown[weaponId], "Cooldown", weaponId);
+		check(info.attackAngle == AttackAngle[weaponId], "AttackAngle", weaponId);
+		check(info.explosionType == ExplosionType[weaponId], "ExplosionType", weaponId);
+		check(info.behavior == Behavior[weaponId], "Behavior", weaponId);
+	}
+
+	void compareAll() {
+		for (int unitId = 0; unitId < UNIT_TYPE_COUNT; ++unitId)
+			compareUnitType((u16)unitId);
+		for (int weaponId = 0; weaponId < WEAPON_TYPE_COUNT; ++weaponId)
+			compareWeaponType((u8)weaponId);
+
+		const scbw::WeaponTypeInfo &none = scbw::typeInfoCache.getWeapon(WeaponId::None);
+		check(none.minRange == 0 && none.maxRange == 0 && none.damageAmount == 0, "Fields of WeaponId::None", WeaponId::None);
+	}
+
+	void randomizeDatArrays() {
+		for (u32 address = UNITS_DAT_PAGES; address < DAT_PAGES_END; ++address)
+			*(u8*)address = (u8)host::random(256);
+	}
+
+	//Changes one random byte in one random cached field. Returns false if
+	//the new value happens to be the old one.
+	bool changeRandomField() {
+		const int unitId = host::random(UNIT_TYPE_COUNT), weaponId = host::random(WEAPON_TYPE_COUNT);
+		u8 *field;
+
+		switch (host::random(6)) {
+		case 0: field = (u8*)&units_dat::BaseProperty[unitId] + host::random(4); break;
+		case 1: field = (u8*)&units_dat::SizeType[unitId]; break;
+		case 2: field = (u8*)&units_dat::UnitBounds[unitId] + host::random(8); break;
+		case 3: field = (u8*)&weapons_dat::TargetFlags[weaponId] + host::random(2); break;
+		case 4: field = (u8*)&weapons_dat::MinRange[weaponId] + host::random(4); break;
+		default: field = (u8*)&weapons_dat::Behavior[weaponId]; break;
+		}
+
+		const u8 value = (u8)host::random(256);
+		if (*field == value)
+			return false;
+		*field = value;
+		return true;
+	}
+
+	//-------- Benchmark --------//
+
+	//Reads 7 units.dat fields and 2 weapons.dat fields, like a hook checking
+	//a target
+	int readThroughDat(u16 unitId, u8 weaponId) {
+		using namespace units_dat;
+		return (BaseProperty[unitId] & UnitProperty::Building) + ShieldsEnabled[unitId] + SizeType[unitId]
+			+ SightRange[unitId] + GroundWeapon[unitId] + SeekRange[unitId] + MaxHitPoints[unitId]
+			+ weapons_dat::DamageType[weaponId] + weapons_dat::MinRange[weaponId];
+	}
+
+	int readThroughCache(u16 unitId, u8 weaponId) {
+		const scbw::UnitTypeInfo &unitInfo = scbw::typeInfoCache.getUnit(unitId);
+		const scbw::WeaponTypeInfo &weaponInfo = scbw::typeInfoCache.getWeapon(weaponId);
+		return (unitInfo.baseProperty & UnitProperty::Building) + unitInfo.shieldsEnabled + unitInfo.sizeType
+			+ unitInfo.sightRange + unitInfo.groundWeapon + unitInfo.seekRange + unitInfo.maxHitPoints
+			+ weaponInfo.damageType + weaponInfo.minRange;
+	}
+
+	const int LOOKUP_COUNT = 1 << 16;
+	const int ROUND_COUNT = 2000, LOOKUPS_PER_ROUND = 4;
+
+	u16 unitIds[LOOKUP_COUNT];
+	u8 weaponIds[LOOKUP_COUNT];
+	char evictionBuffer[8 << 20];
+
+	//Returns the average time of one lookup, with the caches flushed before
+	//each round of a few lookups
+	double benchmarkCold(int (*read)(u16, u8)) {
+		double totalNs = 0;
+		volatile int sink = 0;
+
+		for (int round = 0; round < ROUND_COUNT; ++round) {
+			for (size_t i = 0; i < sizeof(evictionBuffer); i += 64)
+				evictionBuffer[i]++;
+
+			const Clock::time_point start = Clock::now();
+			int sum = 0;
+			for (int i = 0; i < LOOKUPS_PER_ROUND; ++i)
+				sum += read(unitIds[round * 16 + i], weaponIds[round * 16 + i]);
+			totalNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			sink += sum;
+		}
+
+		return totalNs / (ROUND_COUNT * LOOKUPS_PER_ROUND);
+	}
+
+	void runBenchmark() {
+		for (int i = 0; i < LOOKUP_COUNT; ++i) {
+			unitIds[i] = (u16)host::random(UNIT_TYPE_COUNT);
+			weaponIds[i] = (u8)host::random(WEAPON_TYPE_COUNT);
+		}
+
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			check(readThroughDat(unitIds[i], weaponIds[i]) == readThroughCache(unitIds[i], weaponIds[i]), "Predicate", unitIds[i]);
+
+		//The first pass warms up the code
+		benchmarkCold(readThroughDat);
+		benchmarkCold(readThroughCache);
+		const double datNs = benchmarkCold(readThroughDat);
+		const double cacheNs = benchmarkCold(readThroughCache);
+		std::printf("Cold lookups: DAT arrays %.1f ns, cache %.1f ns\n", datNs, cacheNs);
+
+		const int BUILD_COUNT = 1000;
+		const Clock::time_point start = Clock::now();
+		for (int i = 0; i < BUILD_COUNT; ++i)
+			scbw::typeInfoCache.build();
+		std::printf("build(): %.2f us\n",
+			std::chrono::duration<double, std::micro>(Clock::now() - start).count() / BUILD_COUNT);
+	}
+
+} //unnamed namespace
+
+int main() {
+	std::srand(25);
+
+	for (int trial = 0; trial < 50; ++trial) {
+		randomizeDatArrays();
+		check(scbw::typeInfoCache.build(), "build() after new DAT contents", -1);
+		compareAll();
+		check(!scbw::typeInfoCache.build(), "build() without changes", -1);
+
+		for (int i = 0; i < 100; ++i) {
+			const bool hasChanged = changeRandomField();
+			check(scbw::typeInfoCache.build() == hasChanged, "build() after changing one field", -1);
+		}
+		compareAll();
+
+		//invalidate(): the next lookup sees the change without a build() call
+		for (int i = 0; i < 20; ++i) {
+			const u32 version = scbw::typeInfoCache.getVersion();
+			const bool hasChanged = changeRandomField();
+			scbw::typeInfoCache.invalidate();
+			compareAll();
+			check((scbw::typeInfoCache.getVersion() != version) == hasChanged, "version after invalidate()", -1);
+		}
+	}
+
+	runBenchmark();
+
+	std::printf("%ld checks\n", checkCount);
+	std::printf("%ld mismatches\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+//Checks that scbw::UnitTaskScheduler assigns units to frames by unit index
+//and frame number alone: the same game, with the visible unit list linked in
+//a different order, must visit the same units on the same frames. Also
+//checks the slice rule (frame % interval == index % interval while a task is
+//on time), the per-frame budget and the reported lag, and that
+//scbw::UnitRegistry::verify() holds before each sync() when dying units are
+//removed like unitDestructorSpecialHook() does.
+//
+//Build (Linux, from GPTP/tools):
+//  g++ -std=c++11 -O2 -w -fpermissive -fno-strict-aliasing -fno-delete-null-pointer-checks
+//    -include host_shim/host_shim.h -Ihost_shim -I../src -o unit_task_scheduler_test
+//    unit_task_scheduler_test.cpp ../src/SCBW/UnitRegistry.cpp ../src/SCBW/UnitTaskScheduler.cpp
+//
+//The game is random: each frame some units are created, killed, morphed or
+//given to another player. About a third of the units are SCVs, which are
+//visited like SCT-Plugin's auto-repair task: every 8 frames, with a budget
+//that fits a whole slice, so that it is never late. A second SCV task has a
+//budget of 64 units per frame, and falls behind in a crowded part of the
+//game. All units are also visited by a task with a large budget.
+//SCT-Plugin/SCBW/UnitTaskScheduler.cpp is a copy of the GPTP scheduler.
+
+#include "host_shim/host_units.h"
+#include <SCBW/UnitRegistry.h>
+#include <SCBW/UnitTaskScheduler.h>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+	const int FRAME_COUNT = 3000;
+	const int SCV_INTERVAL = 8, SCV_BUDGET = (UNIT_ARRAY_LENGTH + SCV_INTERVAL - 1) / SCV_INTERVAL;
+	const int LIMITED_BUDGET = 64;
+	const int ALL_INTERVAL = 5, ALL_BUDGET = UNIT_ARRAY_LENGTH;
+
+	struct Visit {
+		u32 frame;
+		u16 unitIndex;
+
+		bool operator==(const Visit &other) const {
+			return frame == other.frame && unitIndex == other.unitIndex;
+		}
+	};
+
+	u32 currentFrame;
+	std::vector<Visit> scvVisits, limitedVisits, allVisits;
+
+	void visitScv(CUnit *unit) {
+		const Visit visit = { currentFrame, unit->getIndex() };
+		scvVisits.push_back(visit);
+	}
+
+	void visitScvLimited(CUnit *unit) {
+		const Visit visit = { currentFrame, unit->getIndex() };
+		limitedVisits.push_back(visit);
+	}
+
+	void visitUnit(CUnit *unit) {
+		const Visit visit = { currentFrame, unit->getIndex() };
+		allVisits.push_back(visit);
+	}
+
+	//Links all units with a sprite into the visible unit list, in an order
+	//that depends on @p linkOrder only
+	void linkVisibleUnitsShuffled(std::mt19937 &linkOrder) {
+		std::vector<CUnit*> visibleUnits;
+		for (int i = 0; i < UNIT_ARRAY_LENGTH; ++i) {
+			if (host::units[i].sprite)
+				visibleUnits.push_back(&host::units[i]);
+		}
+		std::shuffle(visibleUnits.begin(), visibleUnits.end(), linkOrder);
+
+		*firstVisibleUnit = nullptr;
+		for (int i = (int)visibleUnits.size() - 1; i >= 0; --i) {
+			visibleUnits[i]->link.next = *firstVisibleUnit;
+			*firstVisibleUnit = visibleUnits[i];
+		}
+	}
+
+	u16 randomUnitId(bool isCrowded) {
+		if (host::random(3) == 0 || (isCrowded && host::random(2) == 0))
+			return UnitId::scv;
+		return (u16)host::random(UnitId::None);
+	}
+
+	//In a crowded frame, more units are created and more of them are SCVs
+	void changeUnits(bool isCrowded) {
+		const int changeCount = isCrowded ? 40 : 10;
+
+		for (int i = 0; i < changeCount; ++i) {
+			const u16 index = (u16)(1 + host::random(UNIT_ARRAY_LENGTH));
+			CUnit *unit = CUnit::getFromIndex(index);
+
+			switch (host::random(isCrowded ? 3 : 4)) {
+			case 0:
+				unit = host::setUnit(index, randomUnitId(isCrowded), 100, 100);
+				unit->playerId = (u8)host::random(8);
+				break;
+			case 1:
+				unit->id = randomUnitId(isCrowded);	//Morphed
+				break;
+			case 2:
+				unit->playerId = (u8)host::random(8);
+				break;
+			default:
+				if (unit->sprite) {					//Killed
+					scbw::unitRegistry.remove(unit);	//Like unitDestructorSpecialHook()
+					unit->sprite = nullptr;
+				}
+				break;
+			}
+		}
+	}
+
+	struct Result {
+		std::vector<Visit> scvVisits, limitedVisits, allVisits;
+		u32 scvMaxLag, limitedMaxLag, allMaxLag;
+		int limitedTooLate;		//Frames where the limited SCV task was behind schedule
+		int failedVerifications;	//Frames where verify() failed before sync()
+	};
+
+	//Plays the same random game for every @p linkOrderSeed
+	Result playGame(unsigned int linkOrderSeed) {
+		std::srand(1);
+		std::mt19937 linkOrder(linkOrderSeed);
+
+		host::clearUnits();
+		scbw::unitRegistry.clear();
+		scvVisits.clear();
+		limitedVisits.clear();
+		allVisits.clear();
+
+		scbw::UnitTaskScheduler &scheduler = scbw::unitTaskScheduler;
+		scheduler.clearTasks();
+		const int scvTask = scheduler.addTask(visitScv, SCV_INTERVAL, SCV_BUDGET,
+			&scbw::unitRegistry.ofType(UnitId::scv));
+		const int limitedTask = scheduler.addTask(visitScvLimited, SCV_INTERVAL, LIMITED_BUDGET,
+			&scbw::unitRegistry.ofType(UnitId::scv));
+		const int allTask = scheduler.addTask(visitUnit, ALL_INTERVAL, ALL_BUDGET);
+		scheduler.reset();
+
+		Result result = {};
+		for (currentFrame = 0; currentFrame < (u32)FRAME_COUNT; ++currentFrame) {
+			//A crowded middle game, where the limited SCV task runs out of budget
+			const bool isCrowded = 1000 <= currentFrame && currentFrame < 1300;
+			changeUnits(isCrowded);
+
+			linkVisibleUnitsShuffled(linkOrder);
+			if (!scbw::unitRegistry.verify())
+				++result.failedVerifications;
+			scbw::unitRegistry.sync();
+			scheduler.run(currentFrame);
+
+			if (scheduler.getLag(limitedTask) > 0)
+				++result.limitedTooLate;
+		}
+
+		result.scvVisits = scvVisits;
+		result.limitedVisits = limitedVisits;
+		result.allVisits = allVisits;
+		result.scvMaxLag = scheduler.getMaxLag(scvTask);
+		result.limitedMaxLag = scheduler.getMaxLag(limitedTask);
+		result.allMaxLag = scheduler.getMaxLag(allTask);
+		return result;
+	}
+
+	int failedChecks = 0;
+
+	void check(bool condition, const char *description) {
+		if (!condition) {
+			std::printf("FAILED: %s\n", description);
+			++failedChecks;
+		}
+	}
+
+	//Checks that every visit is in its unit's slice, and that no frame has
+	//more than @p budget visits
+	bool isOnSchedule(const std::vector<Visit> &visits, int interval, int budget) {
+		int visitsInFrame = 0;
+		for (size_t i = 0; i < visits.size(); ++i) {
+			if (visits[i].frame % interval != visits[i].unitIndex % interval)
+				return false;
+
+			visitsInFrame = i > 0 && visits[i - 1].frame == visits[i].frame ? visitsInFrame + 1 : 1;
+			if (visitsInFrame > budget)
+				return false;
+		}
+		return true;
+	}
+
+	int getMaxVisitsPerFrame(const std::vector<Visit> &visits) {
+		int maxVisits = 0, visitsInFrame = 0;
+		for (size_t i = 0; i < visits.size(); ++i) {
+			visitsInFrame = i > 0 && visits[i - 1].frame == visits[i].frame ? visitsInFrame + 1 : 1;
+			maxVisits = std::max(maxVisits, visitsInFrame);
+		}
+		return maxVisits;
+	}
+
+} //unnamed namespace
+
+int main() {
+	const Result first = playGame(1);
+	const Result second = playGame(2);
+	const Result third = playGame(12345);
+
+	check(first.failedVerifications == 0, "registry is consistent before each sync()");
+
+	//A unit that dies without being removed must be caught before sync()
+	CUnit *deadUnit = nullptr;
+	scbw::unitRegistry.all().forEach([&deadUnit](CUnit *unit) {
+		if (!deadUnit)
+			deadUnit = unit;
+	});
+	check(deadUnit && scbw::unitRegistry.verify(), "registry is consistent at the end of the game");
+	deadUnit->sprite = nullptr;
+	check(!scbw::unitRegistry.verify(), "verify() finds a unit that died without being removed");
+
+	check(first.scvVisits == second.scvVisits && first.scvVisits == third.scvVisits,
+		"SCV task visits the same units on the same frames");
+	check(first.limitedVisits == second.limitedVisits && first.limitedVisits == third.limitedVisits,
+		"limited SCV task visits the same units on the same frames");
+	check(first.allVisits == second.allVisits && first.allVisits == third.allVisits,
+		"all-units task visits the same units on the same frames");
+
+	check(first.allMaxLag == 0, "all-units task is never late");
+	check(isOnSchedule(first.allVisits, ALL_INTERVAL, ALL_BUDGET),
+		"all-units task visits each unit in its slice");
+
+	check(first.scvMaxLag == 0, "SCV task is never late");
+	check(isOnSchedule(first.scvVisits, SCV_INTERVAL, SCV_BUDGET),
+		"SCV task visits each SCV in its slice");
+
+	check(getMaxVisitsPerFrame(first.limitedVisits) <= LIMITED_BUDGET, "limited SCV task stays within its budget");
+	check(first.limitedMaxLag > 0, "limited SCV task falls behind in the crowded part of the game");
+
+	//The limited task must have caught up by the end of the game, and be back
+	//in the slice rule for the last frames
+	std::vector<Visit> lastLimitedVisits;
+	for (size_t i = 0; i < first.limitedVisits.size(); ++i) {
+		if (first.limitedVisits[i].frame >= FRAME_COUNT - 200)
+			lastLimitedVisits.push_back(first.limitedVisits[i]);
+	}
+	check(isOnSchedule(lastLimitedVisits, SCV_INTERVAL, LIMITED_BUDGET), "limited SCV task catches up");
+
+	std::printf("%d frames: %u SCV visits (max lag %u frames), %u limited SCV visits (max lag %u frames, late on %d frames), %u unit visits\n",
+		FRAME_COUNT, (u32)first.scvVisits.size(), first.scvMaxLag, (u32)first.limitedVisits.size(),
+		first.limitedMaxLag, first.limitedTooLate, (u32)first.allVisits.size());
+	std::printf("%d checks failed\n", failedChecks);
+	return failedChecks == 0 ? 0 : 1;
+}
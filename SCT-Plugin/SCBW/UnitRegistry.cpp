@@ -0,0 +1,126 @@
+#include "UnitRegistry.h"
+#include "enumerations.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace scbw {
+
+UnitRegistry unitRegistry;
+
+namespace {
+
+//Returned by ofType() / ofPlayer() for out-of-range IDs
+const UnitRegistry::UnitSet& getEmptySet() {
+  static UnitRegistry::UnitSet emptySet;  //Zero-initialized
+  return emptySet;
+}
+
+inline bool testBit(const u32 *words, u16 index) {
+  return (words[index / 32] & (1u << (index % 32))) != 0;
+}
+
+} //unnamed namespace
+
+bool UnitRegistry::UnitSet::contains(const CUnit *unit) const {
+  return unit && testBit(this->words, unit->getIndex());
+}
+
+bool UnitRegistry::UnitSet::containsIndex(u16 index) const {
+  return index <= UNIT_ARRAY_LENGTH && testBit(this->words, index);
+}
+
+UnitRegistry::UnitRegistry() {
+  this->clear();
+}
+
+void UnitRegistry::clear() {
+  std::memset(this->typeSets, 0, sizeof(this->typeSets));
+  std::memset(this->playerSets, 0, sizeof(this->playerSets));
+  std::memset(&this->allUnits, 0, sizeof(this->allUnits));
+  std::fill_n(this->filedUnitId, countof(this->filedUnitId), (u16)UnitId::None);
+  std::fill_n(this->filedPlayerId, countof(this->filedPlayerId), (u8)0);
+}
+
+void UnitRegistry::addToSets(u16 index, u16 unitId, u8 playerId) {
+  const u32 bit = 1u << (index % 32);
+  const int w = index / 32;
+
+  this->typeSets[unitId].words[w] |= bit;
+  this->typeSets[unitId].count++;
+  this->playerSets[playerId].words[w] |= bit;
+  this->playerSets[playerId].count++;
+  this->allUnits.words[w] |= bit;
+  this->allUnits.count++;
+
+  this->filedUnitId[index] = unitId;
+  this->filedPlayerId[index] = playerId;
+}
+
+void UnitRegistry::removeFromSets(u16 index) {
+  const u16 unitId = this->filedUnitId[index];
+  if (unitId == UnitId::None)
+    return;
+
+  const u8 playerId = this->filedPlayerId[index];
+  const u32 bit = 1u << (index % 32);
+  const int w = index / 32;
+
+  this->typeSets[unitId].words[w] &= ~bit;
+  this->typeSets[unitId].count--;
+  this->playerSets[playerId].words[w] &= ~bit;
+  this->playerSets[playerId].count--;
+  this->allUnits.words[w] &= ~bit;
+  this->allUnits.count--;
+
+  this->filedUnitId[index] = UnitId::None;
+}
+
+void UnitRegistry::update(const CUnit *unit) {
+  assert(unit);
+  const u16 index = unit->getIndex();
+
+  if (!unit->sprite || unit->id >= UNIT_TYPE_COUNT || unit->playerId >= PLAYER_COUNT) {
+    this->removeFromSets(index);
+    return;
+  }
+
+  if (this->filedUnitId[index] == unit->id && this->filedPlayerId[index] == unit->playerId)
+    return;
+
+  this->removeFromSets(index);
+  this->addToSets(index, unit->id, unit->playerId);
+}
+
+void UnitRegistry::sync() {
+  u32 seen[WORD_COUNT] = {};
+
+  for (CUnit *unit = *firstVisibleUnit; unit; unit = unit->link.next) {
+    const u16 index = unit->getIndex();
+    this->update(unit);
+    seen[index / 32] |= 1u << (index % 32);
+  }
+
+  //Remove units that are no longer in the visible unit list
+  u32 gone[WORD_COUNT];
+  for (int w = 0; w < WORD_COUNT; ++w)
+    gone[w] = this->allUnits.words[w] & ~seen[w];
+
+  forEachInWords(gone, [this](CUnit *unit) {
+    this->removeFromSets(unit->getIndex());
+  });
+}
+
+const UnitRegistry::UnitSet& UnitRegistry::ofType(u16 unitId) const {
+  if (unitId >= UNIT_TYPE_COUNT)
+    return getEmptySet();
+  return this->typeSets[unitId];
+}
+
+const UnitRegistry::UnitSet& UnitRegistry::ofPlayer(u8 playerId) const {
+  if (playerId >= PLAYER_COUNT)
+    return getEmptySet();
+  return this->playerSets[playerId];
+}
+
+} //scbw
@@ -0,0 +1,111 @@
+#pragma once
+#include "scbwdata.h"
+
+namespace scbw {
+
+/// The UnitRegistry class keeps track of which units (in the visible unit
+/// list) belong to each unit type and each player, as bitsets indexed by
+/// CUnit::getIndex(). Instead of walking the whole unit list to find e.g.
+/// every SCV, feature code can visit only the matching units:
+///
+///   scbw::unitRegistry.ofType(UnitId::scv).forEach([](CUnit *unit) {
+///     //...
+///   });
+///
+/// The registry is brought up to date by sync(), which hooks::nextFrame()
+/// calls at the start of every frame.
+///
+/// Note: Units are visited in ascending index order, not in the order of
+/// the unit list.
+
+class UnitRegistry {
+  public:
+    /// Number of 32-bit words in each bitset. Slot 0 is never used.
+    static const int WORD_COUNT = (UNIT_ARRAY_LENGTH + 1 + 31) / 32;
+
+    /// A set of units, one bit per unit index.
+    class UnitSet {
+      public:
+        /// Returns the number of units in the set.
+        int getCount() const { return this->count; }
+
+        /// Returns true if @p unit is in the set.
+        bool contains(const CUnit *unit) const;
+
+        /// Returns true if the unit with the given CUnit::getIndex() is in the set.
+        bool containsIndex(u16 index) const;
+
+        /// Calls func(unit) once for each unit in the set.
+        template <class Callback>
+        void forEach(const Callback &func) const;
+
+      private:
+        friend class UnitRegistry;
+        u32 words[WORD_COUNT];
+        int count;
+    };
+
+    UnitRegistry();
+
+    /// Removes all units from the registry (e.g. when a new game starts).
+    void clear();
+
+    /// Walks the visible unit list once, and re-files every unit whose type
+    /// or owner has changed since the last update. Units that have left the
+    /// list are removed.
+    void sync();
+
+    /// Returns the set of all units of the given type.
+    const UnitSet& ofType(u16 unitId) const;
+
+    /// Returns the set of all units owned by @p playerId.
+    const UnitSet& ofPlayer(u8 playerId) const;
+
+    /// Returns the set of all units in the registry.
+    const UnitSet& all() const { return this->allUnits; }
+
+  private:
+    void update(const CUnit *unit);
+    void addToSets(u16 index, u16 unitId, u8 playerId);
+    void removeFromSets(u16 index);
+
+    //Calls func(unit) for every bit set in words
+    template <class Callback>
+    static void forEachInWords(const u32 *words, const Callback &func);
+
+    UnitSet typeSets[UNIT_TYPE_COUNT];
+    UnitSet playerSets[PLAYER_COUNT];
+    UnitSet allUnits;
+
+    //The type and owner each unit is currently filed under
+    u16 filedUnitId[UNIT_ARRAY_LENGTH + 1];
+    u8 filedPlayerId[UNIT_ARRAY_LENGTH + 1];
+};
+
+/// The shared unit registry.
+extern UnitRegistry unitRegistry;
+
+
+//-------- Template member function definitions --------//
+
+template <class Callback>
+void UnitRegistry::forEachInWords(const u32 *words, const Callback &func) {
+  for (int w = 0; w < WORD_COUNT; ++w) {
+    u32 bits = words[w];
+    while (bits) {
+      int bit = 0;
+      while (!(bits & (1u << bit)))
+        ++bit;
+      bits &= ~(1u << bit);
+      func(CUnit::getFromIndex((u16)(w * 32 + bit)));
+    }
+  }
+}
+
+template <class Callback>
+void UnitRegistry::UnitSet::forEach(const Callback &func) const {
+  if (this->count > 0)
+    UnitRegistry::forEachInWords(this->words, func);
+}
+
+} //scbw
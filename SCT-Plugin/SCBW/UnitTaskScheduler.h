@@ -0,0 +1,89 @@
+#pragma once
+#include "UnitRegistry.h"
+
+namespace scbw {
+
+/// The UnitTaskScheduler runs periodic per-unit tasks spread out over
+/// several frames, instead of visiting every unit every frame.
+///
+/// This is the scheduler of GPTP/src/SCBW/UnitTaskScheduler.h; changes to
+/// one should be made to both.
+///
+/// A task with an interval of N frames visits each unit once every N
+/// frames: units are split into N slices by CUnit::getIndex() % N, and one
+/// slice is processed per frame (frame % N). Unit indexes and frame counts
+/// are the same when a replay is played back, so units are always visited
+/// in the same order on the same frames.
+///
+///   //Calls autoRepair(scv) for every SCV once every 8 frames,
+///   //for at most 20 SCVs per frame
+///   scbw::unitTaskScheduler.addTask(autoRepair, 8, 20,
+///     &scbw::unitRegistry.ofType(UnitId::scv));
+///
+/// If a slice contains more units than the task's budget, the rest of the
+/// slice is visited in the following frames, and the later slices are
+/// delayed. The task catches up (still within its budget) once there is less
+/// work. getLag() tells how many frames behind schedule a task is.
+///
+/// The budget counts units rather than time, so that delays are also the
+/// same in replays.
+
+class UnitTaskScheduler {
+  public:
+    typedef void (*TaskFunc)(CUnit *unit);
+
+    /// Maximum number of registered tasks.
+    static const int MAX_TASKS = 32;
+
+    UnitTaskScheduler();
+
+    /// Registers a task, and returns its ID (or -1 if there are too many
+    /// tasks). Tasks are run in the order they were added.
+    /// @param interval Number of frames between two visits of the same unit.
+    /// @param budget   Maximum number of units visited per frame.
+    /// @param units    If not null, only units in this set are visited. The
+    ///                 set must stay valid (e.g. a set of scbw::unitRegistry).
+    int addTask(TaskFunc func, int interval, int budget,
+                const UnitRegistry::UnitSet *units = nullptr);
+
+    /// Removes all tasks.
+    void clearTasks();
+
+    /// Restarts all tasks from the slice of the next frame. Called when a
+    /// game starts.
+    void reset();
+
+    /// Runs the part of each task that is due on @p frame. Called once per
+    /// frame from hooks::nextFrame(), after scbw::unitRegistry.sync().
+    void run(u32 frame);
+
+    /// Returns the number of frames the task is behind schedule (0 if it is
+    /// on time).
+    u32 getLag(int taskId) const;
+
+    /// Returns the highest lag of the task since reset().
+    u32 getMaxLag(int taskId) const;
+
+  private:
+    struct Task {
+      TaskFunc func;
+      const UnitRegistry::UnitSet *units;
+      u16 interval;
+      u16 budget;
+      bool isStarted;
+      u16 nextIndex;    //Next unit index to visit in the current slice (0 = not begun)
+      u32 dueFrame;     //Frame on which the current slice was due
+      u32 lag;
+      u32 maxLag;
+    };
+
+    void runTask(Task &task, u32 frame);
+
+    Task tasks[MAX_TASKS];
+    int taskCount;
+};
+
+/// The shared unit task scheduler.
+extern UnitTaskScheduler unitTaskScheduler;
+
+} //scbw
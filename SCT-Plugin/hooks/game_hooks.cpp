@@ -6,6 +6,8 @@
 #include <SCBW/scbwdata.h>
 #include <SCBW/ExtendSightLimit.h>
 #include <SCBW/UnitFinder.h>
+#include <SCBW/UnitRegistry.h>
+#include <SCBW/UnitTaskScheduler.h>
 #include <cstdio>
 
 //Shared by several functions in here
@@ -52,6 +54,12 @@ void scvAutoRepair(CUnit* scv) {
     scv->orderTo(OrderId::Repair1, repairTarget);
 }
 
+//Run by scbw::unitTaskScheduler for every SCV once every 8 frames
+void scvAutoRepairTask(CUnit* scv) {
+  if (scv->mainOrderId == OrderId::PlayerGuard)
+    scvAutoRepair(scv);
+}
+
 //Order signal: 0x10 denotes "completely lowered" state
 void manageSupplyDepot(CUnit* depot) {
   //TODO: Add this to GPTP
@@ -155,6 +163,7 @@ bool nextFrame() {
   if (!scbw::isGamePaused()) { //If the game is not paused
     scbw::setInGameLoopState(true); //Needed for scbw::random() to work
     graphics::resetAllGraphics();
+    scbw::unitRegistry.sync();
     
     //This block is executed once every game.
     if (*elapsedTimeFrames == 0) {
@@ -166,15 +175,14 @@ bool nextFrame() {
     for (CUnit *unit = *firstVisibleUnit; unit; unit = unit->link.next) {
       //Write your code here
 
-      //Auto-Repair
-      if (unit->id == UnitId::scv && unit->mainOrderId == OrderId::PlayerGuard)
-        scvAutoRepair(unit);
-
       //Lower & raise Supply Depots
       if (unit->id == UnitId::supply_depot && unit->status & UnitStatus::Completed)
         manageSupplyDepot(unit);
     }
 
+    //Auto-Repair (see gameOn())
+    scbw::unitTaskScheduler.run(*elapsedTimeFrames);
+
     for (int i = 0; i < *clientSelectionCount; ++i) {
       const CUnit *selUnit = clientSelectionGroup->unit[i];
 
@@ -244,6 +252,15 @@ bool nextFrame() {
 }
 
 bool gameOn() {
+  scbw::unitRegistry.clear();
+
+  //Each SCV looks for a repair target every 8 frames, instead of every SCV
+  //searching every frame. The budget fits the largest possible slice (one
+  //unit index in 8), so that no SCV waits longer than 8 frames.
+  scbw::unitTaskScheduler.clearTasks();
+  scbw::unitTaskScheduler.addTask(scvAutoRepairTask, 8, (UNIT_ARRAY_LENGTH + 7) / 8,
+                                  &scbw::unitRegistry.ofType(UnitId::scv));
+  scbw::unitTaskScheduler.reset();
   return true;
 }
 